@@ -62,6 +62,8 @@ static bool cmd_targets(target_s *target, int argc, const char **argv);
 static bool cmd_morse(target_s *target, int argc, const char **argv);
 static bool cmd_halt_timeout(target_s *target, int argc, const char **argv);
 static bool cmd_connect_reset(target_s *target, int argc, const char **argv);
+static bool cmd_flash_incremental(target_s *target, int argc, const char **argv);
+static bool cmd_flash_stats(target_s *target, int argc, const char **argv);
 static bool cmd_reset(target_s *target, int argc, const char **argv);
 static bool cmd_tdi_low_reset(target_s *target, int argc, const char **argv);
 #ifdef PLATFORM_HAS_POWER_SWITCH
@@ -103,6 +105,9 @@ const command_s cmd_list[] = {
 	{"morse", cmd_morse, "Display morse error message"},
 	{"halt_timeout", cmd_halt_timeout, "Timeout to wait until Cortex-M is halted: [TIMEOUT, default 2000ms]"},
 	{"connect_rst", cmd_connect_reset, "Configure connect under reset: [enable|disable]"},
+	{"flash_incremental", cmd_flash_incremental,
+		"Skip erasing and programming Flash blocks whose contents already match: [enable|disable]"},
+	{"flash_stats", cmd_flash_stats, "Show where the time went in the last Flash operation on the target"},
 	{"reset", cmd_reset, "Pulse the nRST line - disconnects target: [PULSE_LEN, default 0ms]"},
 	{"tdi_low_reset", cmd_tdi_low_reset,
 		"Pulse nRST with TDI set low to attempt to wake certain targets up (eg LPC82x)"},
@@ -478,6 +483,58 @@ static bool cmd_connect_reset(target_s *target, int argc, const char **argv)
 	return true;
 }
 
+static bool cmd_flash_incremental(target_s *target, int argc, const char **argv)
+{
+	if (argc == 2 && !parse_enable_or_disable(argv[1], &target_flash_incremental))
+		return false;
+	if (argc > 2) {
+		gdb_out("usage: monitor flash_incremental [enable|disable]\n");
+		return false;
+	}
+
+	gdb_outf("Incremental Flash programming: %s\n", target_flash_incremental ? "enabled" : "disabled");
+	/* Report how the last Flash operation on the current target went */
+	if (target && target->flash_blocks_compared)
+		gdb_outf("Last operation skipped %" PRIu32 " of %" PRIu32 " erase blocks as unchanged\n",
+			target->flash_blocks_skipped, target->flash_blocks_compared);
+	return true;
+}
+
+static bool cmd_flash_stats(target_s *target, int argc, const char **argv)
+{
+	(void)argc;
+	(void)argv;
+	if (!target) {
+		gdb_out("No target attached\n");
+		return false;
+	}
+	if (target->flash_offloaded) {
+		gdb_out("The last Flash operation ran on the probe, so no statistics were collected for it\n");
+		return true;
+	}
+
+	gdb_outf("Erase: %" PRIu32 "ms, write: %" PRIu32 "ms, complete: %" PRIu32 "ms\n", target->flash_erase_time_ms,
+		target->flash_write_time_ms, target->flash_complete_time_ms);
+	for (const target_flash_s *flash = target->flash; flash; flash = flash->next) {
+		const target_flash_stats_s *const stats = &flash->stats;
+		gdb_outf("Flash 0x%08" PRIx32 "+0x%" PRIx32 " (blocksize 0x%" PRIx32 ", writesize 0x%" PRIx32 "):\n",
+			flash->start, (uint32_t)flash->length, (uint32_t)flash->blocksize, (uint32_t)flash->writesize);
+		gdb_outf("\terase:      %" PRIu32 " calls, %" PRIu32 " bytes, %" PRIu32 "ms\n", stats->erase_count,
+			stats->erase_bytes, stats->erase_time_ms);
+		gdb_outf("\tmass erase: %" PRIu32 " calls, %" PRIu32 "ms\n", stats->mass_erase_count,
+			stats->mass_erase_time_ms);
+		gdb_outf("\twrite:      %" PRIu32 " calls, %" PRIu32 " bytes, %" PRIu32 "ms, %" PRIu32
+				 " erased chunks skipped\n",
+			stats->write_count, stats->write_bytes, stats->write_time_ms, stats->chunks_skipped);
+		gdb_outf("\tflush:      %" PRIu32 " calls, %" PRIu32 "ms\n", stats->flush_count, stats->flush_time_ms);
+		gdb_outf("\tbusy-wait:  %" PRIu32 " polls, %" PRIu32 "ms\n", stats->poll_count, stats->poll_time_ms);
+	}
+	if (target->flash_blocks_compared)
+		gdb_outf("Incremental programming skipped %" PRIu32 " of %" PRIu32 " erase blocks as unchanged\n",
+			target->flash_blocks_skipped, target->flash_blocks_compared);
+	return true;
+}
+
 static bool cmd_halt_timeout(target_s *target, int argc, const char **argv)
 {
 	(void)target;
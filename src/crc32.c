@@ -20,7 +20,9 @@
 
 #include "general.h"
 #include "target.h"
+#include "target_internal.h"
 #include "gdb_if.h"
+#include "crc32.h"
 
 #if !defined(STM32F0) && !defined(STM32F1) && !defined(STM32F2) && !defined(STM32F3) && !defined(STM32F4) && \
 	!defined(STM32F7) && !defined(STM32L0) && !defined(STM32L1) && !defined(STM32G0) && !defined(STM32G4)
@@ -100,7 +102,8 @@ static uint32_t crc32_calc(const uint32_t crc, const uint8_t data)
 	return (crc << 8U) ^ crc32_table[((crc >> 24U) ^ data) & 0xffU];
 }
 
-static bool generic_crc32(target_s *const target, uint32_t *const result, const uint32_t base, const size_t len)
+static bool generic_crc32(
+	const crc32_read_f read, void *const context, uint32_t *const result, const uint32_t base, const size_t len)
 {
 	uint32_t crc = 0xffffffffU;
 #if CONFIG_BMDA == 1
@@ -113,15 +116,9 @@ static bool generic_crc32(target_s *const target, uint32_t *const result, const
 	uint8_t bytes[128U];
 #endif
 
-	uint32_t last_time = platform_time_ms();
 	for (size_t offset = 0; offset < len; offset += sizeof(bytes)) {
-		const uint32_t actual_time = platform_time_ms();
-		if (actual_time > last_time + 1000U) {
-			last_time = actual_time;
-			gdb_if_putchar(0, true);
-		}
 		const size_t read_len = MIN(sizeof(bytes), len - offset);
-		if (target_mem32_read(target, bytes, base + offset, (read_len + 3U) & ~3U)) {
+		if (!read(context, bytes, base + offset, (read_len + 3U) & ~3U)) {
 			DEBUG_ERROR("%s: error around address 0x%08" PRIx32 "\n", __func__, (uint32_t)(base + offset));
 			return false;
 		}
@@ -133,26 +130,32 @@ static bool generic_crc32(target_s *const target, uint32_t *const result, const
 	return true;
 }
 
+#if CONFIG_BMDA == 1
+uint32_t bmd_crc32_buffer(const void *const data, const size_t len)
+{
+	const uint8_t *const bytes = (const uint8_t *)data;
+	uint32_t crc = 0xffffffffU;
+	for (size_t offset = 0; offset < len; ++offset)
+		crc = crc32_calc(crc, bytes[offset]);
+	return crc;
+}
+#endif
+
 #else
 #include <libopencm3/stm32/crc.h>
 #include "buffer_utils.h"
 
-static bool stm32_crc32(target_s *const target, uint32_t *const result, const uint32_t base, const size_t len)
+static bool stm32_crc32(
+	const crc32_read_f read, void *const context, uint32_t *const result, const uint32_t base, const size_t len)
 {
 	uint8_t bytes[1024U]; /* ADIv5 MEM-AP AutoInc range */
 
 	CRC_CR |= CRC_CR_RESET;
 
-	uint32_t last_time = platform_time_ms();
 	const size_t adjusted_len = len & ~3U;
 	for (size_t offset = 0; offset < adjusted_len; offset += sizeof(bytes)) {
-		const uint32_t actual_time = platform_time_ms();
-		if (actual_time > last_time + 1000U) {
-			last_time = actual_time;
-			gdb_if_putchar(0, true);
-		}
 		const size_t read_len = MIN(sizeof(bytes), adjusted_len - offset);
-		if (target_mem32_read(target, bytes, base + offset, read_len)) {
+		if (!read(context, bytes, base + offset, read_len)) {
 			DEBUG_ERROR("%s: error around address 0x%08" PRIx32 "\n", __func__, (uint32_t)(base + offset));
 			return false;
 		}
@@ -165,7 +168,7 @@ static bool stm32_crc32(target_s *const target, uint32_t *const result, const ui
 
 	const size_t remainder = len - adjusted_len;
 	if (remainder) {
-		if (target_mem32_read(target, bytes, base + adjusted_len, remainder)) {
+		if (!read(context, bytes, base + adjusted_len, remainder)) {
 			DEBUG_ERROR("%s: error around address 0x%08" PRIx32 "\n", __func__, (uint32_t)(base + adjusted_len));
 			return false;
 		}
@@ -185,16 +188,17 @@ static bool stm32_crc32(target_s *const target, uint32_t *const result, const ui
 #endif
 
 /* Shim to dispatch host-specific implementation (and keep the `__func__` meaningful) */
-bool bmd_crc32(target_s *const target, uint32_t *const result, const uint32_t base, const size_t len)
+bool bmd_crc32_read(
+	const crc32_read_f read, void *const context, uint32_t *const result, const uint32_t base, const size_t len)
 {
 #ifndef DEBUG_INFO_IS_NOOP
 	const uint32_t start_time = platform_time_ms();
 #endif
 #if !defined(STM32F0) && !defined(STM32F1) && !defined(STM32F2) && !defined(STM32F3) && !defined(STM32F4) && \
 	!defined(STM32F7) && !defined(STM32L0) && !defined(STM32L1) && !defined(STM32G0) && !defined(STM32G4)
-	const bool status = generic_crc32(target, result, base, len);
+	const bool status = generic_crc32(read, context, result, base, len);
 #else
-	const bool status = stm32_crc32(target, result, base, len);
+	const bool status = stm32_crc32(read, context, result, base, len);
 #endif
 #ifndef DEBUG_INFO_IS_NOOP
 	/* "generic_crc32: 08000110+75272 -> 1353ms, 54 KiB/s" */
@@ -210,3 +214,29 @@ bool bmd_crc32(target_s *const target, uint32_t *const result, const uint32_t ba
 #endif
 	return status;
 }
+
+typedef struct crc32_target_context {
+	target_s *target;
+	uint32_t last_time;
+} crc32_target_context_s;
+
+static bool crc32_target_read(void *const context, void *const dest, const uint32_t src, const size_t len)
+{
+	crc32_target_context_s *const target_context = (crc32_target_context_s *)context;
+	/* Reading back a large region can take a while, so keep GDB from giving up on us in the mean time */
+	const uint32_t actual_time = platform_time_ms();
+	if (actual_time > target_context->last_time + 1000U) {
+		target_context->last_time = actual_time;
+		gdb_if_putchar(0, true);
+	}
+	return !target_mem32_read(target_context->target, dest, src, len);
+}
+
+bool bmd_crc32(target_s *const target, uint32_t *const result, const uint32_t base, const size_t len)
+{
+	/* If the target has a quicker way to find the CRC than reading everything back, use that */
+	if (target->mem_crc32)
+		return target->mem_crc32(target, result, base, len);
+	crc32_target_context_s context = {.target = target, .last_time = platform_time_ms()};
+	return bmd_crc32_read(crc32_target_read, &context, result, base, len);
+}
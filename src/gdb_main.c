@@ -114,7 +114,7 @@ target_controller_s gdb_controller = {
 };
 
 /* execute gdb remote command stored in 'pbuf'. returns immediately, no busy waiting. */
-int32_t gdb_main_loop(target_controller_s *const tc, const gdb_packet_s *const packet, const bool in_syscall)
+int32_t gdb_main_loop(target_controller_s *const tc, gdb_packet_s *const packet, const bool in_syscall)
 {
 	bool single_step = false;
 	const char *rest = NULL;
@@ -125,8 +125,11 @@ int32_t gdb_main_loop(target_controller_s *const tc, const gdb_packet_s *const p
 	case 'g': { /* 'g': Read general registers */
 		ERROR_IF_NO_TARGET();
 		const size_t reg_size = target_regs_size(cur_target);
-		if (reg_size) {
-			uint8_t *gp_regs = alloca(reg_size);
+		if (reg_size > gdb_packet_max_size() / 2U)
+			gdb_put_packet_error(2U);
+		else if (reg_size) {
+			/* Read the registers into the word-aligned tail of the packet buffer and hexify them forwards over themselves */
+			uint8_t *const gp_regs = (uint8_t *)packet->data + ((gdb_packet_max_size() - reg_size) & ~3U);
 			target_regs_read(cur_target, gp_regs);
 			gdb_put_packet_hex(gp_regs, reg_size);
 		} else {
@@ -145,12 +148,16 @@ int32_t gdb_main_loop(target_controller_s *const tc, const gdb_packet_s *const p
 		uint32_t addr, len;
 		ERROR_IF_NO_TARGET();
 		if (read_hex32(packet->data + 1, &rest, &addr, ',') && read_hex32(rest, NULL, &len, READ_HEX_NO_FOLLOW)) {
-			if (len > GDB_PACKET_BUFFER_SIZE / 2U) {
+			if (len > gdb_packet_max_size() / 2U) {
 				gdb_put_packet_error(2U);
 				break;
 			}
 			DEBUG_GDB("m packet: addr = %" PRIx32 ", len = %" PRIx32 "\n", addr, len);
-			uint8_t *mem = alloca(len);
+			/*
+			 * Read the data into the word-aligned tail of the packet buffer so that it can be hexified
+			 * forwards over itself into the reply without needing a separate buffer for it
+			 */
+			uint8_t *const mem = (uint8_t *)packet->data + ((gdb_packet_max_size() - len) & ~3U);
 			if (target_mem32_read(cur_target, mem, addr, len))
 				gdb_put_packet_error(1U);
 			else
@@ -159,12 +166,41 @@ int32_t gdb_main_loop(target_controller_s *const tc, const gdb_packet_s *const p
 			gdb_put_packet_error(0xffU);
 		break;
 	}
+	case 'x': { /* 'x addr,len': Read len bytes from addr as binary data */
+		target_addr32_t addr;
+		uint32_t len;
+		ERROR_IF_NO_TARGET();
+		if (read_hex32(packet->data + 1, &rest, &addr, ',') && read_hex32(rest, NULL, &len, READ_HEX_NO_FOLLOW)) {
+			/*
+			 * Read the data into the packet buffer just past the 'b' that prefixes the reply, keeping it
+			 * word-aligned for the target's benefit. The reply is allowed to be shorter than requested,
+			 * so rather than error, clamp the length to what fits in the buffer
+			 */
+			len = MIN(len, gdb_packet_max_size() - 4U);
+			DEBUG_GDB("x packet: addr = %" PRIx32 ", len = %" PRIx32 "\n", addr, len);
+			uint8_t *const mem = (uint8_t *)packet->data + 4U;
+			if (target_mem32_read(cur_target, mem, addr, len))
+				gdb_put_packet_error(1U);
+			else
+				/*
+				 * Binary memory read response
+				 * See https://sourceware.org/gdb/current/onlinedocs/gdb.html/Packets.html#x-packet
+				 *
+				 * Format: 'b XX...'
+				 * The data is sent as-is, with only the reserved characters escaped during transmission
+				 */
+				gdb_put_packet("b", 1U, (const char *)mem, len, false);
+		} else
+			gdb_put_packet_error(0xffU);
+		break;
+	}
 	case 'G': { /* 'G XX': Write general registers */
 		ERROR_IF_NO_TARGET();
 		const size_t reg_size = target_regs_size(cur_target);
 		if (reg_size) {
-			uint8_t *gp_regs = alloca(reg_size);
-			unhexify(gp_regs, packet->data + 1, reg_size);
+			/* Decode the register data to the (aligned) start of the packet buffer, over the hex it came from */
+			uint8_t *const gp_regs = (uint8_t *)packet->data;
+			unhexify(gp_regs, packet->data + 1U, reg_size);
 			target_regs_write(cur_target, gp_regs);
 		}
 		gdb_put_packet_ok();
@@ -180,7 +216,8 @@ int32_t gdb_main_loop(target_controller_s *const tc, const gdb_packet_s *const p
 				break;
 			}
 			DEBUG_GDB("M packet: addr = %" PRIx32 ", len = %" PRIx32 "\n", addr, len);
-			uint8_t *mem = alloca(len);
+			/* Decode the data to the (aligned) start of the packet buffer, over the hex it came from */
+			uint8_t *const mem = (uint8_t *)packet->data;
 			unhexify(mem, rest, len);
 			if (target_mem32_write(cur_target, addr, mem, len))
 				gdb_put_packet_error(1U);
@@ -365,7 +402,13 @@ int32_t gdb_main_loop(target_controller_s *const tc, const gdb_packet_s *const p
 				break;
 			}
 			DEBUG_GDB("X packet: addr = %" PRIx32 ", len = %" PRIx32 "\n", addr, len);
-			if (target_mem32_write(cur_target, addr, rest, len))
+			/*
+			 * The binary data was already unescaped by the packet receiver, so just move it down to the
+			 * (aligned) start of the packet buffer to keep word-wise target write paths happy
+			 */
+			uint8_t *const mem = (uint8_t *)packet->data;
+			memmove(mem, rest, len);
+			if (target_mem32_write(cur_target, addr, mem, len))
 				gdb_put_packet_error(1U);
 			else
 				gdb_put_packet_ok();
@@ -478,9 +521,9 @@ static void exec_q_supported(const char *packet, const size_t length)
 	 * according to the GDB source code (as of version 15.2) it should be a hexadecimal encoded number
 	 * to be parsed by strtoul() with a base of 16.
 	 */
-	gdb_putpacket_str_f("PacketSize=%x;qXfer:memory-map:read+;qXfer:features:read+;"
-						"vContSupported+" GDB_QSUPPORTED_NOACKMODE,
-		GDB_PACKET_BUFFER_SIZE);
+	gdb_putpacket_str_f("PacketSize=%" PRIx32 ";qXfer:memory-map:read+;qXfer:features:read+;"
+						"vContSupported+;binary-upload+" GDB_QSUPPORTED_NOACKMODE,
+		(uint32_t)gdb_packet_max_size());
 
 	/*
 	 * If an acknowledgement was received in response while in NoAckMode, then NoAckMode is probably
@@ -505,9 +548,12 @@ static void exec_q_memory_map(const char *packet, const size_t length)
 		gdb_put_packet_error(1U);
 		return;
 	}
-	char buf[1024];
-	target_mem_map(target, buf, sizeof(buf)); /* Fixme: Check size!*/
-	handle_q_string_reply(buf, packet);
+	const char *const map = target_mem_map(target);
+	if (!map) {
+		gdb_put_packet_error(1U);
+		return;
+	}
+	handle_q_string_reply(map, packet);
 }
 
 static void exec_q_feature_read(const char *packet, const size_t length)
@@ -524,10 +570,6 @@ static void exec_q_feature_read(const char *packet, const size_t length)
 	}
 	const char *const description = target_regs_description(target);
 	handle_q_string_reply(description ? description : "", packet);
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wcast-qual"
-	free((void *)description);
-#pragma GCC diagnostic pop
 }
 
 static void exec_q_crc(const char *packet, const size_t length)
@@ -926,7 +968,7 @@ static void handle_z_packet(const gdb_packet_s *const packet)
 		gdb_put_packet_error(1U);
 }
 
-void gdb_main(const gdb_packet_s *const packet)
+void gdb_main(gdb_packet_s *const packet)
 {
 	gdb_main_loop(&gdb_controller, packet, false);
 }
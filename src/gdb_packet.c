@@ -41,7 +41,45 @@ typedef enum packet_state {
 
 static bool noackmode = false;
 
-#ifdef EXTERNAL_PACKET_BUFFER
+#if CONFIG_BMDA == 1
+static gdb_packet_s packet_buffer;
+static size_t packet_buffer_size = GDB_PACKET_BUFFER_SIZE_BMDA_DEFAULT;
+
+void gdb_packet_set_max_size(const size_t size)
+{
+	/* The buffer size can only be changed before it's been allocated */
+	if (packet_buffer.data) {
+		DEBUG_WARN("Packet buffer already allocated, ignoring request to resize it\n");
+		return;
+	}
+	/* Keep the size a multiple of 8 so the handlers can place data word-aligned at the end of the buffer */
+	packet_buffer_size = MIN(MAX(size, GDB_PACKET_BUFFER_SIZE), GDB_PACKET_BUFFER_SIZE_BMDA_MAX) & ~7U;
+}
+
+size_t gdb_packet_max_size(void)
+{
+	return packet_buffer_size;
+}
+
+static gdb_packet_s *gdb_full_packet_buffer(void)
+{
+	if (!packet_buffer.data) {
+		/* Allocate the packet data with space for a trailing NUL */
+		packet_buffer.data = malloc(packet_buffer_size + 1U);
+		if (!packet_buffer.data) {
+			DEBUG_ERROR("malloc: failed in %s\n", __func__);
+			exit(1);
+		}
+		DEBUG_INFO("Using a %zu byte GDB packet buffer\n", packet_buffer_size);
+	}
+	return &packet_buffer;
+}
+
+char *gdb_packet_buffer(void)
+{
+	return gdb_full_packet_buffer()->data;
+}
+#elif defined(EXTERNAL_PACKET_BUFFER)
 extern gdb_packet_s *gdb_full_packet_buffer(void);
 #else
 /* This has to be aligned so the remote protocol can re-use it without causing Problems */
@@ -57,7 +95,7 @@ char *gdb_packet_buffer(void)
 	/* Return the static packet data buffer */
 	return packet_buffer.data;
 }
-#endif /* EXTERNAL_PACKET_BUFFER */
+#endif /* CONFIG_BMDA || EXTERNAL_PACKET_BUFFER */
 
 /* https://sourceware.org/gdb/onlinedocs/gdb/Packet-Acknowledgment.html */
 void gdb_set_noackmode(const bool enable)
@@ -119,6 +157,28 @@ static uint8_t gdb_packet_checksum(const gdb_packet_s *const packet)
 	return checksum;
 }
 
+#if CONFIG_BMDA == 0
+static packet_state_e consume_remote_binary_packet(char *const packet, const size_t size)
+{
+	/* Binary frames carry the length of their payload as a 16-bit little endian value */
+	const uint8_t length_low = (uint8_t)gdb_if_getchar();
+	const uint8_t length_high = (uint8_t)gdb_if_getchar();
+	const size_t length = length_low | ((size_t)length_high << 8U);
+	/* Consume the whole payload even if it won't fit so we stay in step with the host */
+	for (size_t offset = 0; offset < length; ++offset) {
+		const char rx_char = gdb_if_getchar();
+		if (offset < size)
+			packet[offset] = rx_char;
+	}
+	/* An oversized frame is handed over as empty so it gets rejected with a length error */
+	remote_packet_process_binary((uint8_t *)packet, length <= size ? length : 0U);
+
+	/* Restart packet capture */
+	packet[0] = '\0';
+	return PACKET_IDLE;
+}
+#endif
+
 packet_state_e consume_remote_packet(char *const packet, const size_t size)
 {
 #if CONFIG_BMDA == 0
@@ -128,6 +188,10 @@ packet_state_e consume_remote_packet(char *const packet, const size_t size)
 		/* Consume bytes until we either have a complete remote control packet or have to leave this mode */
 		const char rx_char = gdb_if_getchar();
 
+		/* Binary frames are length-prefixed rather than terminated, so hand them off */
+		if (offset == 0U && rx_char == REMOTE_BINARY_PACKET)
+			return consume_remote_binary_packet(packet, size);
+
 		switch (rx_char) {
 		case '\x04':
 			packet[0] = rx_char;
@@ -174,14 +238,34 @@ packet_state_e consume_remote_packet(char *const packet, const size_t size)
 #endif
 }
 
+#if CONFIG_BMDA == 0
+/* Wait for the next character from the host, servicing any armed remote memory watch while we do */
+static char gdb_packet_idle_getchar(void)
+{
+	while (remote_mem_watch_armed()) {
+		const char rx_char = gdb_if_getchar_to(REMOTE_MEM_WATCH_INTERVAL);
+		/* gdb_if_getchar_to() hands back -1 on timeout, which can't otherwise start anything */
+		if (rx_char != (char)-1)
+			return rx_char;
+		remote_mem_watch_poll();
+	}
+	return gdb_if_getchar();
+}
+#endif
+
 gdb_packet_s *gdb_packet_receive(void)
 {
 	packet_state_e state = PACKET_IDLE; /* State of the packet capture */
 	uint8_t rx_checksum = 0;
 	gdb_packet_s *packet = gdb_full_packet_buffer();
+	const size_t max_size = gdb_packet_max_size();
 
 	while (true) {
+#if CONFIG_BMDA == 0
+		const char rx_char = state == PACKET_IDLE ? gdb_packet_idle_getchar() : gdb_if_getchar();
+#else
 		const char rx_char = gdb_if_getchar();
+#endif
 
 		switch (state) {
 		case PACKET_IDLE:
@@ -229,9 +313,14 @@ gdb_packet_s *gdb_packet_receive(void)
 			if (rx_char == GDB_PACKET_ESCAPE)
 				/* GDB Escaped char */
 				state = PACKET_GDB_ESCAPE;
-			else
+			else {
 				/* Add to packet buffer */
 				packet->data[packet->size++] = rx_char;
+#if CONFIG_BMDA == 1
+				/* Pull in as much of the rest of the packet body as is already buffered in one go */
+				packet->size += gdb_if_getchars(packet->data + packet->size, max_size - packet->size);
+#endif
+			}
 			break;
 
 		case PACKET_GDB_ESCAPE:
@@ -283,7 +372,7 @@ gdb_packet_s *gdb_packet_receive(void)
 			break;
 		}
 
-		if (packet->size >= GDB_PACKET_BUFFER_SIZE)
+		if (packet->size >= max_size)
 			/* Buffer overflow, restart packet capture */
 			state = PACKET_IDLE;
 	}
@@ -362,13 +451,18 @@ void gdb_put_packet(const char *preamble, size_t preamble_size, const char *data
 	/*
 	 * Copy the preamble and data into the packet buffer, limited by the buffer size
 	 *
-	 * This considers GDB_PACKET_BUFFER_SIZE to be the maximum size of the packet
+	 * This considers gdb_packet_max_size() to be the maximum size of the packet
 	 * But it does not take into consideration the extra space needed for escaping
 	 * This is safe because the escaping is done during the actual packet transmission
 	 * but it will result in a packet larger than what we told GDB we could handle
+	 *
+	 * The data may itself live in the packet buffer, provided it sits at or beyond
+	 * where its (possibly hexified) form will be written, which lets callers fill the
+	 * buffer directly rather than needing a separate scratch buffer
 	 */
+	const size_t max_size = gdb_packet_max_size();
 	if (preamble != NULL && preamble_size > 0) {
-		preamble_size = MIN(preamble_size, GDB_PACKET_BUFFER_SIZE);
+		preamble_size = MIN(preamble_size, max_size);
 		memcpy(packet->data, preamble, preamble_size);
 		packet->size = preamble_size;
 	}
@@ -380,14 +474,14 @@ void gdb_put_packet(const char *preamble, size_t preamble_size, const char *data
 			data_size *= 2U;
 
 		/* Limit the data size to the remaining space in the packet buffer */
-		const size_t remaining_size = GDB_PACKET_BUFFER_SIZE - packet->size;
+		const size_t remaining_size = max_size - packet->size;
 		data_size = MIN(data_size, remaining_size);
 
 		/* Copy the data into the packet buffer */
 		if (hex_data)
 			hexify(packet->data + packet->size, data, data_size / 2U);
 		else
-			memcpy(packet->data + packet->size, data, data_size);
+			memmove(packet->data + packet->size, data, data_size);
 		packet->size += data_size;
 	}
 
@@ -407,18 +501,18 @@ void gdb_putpacket_str_f(const char *const fmt, ...)
 
 	/*
 	 * Format the string directly into the packet buffer
-	 * This considers GDB_PACKET_BUFFER_SIZE to be the maximum size of the string
+	 * This considers gdb_packet_max_size() to be the maximum size of the string
 	 * But it does not take into consideration the extra space needed for escaping
 	 * This is safe because the escaping is done during the actual packet transmission
 	 * but it will result in a packet larger than what we told GDB we could handle
 	 */
 	va_list ap;
 	va_start(ap, fmt);
-	vsnprintf(packet->data, sizeof(packet->data), fmt, ap);
+	vsnprintf(packet->data, gdb_packet_max_size() + 1U, fmt, ap);
 	va_end(ap);
 
 	/* Get the size of the formatted string */
-	packet->size = strnlen(packet->data, GDB_PACKET_BUFFER_SIZE);
+	packet->size = strnlen(packet->data, gdb_packet_max_size());
 
 	/* Transmit the packet */
 	gdb_packet_send(packet);
@@ -434,7 +528,7 @@ void gdb_put_notification_str(const char *const str)
 	 */
 	packet->notification = true;
 
-	packet->size = strnlen(str, GDB_PACKET_BUFFER_SIZE);
+	packet->size = strnlen(str, gdb_packet_max_size());
 	memcpy(packet->data, str, packet->size);
 
 	/* Transmit the packet */
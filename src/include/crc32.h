@@ -24,6 +24,18 @@
 #include <stdint.h>
 #include <target.h>
 
+/* Reads len bytes from src into dest for CRC calculation, returning false on failure */
+typedef bool (*crc32_read_f)(void *context, void *dest, uint32_t src, size_t len);
+
 bool bmd_crc32(target_s *target, uint32_t *crc, uint32_t base, size_t len);
+/*
+ * Calculate the CRC32 of memory fetched by the given read function rather than from a target. This sends
+ * nothing to GDB, so keeping it from timing out on a long calculation is up to the read function
+ */
+bool bmd_crc32_read(crc32_read_f read, void *context, uint32_t *crc, uint32_t base, size_t len);
+#if CONFIG_BMDA == 1
+/* Calculate the CRC32 of a buffer in host memory, such as an image about to be verified against a target */
+uint32_t bmd_crc32_buffer(const void *data, size_t len);
+#endif
 
 #endif /* INCLUDE_CRC32_H */
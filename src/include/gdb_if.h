@@ -29,6 +29,13 @@ void gdb_usb_out_cb(usbd_device *dev, uint8_t ep);
 int gdb_if_init(void);
 char gdb_if_getchar(void);
 char gdb_if_getchar_to(uint32_t timeout);
+#if CONFIG_BMDA == 1
+/*
+ * Bulk receive of already buffered data, stopping short of any GDB packet framing or escape character.
+ * This never blocks and returns the number of characters copied into the buffer
+ */
+size_t gdb_if_getchars(char *buffer, size_t length);
+#endif
 
 /* sending gdb_if_putchar(0, true) seems to work as keep alive */
 void gdb_if_putchar(char c, bool flush);
@@ -28,7 +28,7 @@ extern bool gdb_target_running;
 extern target_s *cur_target;
 
 void gdb_poll_target(void);
-void gdb_main(const gdb_packet_s *packet);
-int32_t gdb_main_loop(target_controller_s *tc, const gdb_packet_s *packet, bool in_syscall);
+void gdb_main(gdb_packet_s *packet);
+int32_t gdb_main_loop(target_controller_s *tc, gdb_packet_s *packet, bool in_syscall);
 
 #endif /* INCLUDE_GDB_MAIN_H */
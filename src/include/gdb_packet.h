@@ -31,6 +31,15 @@
 #define GDB_PACKET_BUFFER_SIZE 1024U
 #endif
 
+#if CONFIG_BMDA == 1
+/*
+ * BMDA allocates its packet buffer on the heap at runtime, so it can be considerably larger than the firmware's.
+ * GDB_PACKET_BUFFER_SIZE remains the minimum so fixed-size users of the buffer continue to fit
+ */
+#define GDB_PACKET_BUFFER_SIZE_BMDA_DEFAULT 65536U
+#define GDB_PACKET_BUFFER_SIZE_BMDA_MAX     (16U * 1024U * 1024U)
+#endif
+
 /* Limit out packet string size to the maximum packet size before hexifying */
 #define GDB_OUT_PACKET_MAX_SIZE ((GDB_PACKET_BUFFER_SIZE - 1U) / 2U)
 
@@ -57,21 +66,37 @@
  * GDB packet structure
  * This is used to store the packet data during transmission and reception
  * This will be statically allocated and aligned to 8 bytes to allow the remote protocol to re-use it
+ * (on BMDA the data is instead heap allocated on first use, sized per gdb_packet_set_max_size())
  * A single packet instance exists in the system and is re-used for all packet operations
  * This means transmiting a packet will invalidate any previously obtained packets
  * Do not use this structure directly or you might risk runing out of memory
  */
 typedef struct gdb_packet {
 	/* Data must be first to ensure alignment */
+#if CONFIG_BMDA == 1
+	char *data; /* Packet data, gdb_packet_max_size() + 1 bytes long */
+#else
 	char data[GDB_PACKET_BUFFER_SIZE + 1U]; /* Packet data */
-	size_t size;                            /* Packet data size */
-	bool notification;                      /* Notification packet */
+#endif
+	size_t size;       /* Packet data size */
+	bool notification; /* Notification packet */
 } gdb_packet_s;
 
 /* GDB packet transmission configuration */
 void gdb_set_noackmode(bool enable);
 bool gdb_noackmode(void);
 
+/* Maximum size of the packet data the packet buffer can hold, as advertised to GDB */
+#if CONFIG_BMDA == 1
+void gdb_packet_set_max_size(size_t size);
+size_t gdb_packet_max_size(void);
+#else
+static inline size_t gdb_packet_max_size(void)
+{
+	return GDB_PACKET_BUFFER_SIZE;
+}
+#endif
+
 /* Raw GDB packet transmission */
 gdb_packet_s *gdb_packet_receive(void);
 void gdb_packet_send(const gdb_packet_s *packet);
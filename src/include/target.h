@@ -60,7 +60,7 @@ target_s *target_attach_n(size_t n, target_controller_s *controller);
 void target_detach(target_s *target);
 
 /* Memory access functions */
-bool target_mem_map(target_s *target, char *buf, size_t len);
+const char *target_mem_map(target_s *target);
 bool target_mem32_read(target_s *target, void *dest, target_addr_t src, size_t len);
 bool target_mem64_read(target_s *target, void *dest, target_addr64_t src, size_t len);
 bool target_mem32_write(target_s *target, target_addr_t dest, const void *src, size_t len);
@@ -97,6 +97,7 @@ typedef struct timeval timeval_s;
 extern bmda_probe_s bmda_probe_info;
 void bmp_ident(bmda_probe_s *info);
 bool find_debuggers(bmda_cli_options_s *cl_opts, bmda_probe_s *info);
+void bmda_probe_open(void);
 void libusb_exit_function(bmda_probe_s *info);
 
 #if HOSTED_BMP_ONLY == 1
@@ -25,12 +25,14 @@
 #include "target.h"
 #include "bmp_remote.h"
 #include "hex_utils.h"
+#include "exception.h"
 
 #include "remote/protocol_v0.h"
 #include "remote/protocol_v1.h"
 #include "remote/protocol_v2.h"
 #include "remote/protocol_v3.h"
 #include "remote/protocol_v4.h"
+#include "remote/protocol_v5.h"
 
 #ifndef _MSC_VER
 #include <sys/time.h>
@@ -40,6 +42,22 @@
 
 bmp_remote_protocol_s remote_funcs;
 
+/* How many requests may be in flight before we stop to collect their responses */
+#define REMOTE_MAX_POSTED 16U
+
+typedef struct remote_posted_request {
+	remote_posted_check_f check;
+	void *context;
+	bool frame;
+} remote_posted_request_s;
+
+static remote_posted_request_s remote_posted_requests[REMOTE_MAX_POSTED];
+static size_t remote_posted_head = 0U;
+static size_t remote_posted_count = 0U;
+
+/* Set when the probe reports that the memory watch armed on it has triggered */
+static bool remote_mem_watch_triggered = false;
+
 uint64_t remote_decode_response(const char *const response, const size_t digits)
 {
 	uint64_t value = 0U;
@@ -50,6 +68,69 @@ uint64_t remote_decode_response(const char *const response, const size_t digits)
 	return value;
 }
 
+void remote_posted_write(const void *const data, const size_t length, const bool frame,
+	const remote_posted_check_f check, void *const context)
+{
+	/* If the queue is full, collect the outstanding responses to make room */
+	if (remote_posted_count == REMOTE_MAX_POSTED)
+		remote_posted_flush();
+	platform_buffer_post(data, length);
+	remote_posted_requests[(remote_posted_head + remote_posted_count) % REMOTE_MAX_POSTED] = (remote_posted_request_s){
+		.check = check,
+		.context = context,
+		.frame = frame,
+	};
+	++remote_posted_count;
+}
+
+bool remote_posted_flush(void)
+{
+	bool result = true;
+	char buffer[REMOTE_MAX_MSG_SIZE];
+	while (remote_posted_count) {
+		/* Dequeue the request before checking it, so an exception can't leave it queued */
+		const remote_posted_request_s request = remote_posted_requests[remote_posted_head];
+		remote_posted_head = (remote_posted_head + 1U) % REMOTE_MAX_POSTED;
+		--remote_posted_count;
+
+		const int length = request.frame ? platform_buffer_read_frame(buffer, REMOTE_MAX_MSG_SIZE) :
+										   platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+		/*
+		 * This is usually on behalf of some unrelated request, so a failure must not raise an exception
+		 * here. It's left in the fault state of whatever the request was for, and reported by our result
+		 */
+		TRY (EXCEPTION_ALL) {
+			if (!request.check(request.context, buffer, length))
+				result = false;
+		}
+		CATCH () {
+		default:
+			DEBUG_ERROR("Posted request failed: %s\n", exception_frame.msg);
+			result = false;
+		}
+	}
+	return result;
+}
+
+static void remote_adiv5_posted_flush(adiv5_debug_port_s *const dp)
+{
+	(void)dp;
+	remote_posted_flush();
+}
+
+void remote_mem_watch_notify(const uint32_t value)
+{
+	DEBUG_PROBE("Remote memory watch triggered on %08" PRIx32 "\n", value);
+	remote_mem_watch_triggered = true;
+}
+
+bool remote_mem_watch_consume(void)
+{
+	const bool triggered = remote_mem_watch_triggered;
+	remote_mem_watch_triggered = false;
+	return triggered;
+}
+
 bool remote_init(const bool power_up)
 {
 	/* When starting remote communications, start by asking the firmware to initialise remote mode */
@@ -100,6 +181,10 @@ bool remote_init(const bool power_up)
 			if (!remote_v4_init())
 				return false;
 			break;
+		case 5:
+			if (!remote_v5_init())
+				return false;
+			break;
 		default:
 			DEBUG_ERROR("Unknown remote protocol version %" PRIu64 ", aborting\n", version);
 			return false;
@@ -208,6 +293,8 @@ bool remote_swd_init(void)
 
 void remote_adiv5_dp_init(adiv5_debug_port_s *const dp)
 {
+	/* Failed posted writes only show up in the DP's fault state once their responses are collected */
+	dp->posted_flush = remote_adiv5_posted_flush;
 	if (remote_funcs.adiv5_init)
 		remote_funcs.adiv5_init(dp);
 }
@@ -235,3 +322,32 @@ void remote_add_jtag_dev(uint32_t dev_index, const jtag_dev_s *jtag_dev)
 	if (remote_funcs.add_jtag_dev)
 		remote_funcs.add_jtag_dev(dev_index, jtag_dev);
 }
+
+bool remote_flash_attach(const bool jtag, const uint32_t targetid, const size_t index, const target_s *const target)
+{
+	/* Probe-side Flash programming needs the probe to be able to tell us what it found */
+	if (!remote_funcs.flash_attach || !target->driver)
+		return false;
+	return remote_funcs.flash_attach(jtag, targetid, index, target->part_id, target->driver);
+}
+
+bool remote_flash_erase(const target_addr_t addr, const size_t length)
+{
+	return remote_funcs.flash_erase(addr, length);
+}
+
+bool remote_flash_write(const target_addr_t dest, const void *const src, const size_t length)
+{
+	return remote_funcs.flash_write(dest, src, length);
+}
+
+bool remote_flash_complete(void)
+{
+	return remote_funcs.flash_complete();
+}
+
+void remote_flash_release(void)
+{
+	if (remote_funcs.flash_release)
+		remote_funcs.flash_release();
+}
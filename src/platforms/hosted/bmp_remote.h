@@ -43,12 +43,21 @@ typedef struct bmp_remote_protocol {
 	uint32_t (*get_comms_frequency)(void);
 	bool (*set_comms_frequency)(uint32_t freq);
 	void (*target_clk_output_enable)(bool enable);
+	bool (*flash_attach)(bool jtag, uint32_t targetid, size_t index, uint16_t part_id, const char *driver);
+	bool (*flash_erase)(target_addr_t addr, size_t length);
+	bool (*flash_write)(target_addr_t dest, const void *src, size_t length);
+	bool (*flash_complete)(void);
+	void (*flash_release)(void);
 } bmp_remote_protocol_s;
 
 extern bmp_remote_protocol_s remote_funcs;
 
 bool platform_buffer_write(const void *data, size_t size);
+bool platform_buffer_post(const void *data, size_t size);
 int platform_buffer_read(void *data, size_t size);
+int platform_buffer_read_frame(void *data, size_t size);
+/* Wait up to timeout milliseconds for the probe to send something unprompted, such as a memory watch trigger */
+void platform_buffer_poll(uint32_t timeout);
 
 bool remote_init(bool power_up);
 bool remote_swd_init(void);
@@ -67,6 +76,32 @@ void remote_adiv6_dp_init(adiv5_debug_port_s *dp);
 void remote_riscv_jtag_dtm_init(riscv_dmi_s *dmi);
 void remote_add_jtag_dev(uint32_t dev_index, const jtag_dev_s *jtag_dev);
 
+bool remote_flash_attach(bool jtag, uint32_t targetid, size_t index, const target_s *target);
+bool remote_flash_erase(target_addr_t addr, size_t length);
+bool remote_flash_write(target_addr_t dest, const void *src, size_t length);
+bool remote_flash_complete(void);
+void remote_flash_release(void);
+
 uint64_t remote_decode_response(const char *response, size_t digits);
 
+/*
+ * Posted requests are sent without waiting for their response, which is collected and checked later by
+ * remote_posted_flush(). This happens automatically before any other request is sent, so whenever a
+ * result is actually needed every response still in flight has been dealt with. As that's usually on behalf
+ * of an unrelated request, checks record failures in the fault state of whatever the request was for rather
+ * than raising exceptions, and remote_posted_flush() returns false.
+ */
+typedef bool (*remote_posted_check_f)(void *context, const void *response, int length);
+
+void remote_posted_write(const void *data, size_t length, bool frame, remote_posted_check_f check, void *context);
+bool remote_posted_flush(void);
+
+/*
+ * The probe tells us about an armed memory watch triggering with an unsolicited frame, which the serial
+ * layer hands to remote_mem_watch_notify() wherever it turns up. remote_mem_watch_consume() then returns
+ * whether that has happened since it was last called.
+ */
+void remote_mem_watch_notify(uint32_t value);
+bool remote_mem_watch_consume(void);
+
 #endif /* PLATFORMS_HOSTED_BMP_REMOTE_H */
@@ -39,6 +39,9 @@
 #endif
 #else
 #include <sys/mman.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <unistd.h>
 #define O_BINARY         0
 #define BMDA_NORMAL_MODE S_IRUSR | S_IWUSR
 #endif
@@ -47,8 +50,11 @@
 #include "target_internal.h"
 #include "cortexm.h"
 #include "command.h"
+#include "crc32.h"
+#include "gdb_packet.h"
 #include "cli.h"
 #include "bmp_hosted.h"
+#include "utils.h"
 
 typedef struct option getopt_option_s;
 
@@ -117,6 +123,9 @@ static bool bmp_mmap(char *file, mmap_data_s *map)
 	return true;
 }
 
+/* Image mapped once up front and shared by all the workers in gang mode */
+static mmap_data_s cl_shared_image;
+
 static void bmp_munmap(mmap_data_s *map)
 {
 #if defined(_WIN32) || defined(__CYGWIN__)
@@ -129,6 +138,158 @@ static void bmp_munmap(mmap_data_s *map)
 #endif
 }
 
+typedef enum cli_verify {
+	CLI_VERIFY_UNAVAILABLE,
+	CLI_VERIFY_PASSED,
+	CLI_VERIFY_FAILED,
+} cli_verify_e;
+
+/* Block size to verify in when the image doesn't start in a known Flash region */
+#define CLI_VERIFY_BLOCK_SIZE 0x1000U
+
+/*
+ * Have the probe, or failing that the target itself, calculate the CRC32 of each block of the range
+ * being verified so none of it needs reading back over the debug link
+ */
+static bool cli_target_crc32_blocks(
+	target_s *const target, uint32_t *const crcs, const uint32_t base, const size_t size, const size_t block_size)
+{
+	if (target->mem_crc32) {
+		for (size_t offset = 0; offset < size; offset += block_size) {
+			if (!bmd_crc32(target, &crcs[offset / block_size], base + offset, MIN(block_size, size - offset)))
+				return false;
+		}
+		return true;
+	}
+	if (target_is_cortexm(target))
+		return cortexm_crc32_blocks(target, crcs, base, size, block_size);
+	return false;
+}
+
+/* Read back a block whose CRC didn't match the image's to find out where they differ */
+static bool cli_verify_block_readback(
+	target_s *const target, const uint32_t base, const uint8_t *const data, const size_t len)
+{
+	uint8_t *const readback = malloc(len);
+	if (!readback || target_mem32_read(target, readback, base, len)) {
+		DEBUG_ERROR("Verify failed in block at 0x%08" PRIx32 "\n", base);
+		free(readback);
+		return false;
+	}
+	size_t offset = 0;
+	while (offset < len && readback[offset] == data[offset])
+		++offset;
+	free(readback);
+	if (offset < len) {
+		DEBUG_ERROR("Verify failed at flash address 0x%08" PRIx32 "\n", (uint32_t)(base + offset));
+		return false;
+	}
+	DEBUG_WARN("CRC mismatch in block at 0x%08" PRIx32 " but its contents match\n", base);
+	return true;
+}
+
+/*
+ * Verify the image a Flash erase block at a time by comparing the CRC32 of each block on the target
+ * against that of the image, only reading back the blocks that don't match to report the failure
+ */
+static cli_verify_e cli_verify_blocks(
+	target_s *const target, const uint32_t base, const uint8_t *const data, const size_t size)
+{
+	if (!size)
+		return CLI_VERIFY_UNAVAILABLE;
+	const target_flash_s *const flash = target_flash_for_addr(target, base);
+	const size_t block_size = flash ? flash->blocksize : CLI_VERIFY_BLOCK_SIZE;
+	const size_t block_count = (size + block_size - 1U) / block_size;
+	uint32_t *const crcs = calloc(block_count, sizeof(*crcs));
+	if (!crcs)
+		return CLI_VERIFY_UNAVAILABLE;
+	if (!cli_target_crc32_blocks(target, crcs, base, size, block_size)) {
+		DEBUG_WARN("Unable to calculate block CRCs on the target, reading back to verify\n");
+		free(crcs);
+		return CLI_VERIFY_UNAVAILABLE;
+	}
+
+	size_t mismatches = 0;
+	for (size_t block = 0; block < block_count; ++block) {
+		const size_t offset = block * block_size;
+		const size_t len = MIN(block_size, size - offset);
+		if (bmd_crc32_buffer(data + offset, len) != crcs[block] &&
+			!cli_verify_block_readback(target, base + offset, data + offset, len))
+			++mismatches;
+	}
+	free(crcs);
+	if (mismatches) {
+		DEBUG_ERROR("Verify failed in %zu of %zu blocks\n", mismatches, block_count);
+		return CLI_VERIFY_FAILED;
+	}
+	return CLI_VERIFY_PASSED;
+}
+
+static void cli_flash_stats_region(FILE *const file, const target_flash_s *const flash)
+{
+	const target_flash_stats_s *const stats = &flash->stats;
+	fprintf(file,
+		"\t\t{\"start\": %" PRIu32 ", \"length\": %" PRIu32 ", \"blocksize\": %" PRIu32 ", \"writesize\": %" PRIu32
+		",\n",
+		flash->start, (uint32_t)flash->length, (uint32_t)flash->blocksize, (uint32_t)flash->writesize);
+	fprintf(file, "\t\t\t\"erase\": {\"count\": %" PRIu32 ", \"bytes\": %" PRIu32 ", \"time_ms\": %" PRIu32 "},\n",
+		stats->erase_count, stats->erase_bytes, stats->erase_time_ms);
+	fprintf(file, "\t\t\t\"mass_erase\": {\"count\": %" PRIu32 ", \"time_ms\": %" PRIu32 "},\n",
+		stats->mass_erase_count, stats->mass_erase_time_ms);
+	fprintf(file,
+		"\t\t\t\"write\": {\"count\": %" PRIu32 ", \"bytes\": %" PRIu32 ", \"time_ms\": %" PRIu32
+		", \"chunks_skipped\": %" PRIu32 "},\n",
+		stats->write_count, stats->write_bytes, stats->write_time_ms, stats->chunks_skipped);
+	fprintf(file, "\t\t\t\"flush\": {\"count\": %" PRIu32 ", \"time_ms\": %" PRIu32 "},\n", stats->flush_count,
+		stats->flush_time_ms);
+	fprintf(file, "\t\t\t\"busy_wait\": {\"polls\": %" PRIu32 ", \"time_ms\": %" PRIu32 "}}", stats->poll_count,
+		stats->poll_time_ms);
+}
+
+/* Write out a string as a JSON string value, escaping anything that would otherwise end or break it */
+static void cli_json_string_write(FILE *const file, const char *const string)
+{
+	fputc('"', file);
+	for (const char *chr = string; *chr; ++chr) {
+		if (*chr == '"' || *chr == '\\')
+			fprintf(file, "\\%c", *chr);
+		else if ((uint8_t)*chr < 0x20U)
+			fprintf(file, "\\u%04x", (uint8_t)*chr);
+		else
+			fputc(*chr, file);
+	}
+	fputc('"', file);
+}
+
+/* Dump the Flash statistics the target collected during the operation, plus how long verification took */
+static void cli_flash_stats_write(
+	const char *const path, const target_s *const target, const bool success, const uint32_t verify_time_ms)
+{
+	const bool use_stdout = !strcmp(path, "-");
+	FILE *const file = use_stdout ? stdout : fopen(path, "w");
+	if (!file) {
+		DEBUG_ERROR("Error opening %s to write Flash statistics: %s\n", path, strerror(errno));
+		return;
+	}
+
+	fprintf(file, "{\n\t\"driver\": ");
+	cli_json_string_write(file, target->driver);
+	fprintf(file, ",\n\t\"success\": %s,\n", success ? "true" : "false");
+	fprintf(file,
+		"\t\"erase_ms\": %" PRIu32 ",\n\t\"write_ms\": %" PRIu32 ",\n\t\"complete_ms\": %" PRIu32
+		",\n\t\"verify_ms\": %" PRIu32 ",\n",
+		target->flash_erase_time_ms, target->flash_write_time_ms, target->flash_complete_time_ms, verify_time_ms);
+	fprintf(file, "\t\"blocks_compared\": %" PRIu32 ",\n\t\"blocks_skipped\": %" PRIu32 ",\n\t\"regions\": [\n",
+		target->flash_blocks_compared, target->flash_blocks_skipped);
+	for (const target_flash_s *flash = target->flash; flash; flash = flash->next) {
+		cli_flash_stats_region(file, flash);
+		fprintf(file, "%s\n", flash->next ? "," : "");
+	}
+	fprintf(file, "\t]\n}\n");
+	if (!use_stdout)
+		fclose(file);
+}
+
 #ifdef ENABLE_GPIOD
 #define GPIOD_PROBE_SELECTION " | -g GPIO_MAPPING"
 #define GPIOD_PROBE_SELECTION_HELP                                          \
@@ -145,7 +306,7 @@ static void cl_help(char **argv)
 	/* clang-format off */
 	DEBUG_INFO("\n"
 			   "Usage: %s [-h | -l | [-v BITMASK] [-O] [-d PATH | -P NUMBER | -s SERIAL | -c TYPE]\n"
-			   "\t[-n NUMBER] [-j | -A] [-C] [-t | -T] [-e] [-p] [-R[h]] [-H] [-M STRING ...]\n"
+			   "\t[-n NUMBER] [-j | -A] [-C] [-t | -T] [-e] [-p] [-R[h]] [-H] [-D] [-G SIZE] [-M STRING ...]\n"
 			   "\t[-f | -m] [-E | -w | -V | -r] [-a ADDR] [-S number] [file]]\n"
 			   "\n"
 			   "The default is to start a debug server at localhost:2000\n\n"
@@ -165,9 +326,9 @@ static void cl_help(char **argv)
 			   "\t-c, --ftdi-type  Select the FTDI-based debug probe with of the given\n"
 			   "\t                   type (cable)\n"
 			   GPIOD_PROBE_SELECTION_HELP
-			   "\n"
-			   "General configuration options: [-n NUMBER] [-j] [-C] [-t | -T] [-e] [-p] [-R[h]]\n"
-			   "\t\t[-H] [-M STRING ...]\n"
+			   "\n", argv[0]);
+	DEBUG_INFO("General configuration options: [-n NUMBER] [-j] [-C] [-t | -T] [-e] [-p] [-R[h]]\n"
+			   "\t\t[-H] [-D] [-G SIZE] [-M STRING ...]\n"
 			   "\t-n, --number     Select the target device at the given position in the\n"
 			   "\t                   scan chain (use the -t option to get a scan chain listing)\n"
 			   "\t-j, --jtag       Use JTAG instead of SWD\n"
@@ -185,30 +346,45 @@ static void cl_help(char **argv)
 			   "\t-R, --reset      Reset the device. If followed by 'h', this will be done using\n"
 			   "\t                   the hardware reset line instead of over the debug link\n"
 			   "\t-H, --high-level Do not use the high level command API (bmp-remote)\n"
+			   "\t-D, --rescan     Ignore any cached discovery results and walk the target's\n"
+			   "\t                   CoreSight component tree in full, refreshing the cache\n"
+			   "\t-G, --packet-size Set the size of the GDB packet buffer advertised to GDB\n"
+			   "\t                   (1k to 16M, default 64k, suffix with k or M as desired)\n"
 			   "\t-M, --monitor    Run target-specific monitor commands. This option\n"
 			   "\t                   can be repeated for as many commands you wish to run.\n"
 			   "\t                   If the command contains spaces, use quotes around the\n"
 			   "\t                   complete command\n"
 			   "\t-f, --freq       Set an operating frequency for the debug interface\n"
-			   "\n"
-			   "SWD-specific configuration options [-f FREQUENCY | -m TARGET]:\n"
+			   "\n");
+	DEBUG_INFO("SWD-specific configuration options [-f FREQUENCY | -m TARGET]:\n"
 			   "\t-m, --multi-drop  Use the given target ID for selection in SWD multi-drop\n"
 			   "\n"
-			   "Flash operation selection options [-E | -w | -V | -r]:\n"
+			   "Gang programming options [-X SERIAL,SERIAL...]:\n"
+			   "\t-X, --gang       Run the Flash operation on every probe in the comma\n"
+			   "\t                   separated list of serial numbers at once, each in a\n"
+			   "\t                   worker process of its own, and report how each went.\n"
+			   "\t                   Output from each probe is prefixed by its serial number\n"
+			   "\n");
+	DEBUG_INFO("Flash operation selection options [-E | -w | -V | -r]:\n"
 			   "\t-E, --erase      Erase the target device Flash\n"
 			   "\t-w, --write      Write the specified binary file to the target device\n"
 			   "\t                   Flash (the default)\n"
 			   "\t-V, --verify     Verify the target device Flash against the specified\n"
-			   "\t                   binary file\n"
+			   "\t                   binary file, comparing CRC32s of each erase block\n"
+			   "\t                   calculated by the probe or target where possible\n"
 			   "\t-r, --read       Read the target device Flash\n"
 			   "\n"
-			   "Flash operation modifiers options: [-a ADDR] [-S number] [FILE]\n"
+			   "Flash operation modifiers options: [-a ADDR] [-S number] [-i] [-J FILE] [FILE]\n"
 			   "\t-a, --addr       Start address for the given Flash operation (defaults to\n"
 			   "\t                   the start of Flash)\n"
 			   "\t-S, --byte-count Number of bytes to work on in the Flash operation (default\n"
 			   "\t                   is till the operation fails or is complete)\n"
-			   "\t<file>           Binary file to use in Flash operations\n",
-		argv[0]);
+			   "\t-i, --incremental Only erase and program the Flash blocks whose contents\n"
+			   "\t                   differ from the file\n"
+			   "\t-J, --flash-stats Write where the time went in the Flash operation to the\n"
+			   "\t                   given file as JSON ('-' for stdout). This runs the Flash\n"
+			   "\t                   drivers host-side so they can be measured\n"
+			   "\t<file>           Binary file to use in Flash operations\n");
 	/* clang-format on */
 	exit(0);
 }
@@ -233,6 +409,8 @@ static const getopt_option_s long_options[] = {
 	{"power", no_argument, NULL, 'p'},
 	{"reset", optional_argument, NULL, 'R'},
 	{"high-level", no_argument, NULL, 'H'},
+	{"rescan", no_argument, NULL, 'D'},
+	{"packet-size", required_argument, NULL, 'G'},
 	{"monitor", required_argument, NULL, 'M'},
 	{"freq", required_argument, NULL, 'f'},
 	{"multi-drop", required_argument, NULL, 'm'},
@@ -242,6 +420,9 @@ static const getopt_option_s long_options[] = {
 	{"read", no_argument, NULL, 'r'},
 	{"addr", required_argument, NULL, 'a'},
 	{"byte-count", required_argument, NULL, 'S'},
+	{"incremental", no_argument, NULL, 'i'},
+	{"flash-stats", required_argument, NULL, 'J'},
+	{"gang", required_argument, NULL, 'X'},
 #ifdef ENABLE_GPIOD
 	{"gpiod", required_argument, NULL, 'g'},
 #endif
@@ -264,8 +445,8 @@ void cl_init(bmda_cli_options_s *opt, int argc, char **argv)
 	opt->opt_scanmode = BMP_SCAN_SWD;
 	opt->opt_mode = BMP_MODE_DEBUG;
 	while (true) {
-		const int option =
-			getopt_long(argc, argv, "eEFhHv:Od:f:s:I:c:Cln:m:M:wVtTa:S:jApP:rR::k" GPIOD_ARG_STR, long_options, NULL);
+		const int option = getopt_long(
+			argc, argv, "eEFhHDG:v:Od:f:s:I:c:Cln:m:M:wVtTa:S:iJ:X:jApP:rR::k" GPIOD_ARG_STR, long_options, NULL);
 		if (option == -1)
 			break;
 
@@ -285,6 +466,39 @@ void cl_init(bmda_cli_options_s *opt, int argc, char **argv)
 		case 'H':
 			opt->opt_no_hl = true;
 			break;
+		case 'D':
+			opt->opt_rescan = true;
+			break;
+		case 'i':
+			opt->opt_flash_incremental = true;
+			break;
+		case 'J':
+			if (optarg)
+				opt->opt_flash_stats_file = optarg;
+			break;
+		case 'X':
+			if (optarg)
+				opt->opt_gang_serials = optarg;
+			break;
+		case 'G':
+			if (optarg) {
+				char *endptr = NULL;
+				const unsigned long size = strtoul(optarg, &endptr, 0);
+				unsigned long multiplier = 1U;
+				if (endptr[0] == 'k' || endptr[0] == 'K')
+					multiplier = 1024U;
+				else if (endptr[0] == 'm' || endptr[0] == 'M')
+					multiplier = 1024U * 1024U;
+				/* Range check before scaling so negative (wrapped) and huge values can't overflow their way in */
+				if (endptr == optarg || strchr(optarg, '-') || size > GDB_PACKET_BUFFER_SIZE_BMDA_MAX / multiplier ||
+					size * multiplier < GDB_PACKET_BUFFER_SIZE) {
+					DEBUG_ERROR("Packet size must be between %u and %u bytes, got '%s'\n", GDB_PACKET_BUFFER_SIZE,
+						GDB_PACKET_BUFFER_SIZE_BMDA_MAX, optarg);
+					exit(1);
+				}
+				opt->opt_gdb_packet_size = size * multiplier;
+			}
+			break;
 		case 'v':
 			if (optarg) {
 				const char *end = optarg + strlen(optarg);
@@ -572,9 +786,12 @@ int cl_execute(bmda_cli_options_s *opt)
 		goto target_detach;
 
 	mmap_data_s map = {0};
+	uint32_t verify_time_ms = 0U;
 	if (opt->opt_mode == BMP_MODE_FLASH_WRITE || opt->opt_mode == BMP_MODE_FLASH_VERIFY ||
 		opt->opt_mode == BMP_MODE_FLASH_WRITE_VERIFY) {
-		if (!bmp_mmap(opt->opt_flash_file, &map)) {
+		if (cl_shared_image.data)
+			map = cl_shared_image;
+		else if (!bmp_mmap(opt->opt_flash_file, &map)) {
 			DEBUG_ERROR("Can not map file: %s. Aborting!\n", strerror(errno));
 			res = -1;
 			goto target_detach;
@@ -600,7 +817,7 @@ int cl_execute(bmda_cli_options_s *opt)
 		target_reset(target);
 	else if (opt->opt_mode == BMP_MODE_FLASH_ERASE) {
 		DEBUG_INFO("Erase %zu bytes at 0x%08" PRIx32 "\n", opt->opt_flash_size, opt->opt_flash_start);
-		if (!target_flash_erase(target, opt->opt_flash_start, opt->opt_flash_size)) {
+		if (!target_flash_erase(target, opt->opt_flash_start, opt->opt_flash_size) || !target_flash_complete(target)) {
 			DEBUG_ERROR("Flash erase failed!\n");
 			res = -1;
 			goto free_map;
@@ -642,7 +859,18 @@ int cl_execute(bmda_cli_options_s *opt)
 		size_t bytes_read = 0;
 		uint8_t *flash = (uint8_t *)map.data;
 		const uint32_t start_time = platform_time_ms();
-		for (size_t offset = 0; offset < size; offset += WORKSIZE) {
+		cli_verify_e crc_verify = CLI_VERIFY_UNAVAILABLE;
+		if (opt->opt_mode != BMP_MODE_FLASH_READ)
+			crc_verify = cli_verify_blocks(target, flash_src, flash, size);
+		if (crc_verify == CLI_VERIFY_FAILED) {
+			verify_time_ms = platform_time_ms() - start_time;
+			res = -1;
+			goto free_map;
+		}
+		const bool crc_verified = crc_verify == CLI_VERIFY_PASSED;
+		if (crc_verified)
+			bytes_read = size;
+		for (size_t offset = 0; !crc_verified && offset < size; offset += WORKSIZE) {
 			const size_t worksize = MIN(size - offset, WORKSIZE);
 			int n_read = target_mem32_read(target, data, flash_src + offset, worksize);
 			if (n_read) {
@@ -675,6 +903,7 @@ int cl_execute(bmda_cli_options_s *opt)
 			}
 		}
 		const uint32_t end_time = platform_time_ms();
+		verify_time_ms = end_time - start_time;
 		if (read_file != -1)
 			close(read_file);
 		DEBUG_WARN("Read/Verify succeeded for %zu bytes, %8.3fkiB/s\n", bytes_read,
@@ -683,6 +912,11 @@ int cl_execute(bmda_cli_options_s *opt)
 			target_reset(target);
 	}
 free_map:
+	/* Only the modes that erase or program Flash have any Flash statistics to write out */
+	if (opt->opt_flash_stats_file &&
+		(opt->opt_mode == BMP_MODE_FLASH_ERASE || opt->opt_mode == BMP_MODE_FLASH_WRITE ||
+			opt->opt_mode == BMP_MODE_FLASH_WRITE_VERIFY))
+		cli_flash_stats_write(opt->opt_flash_stats_file, target, res == 0, verify_time_ms);
 	if (map.size)
 		bmp_munmap(&map);
 target_detach:
@@ -693,3 +927,186 @@ target_detach:
 	target_list_free();
 	return res;
 }
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+int cl_gang_execute(bmda_cli_options_s *const opt)
+{
+	(void)opt;
+	DEBUG_ERROR("Gang programming is not supported on this platform\n");
+	return -1;
+}
+#else
+#define CL_GANG_MAX_PROBES 32U
+
+typedef struct cl_gang_probe {
+	char *serial;
+	pid_t pid;
+	int output;      /* Read end of the pipe carrying the worker's output, -1 once it's closed */
+	char line[256U]; /* Output line being assembled */
+	size_t line_length;
+} cl_gang_probe_s;
+
+/* Start a worker process that runs the normal single-probe flow against this probe */
+static bool cl_gang_spawn(bmda_cli_options_s *const opt, cl_gang_probe_s *const probe)
+{
+	int pipe_fds[2];
+	if (pipe(pipe_fds)) {
+		DEBUG_ERROR("Could not create a pipe for probe %s: %s\n", probe->serial, strerror(errno));
+		return false;
+	}
+	/* Don't let the worker inherit, and so repeat, anything still buffered */
+	fflush(stdout);
+	fflush(stderr);
+	probe->pid = fork();
+	if (probe->pid < 0) {
+		DEBUG_ERROR("Could not start worker for probe %s: %s\n", probe->serial, strerror(errno));
+		close(pipe_fds[0]);
+		close(pipe_fds[1]);
+		return false;
+	}
+
+	if (probe->pid == 0) {
+		close(pipe_fds[0]);
+		dup2(pipe_fds[1], STDOUT_FILENO);
+		dup2(pipe_fds[1], STDERR_FILENO);
+		close(pipe_fds[1]);
+		setvbuf(stdout, NULL, _IOLBF, 0);
+		opt->opt_serial = probe->serial;
+		opt->opt_gang_serials = NULL;
+		/* Give each probe its own statistics dump rather than having them all overwrite the same file */
+		if (opt->opt_flash_stats_file && strcmp(opt->opt_flash_stats_file, "-") != 0)
+			opt->opt_flash_stats_file = format_string("%s.%s", opt->opt_flash_stats_file, probe->serial);
+		bmda_probe_open();
+		exit(cl_execute(opt));
+	}
+
+	close(pipe_fds[1]);
+	probe->output = pipe_fds[0];
+	probe->line_length = 0U;
+	return true;
+}
+
+static void cl_gang_flush_line(cl_gang_probe_s *const probe)
+{
+	printf("[%s] %.*s\n", probe->serial, (int)probe->line_length, probe->line);
+	probe->line_length = 0U;
+}
+
+/* Pass on whatever the worker has output, a line at a time and prefixed with which probe it's from */
+static void cl_gang_relay(cl_gang_probe_s *const probe)
+{
+	char buffer[1024U];
+	const ssize_t amount = read(probe->output, buffer, sizeof(buffer));
+	if (amount <= 0) {
+		if (probe->line_length)
+			cl_gang_flush_line(probe);
+		close(probe->output);
+		probe->output = -1;
+		return;
+	}
+	for (ssize_t offset = 0; offset < amount; ++offset) {
+		if (buffer[offset] == '\n' || probe->line_length == sizeof(probe->line)) {
+			cl_gang_flush_line(probe);
+			if (buffer[offset] == '\n')
+				continue;
+		}
+		probe->line[probe->line_length++] = buffer[offset];
+	}
+	fflush(stdout);
+}
+
+/*
+ * Run the requested operation on several probes at once. Rather than every probe needing its own
+ * BMDA invocation, the image is mapped once here and each probe is driven from a worker process
+ * forked from this one, which shares the mapping and runs the same flow a single-probe run would
+ */
+int cl_gang_execute(bmda_cli_options_s *const opt)
+{
+	if (opt->opt_mode == BMP_MODE_DEBUG || opt->opt_mode == BMP_MODE_FLASH_READ ||
+		opt->opt_mode == BMP_MODE_SWJ_TEST) {
+		DEBUG_ERROR("Gang programming needs an erase, write, verify, reset or monitor command operation\n");
+		return -1;
+	}
+
+	cl_gang_probe_s probes[CL_GANG_MAX_PROBES] = {{0}};
+	size_t probe_count = 0U;
+	char *state = NULL;
+	for (char *serial = strtok_r(opt->opt_gang_serials, ",", &state); serial; serial = strtok_r(NULL, ",", &state)) {
+		if (probe_count == CL_GANG_MAX_PROBES) {
+			DEBUG_ERROR("Too many probes given, at most %u can be used at once\n", CL_GANG_MAX_PROBES);
+			return -1;
+		}
+		probes[probe_count++].serial = serial;
+	}
+	if (!probe_count) {
+		DEBUG_ERROR("No probe serial numbers given for gang programming\n");
+		return -1;
+	}
+
+	if ((opt->opt_mode == BMP_MODE_FLASH_WRITE || opt->opt_mode == BMP_MODE_FLASH_VERIFY ||
+			opt->opt_mode == BMP_MODE_FLASH_WRITE_VERIFY) &&
+		!bmp_mmap(opt->opt_flash_file, &cl_shared_image)) {
+		DEBUG_ERROR("Can not map file: %s. Aborting!\n", strerror(errno));
+		return -1;
+	}
+
+	const uint32_t start_time = platform_time_ms();
+	size_t running = 0U;
+	for (size_t idx = 0U; idx < probe_count; ++idx) {
+		if (cl_gang_spawn(opt, &probes[idx]))
+			++running;
+		else
+			probes[idx].output = -1;
+	}
+
+	while (running) {
+		struct pollfd poll_fds[CL_GANG_MAX_PROBES];
+		size_t poll_probe[CL_GANG_MAX_PROBES];
+		nfds_t poll_count = 0U;
+		for (size_t idx = 0U; idx < probe_count; ++idx) {
+			if (probes[idx].output == -1)
+				continue;
+			poll_fds[poll_count] = (struct pollfd){.fd = probes[idx].output, .events = POLLIN};
+			poll_probe[poll_count++] = idx;
+		}
+		if (poll(poll_fds, poll_count, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			DEBUG_ERROR("Waiting on probe workers failed: %s\n", strerror(errno));
+			break;
+		}
+		for (nfds_t idx = 0U; idx < poll_count; ++idx) {
+			if (!(poll_fds[idx].revents & (POLLIN | POLLHUP | POLLERR)))
+				continue;
+			cl_gang_probe_s *const probe = &probes[poll_probe[idx]];
+			cl_gang_relay(probe);
+			if (probe->output == -1)
+				--running;
+		}
+	}
+
+	size_t failures = 0U;
+	DEBUG_WARN("Gang operation finished in %" PRIu32 "ms:\n", platform_time_ms() - start_time);
+	for (size_t idx = 0U; idx < probe_count; ++idx) {
+		const cl_gang_probe_s *const probe = &probes[idx];
+		int status = 0;
+		if (probe->pid <= 0 || waitpid(probe->pid, &status, 0) < 0) {
+			DEBUG_ERROR("\t%s: could not be started\n", probe->serial);
+			++failures;
+		} else if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+			DEBUG_WARN("\t%s: succeeded\n", probe->serial);
+		else {
+			if (WIFEXITED(status))
+				DEBUG_ERROR("\t%s: failed with exit code %d\n", probe->serial, WEXITSTATUS(status));
+			else
+				DEBUG_ERROR("\t%s: worker terminated by signal %d\n", probe->serial, WTERMSIG(status));
+			++failures;
+		}
+	}
+	if (cl_shared_image.data)
+		bmp_munmap(&cl_shared_image);
+	if (failures)
+		DEBUG_ERROR("%zu of %zu probes failed\n", failures, probe_count);
+	return failures ? -1 : 0;
+}
+#endif
@@ -67,12 +67,18 @@ typedef struct bmda_cli_options {
 	uint32_t opt_flash_start;
 	uint32_t opt_max_frequency;
 	size_t opt_flash_size;
+	size_t opt_gdb_packet_size;
 	char *opt_gpio_map;
 	bool opt_cmsisdap_allow_fallback;
+	bool opt_rescan;
+	bool opt_flash_incremental;
+	char *opt_flash_stats_file;
+	char *opt_gang_serials;
 } bmda_cli_options_s;
 
 void cl_init(bmda_cli_options_s *opt, int argc, char **argv);
 int cl_execute(bmda_cli_options_s *opt);
+int cl_gang_execute(bmda_cli_options_s *opt);
 bool serial_open(const bmda_cli_options_s *opt, const char *serial);
 void serial_close(void);
 
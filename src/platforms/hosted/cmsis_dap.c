@@ -813,6 +813,7 @@ void dap_adiv5_dp_init(adiv5_debug_port_s *target_dp)
 	target_dp->ap_write = dap_adiv5_ap_write;
 	target_dp->mem_read = dap_adiv5_mem_read;
 	target_dp->mem_write = dap_adiv5_mem_write;
+	target_dp->execute_batch = dap_adiv5_execute_batch;
 }
 
 void dap_adiv6_dp_init(adiv5_debug_port_s *target_dp)
@@ -822,4 +823,6 @@ void dap_adiv6_dp_init(adiv5_debug_port_s *target_dp)
 	target_dp->ap_write = dap_adiv6_ap_write;
 	target_dp->mem_read = dap_adiv6_mem_read;
 	target_dp->mem_write = dap_adiv6_mem_write;
+	/* Batches only know how to drive ADIv5 SELECT, so let ADIv6 DPs run them one access at a time */
+	target_dp->execute_batch = NULL;
 }
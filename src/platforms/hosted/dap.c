@@ -441,6 +441,62 @@ void dap_adiv5_ap_write(adiv5_access_port_s *const target_ap, const uint16_t add
 		DEBUG_ERROR("%s failed (fault = %u)\n", __func__, target_dp->fault);
 }
 
+static bool dap_adiv5_batch_transfer(adiv5_debug_port_s *const target_dp, const dap_transfer_request_s *const requests,
+	const size_t request_count, uint32_t *const *const results, const size_t result_count)
+{
+	uint32_t response_data[12];
+	if (!perform_dap_transfer(target_dp, requests, request_count, response_data, result_count)) {
+		DEBUG_ERROR("%s failed (fault = %u)\n", __func__, target_dp->fault);
+		return false;
+	}
+	for (size_t idx = 0U; idx < result_count; ++idx)
+		*results[idx] = response_data[idx];
+	return true;
+}
+
+bool dap_adiv5_execute_batch(const adiv5_batch_s *const batch)
+{
+	adiv5_debug_port_s *const target_dp = batch->dp;
+	dap_transfer_request_s requests[12];
+	uint32_t *results[12];
+	size_t request_count = 0U;
+	size_t result_count = 0U;
+	/* Keep track of what SELECT holds so AP accesses only need to change it when they switch AP or bank */
+	uint32_t select = 0U;
+	bool select_valid = false;
+	DEBUG_PROBE("%s %zu accesses\n", __func__, batch->count);
+
+	for (size_t idx = 0U; idx < batch->count; ++idx) {
+		const adiv5_batch_op_s *const op = &batch->ops[idx];
+		/* Make sure there's room for this access and the SELECT write that might have to come before it */
+		if (request_count + 2U > ARRAY_LENGTH(requests)) {
+			if (!dap_adiv5_batch_transfer(target_dp, requests, request_count, results, result_count))
+				return false;
+			request_count = 0U;
+			result_count = 0U;
+		}
+		if (op->ap) {
+			/* Select the AP and bank for the register if that's not already the case */
+			const uint32_t ap_select = SWD_DP_REG(op->addr & 0xf0U, op->ap->apsel);
+			if (!select_valid || select != ap_select) {
+				requests[request_count].request = SWD_DP_W_SELECT;
+				requests[request_count++].data = ap_select;
+				select = ap_select;
+				select_valid = true;
+			}
+		} else if (!op->rnw && op->addr == ADIV5_DP_SELECT) {
+			select = op->value;
+			select_valid = true;
+		}
+		requests[request_count].request = (op->addr & 0x0cU) | (op->addr & ADIV5_APnDP ? DAP_TRANSFER_APnDP : 0U) |
+			(op->rnw ? DAP_TRANSFER_RnW : 0U);
+		requests[request_count++].data = op->value;
+		if (op->rnw)
+			results[result_count++] = op->result;
+	}
+	return dap_adiv5_batch_transfer(target_dp, requests, request_count, results, result_count);
+}
+
 uint32_t dap_adiv6_ap_read(adiv5_access_port_s *const base_ap, const uint16_t addr)
 {
 	adiv6_access_port_s *const target_ap = (adiv6_access_port_s *)base_ap;
@@ -88,6 +88,7 @@ uint32_t dap_read_reg(adiv5_debug_port_s *target_dp, uint8_t reg);
 void dap_write_reg(adiv5_debug_port_s *target_dp, uint8_t reg, uint32_t value);
 uint32_t dap_adiv5_ap_read(adiv5_access_port_s *target_ap, uint16_t addr);
 void dap_adiv5_ap_write(adiv5_access_port_s *target_ap, uint16_t addr, uint32_t value);
+bool dap_adiv5_execute_batch(const adiv5_batch_s *batch);
 uint32_t dap_adiv6_ap_read(adiv5_access_port_s *base_ap, uint16_t addr);
 void dap_adiv6_ap_write(adiv5_access_port_s *base_ap, uint16_t addr, uint32_t value);
 void dap_adiv5_mem_read_single(adiv5_access_port_s *target_ap, void *dest, target_addr64_t src, align_e align);
@@ -0,0 +1,301 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * This file implements BMDA's on-disk cache of ADIv5 discovery results. Walking the CoreSight component
+ * trees of a multi-AP part can take seconds over a slow link, so we remember what each walk found, keyed by
+ * the DP and AP identification, and let adi_ap_discover() replay that on the next start instead.
+ *
+ * The cache lives in $XDG_CACHE_HOME/bmda-discovery (or ~/.cache/bmda-discovery, or
+ * %LOCALAPPDATA%\bmda-discovery on Windows) and is a text file with one line per AP, made up of
+ * hex numbers: the key fields, the root component's IDs, the AP state, then the cores found.
+ */
+
+#include "general.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+#include <unistd.h>
+#endif
+
+#include "adi.h"
+#include "discovery_cache.h"
+#include "utils.h"
+
+#define DISCOVERY_CACHE_KEY_LENGTH  10U
+#define DISCOVERY_CACHE_MAX_ENTRIES 64U
+
+typedef struct discovery_cache_entry {
+	uint64_t key[DISCOVERY_CACHE_KEY_LENGTH];
+	adi_discovery_s discovery;
+} discovery_cache_entry_s;
+
+static bool discovery_cache_rescan = false;
+static bool discovery_cache_loaded = false;
+static discovery_cache_entry_s *discovery_cache_entries = NULL;
+static size_t discovery_cache_count = 0U;
+
+void bmda_discovery_cache_init(const bool rescan)
+{
+	discovery_cache_rescan = rescan;
+}
+
+static char *discovery_cache_path(void)
+{
+#if defined(_WIN32) || defined(__CYGWIN__)
+	const char *const local_app_data = getenv("LOCALAPPDATA");
+	if (local_app_data)
+		return format_string("%s\\bmda-discovery", local_app_data);
+#else
+	const char *const cache_home = getenv("XDG_CACHE_HOME");
+	if (cache_home && cache_home[0] == '/')
+		return format_string("%s/bmda-discovery", cache_home);
+	const char *const home = getenv("HOME");
+	if (home)
+		return format_string("%s/.cache/bmda-discovery", home);
+#endif
+	return NULL;
+}
+
+/* Build the key identifying which DP and AP a set of discovery results are for */
+static void discovery_cache_key(const adiv5_access_port_s *const ap, uint64_t *const key)
+{
+	const adiv5_debug_port_s *const dp = ap->dp;
+	key[0] = dp->dev_index;
+	key[1] = dp->version;
+	key[2] = dp->designer_code;
+	key[3] = dp->partno;
+	key[4] = dp->target_designer_code;
+	key[5] = dp->target_partno;
+	key[6] = dp->targetsel;
+	key[7] = ap->apsel;
+	key[8] = ap->idr;
+	key[9] = ap->base;
+}
+
+static discovery_cache_entry_s *discovery_cache_find(const uint64_t *const key)
+{
+	for (size_t idx = 0U; idx < discovery_cache_count; ++idx) {
+		if (memcmp(discovery_cache_entries[idx].key, key, sizeof(discovery_cache_entries[idx].key)) == 0)
+			return &discovery_cache_entries[idx];
+	}
+	return NULL;
+}
+
+/* Make room for a new entry, dropping the oldest if the cache is full */
+static discovery_cache_entry_s *discovery_cache_new_entry(void)
+{
+	if (discovery_cache_count == DISCOVERY_CACHE_MAX_ENTRIES) {
+		memmove(discovery_cache_entries, discovery_cache_entries + 1U,
+			sizeof(*discovery_cache_entries) * (discovery_cache_count - 1U));
+		return &discovery_cache_entries[discovery_cache_count - 1U];
+	}
+	discovery_cache_entry_s *const entries =
+		realloc(discovery_cache_entries, sizeof(*discovery_cache_entries) * (discovery_cache_count + 1U));
+	if (!entries)
+		return NULL;
+	discovery_cache_entries = entries;
+	return &discovery_cache_entries[discovery_cache_count++];
+}
+
+static bool discovery_cache_parse_value(char **const cursor, uint64_t *const value)
+{
+	char *end = NULL;
+	*value = strtoull(*cursor, &end, 16);
+	if (end == *cursor)
+		return false;
+	*cursor = end;
+	return true;
+}
+
+/* Parse a line of the cache file into an entry, returning false if it's malformed */
+static bool discovery_cache_parse_line(char *line, discovery_cache_entry_s *const entry)
+{
+	memset(entry, 0, sizeof(*entry));
+	for (size_t idx = 0U; idx < DISCOVERY_CACHE_KEY_LENGTH; ++idx) {
+		if (!discovery_cache_parse_value(&line, &entry->key[idx]))
+			return false;
+	}
+	uint64_t fields[6U];
+	for (size_t idx = 0U; idx < ARRAY_LENGTH(fields); ++idx) {
+		if (!discovery_cache_parse_value(&line, &fields[idx]))
+			return false;
+	}
+	adi_discovery_s *const discovery = &entry->discovery;
+	discovery->root_cidr = (uint32_t)fields[0];
+	discovery->root_pidr = fields[1];
+	discovery->designer_code = (uint16_t)fields[2];
+	discovery->partno = (uint16_t)fields[3];
+	discovery->flags = (uint8_t)fields[4];
+	discovery->count = (size_t)fields[5];
+	if (discovery->count > ADI_DISCOVERY_MAX_COMPONENTS)
+		return false;
+	for (size_t idx = 0U; idx < discovery->count; ++idx) {
+		adi_discovered_component_s *const component = &discovery->components[idx];
+		uint64_t arch = 0U;
+		uint64_t cidr = 0U;
+		if (!discovery_cache_parse_value(&line, &arch) ||
+			!discovery_cache_parse_value(&line, &component->base_address) ||
+			!discovery_cache_parse_value(&line, &cidr) || !discovery_cache_parse_value(&line, &component->pidr))
+			return false;
+		if (arch != aa_cortexm && arch != aa_cortexa && arch != aa_cortexr)
+			return false;
+		component->arch = (arm_arch_e)arch;
+		component->cidr = (uint32_t)cidr;
+	}
+	return true;
+}
+
+static void discovery_cache_load(void)
+{
+	discovery_cache_loaded = true;
+	char *const path = discovery_cache_path();
+	if (!path)
+		return;
+	FILE *const file = fopen(path, "r");
+	free(path);
+	if (!file)
+		return;
+	char line[1024U];
+	while (fgets(line, sizeof(line), file)) {
+		discovery_cache_entry_s entry;
+		if (!discovery_cache_parse_line(line, &entry) || discovery_cache_find(entry.key))
+			continue;
+		discovery_cache_entry_s *const slot = discovery_cache_new_entry();
+		if (!slot)
+			break;
+		*slot = entry;
+	}
+	fclose(file);
+	DEBUG_INFO("Loaded %zu cached discovery results\n", discovery_cache_count);
+}
+
+/*
+ * Write the cache out in full. Elsewhere than Windows this goes via a file of our own that then replaces
+ * the cache, so several BMDA processes (such as gang programming workers) saving at once can't garble it
+ */
+static void discovery_cache_save(void)
+{
+	char *const path = discovery_cache_path();
+	if (!path)
+		return;
+#if defined(_WIN32) || defined(__CYGWIN__)
+	char *const write_path = path;
+#else
+	char *const write_path = format_string("%s.%ld", path, (long)getpid());
+	if (!write_path) {
+		free(path);
+		return;
+	}
+#endif
+	FILE *const file = fopen(write_path, "w");
+	if (!file) {
+		DEBUG_WARN("Could not write discovery cache %s\n", write_path);
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+		free(write_path);
+#endif
+		free(path);
+		return;
+	}
+	for (size_t idx = 0U; idx < discovery_cache_count; ++idx) {
+		const discovery_cache_entry_s *const entry = &discovery_cache_entries[idx];
+		for (size_t key = 0U; key < DISCOVERY_CACHE_KEY_LENGTH; ++key)
+			fprintf(file, "%" PRIx64 " ", entry->key[key]);
+		const adi_discovery_s *const discovery = &entry->discovery;
+		fprintf(file, "%" PRIx32 " %" PRIx64 " %x %x %x %zx", discovery->root_cidr, discovery->root_pidr,
+			discovery->designer_code, discovery->partno, discovery->flags, discovery->count);
+		for (size_t component = 0U; component < discovery->count; ++component)
+			fprintf(file, " %x %" PRIx64 " %" PRIx32 " %" PRIx64, discovery->components[component].arch,
+				discovery->components[component].base_address, discovery->components[component].cidr,
+				discovery->components[component].pidr);
+		fputc('\n', file);
+	}
+	fclose(file);
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+	if (rename(write_path, path))
+		remove(write_path);
+	free(write_path);
+#endif
+	free(path);
+}
+
+/* Compare two discoveries field by field, as their padding bytes aren't necessarily the same */
+static bool discovery_cache_equal(const adi_discovery_s *const a, const adi_discovery_s *const b)
+{
+	if (a->root_pidr != b->root_pidr || a->root_cidr != b->root_cidr || a->designer_code != b->designer_code ||
+		a->partno != b->partno || a->flags != b->flags || a->incomplete != b->incomplete || a->count != b->count)
+		return false;
+	for (size_t idx = 0U; idx < a->count; ++idx) {
+		const adi_discovered_component_s *const component_a = &a->components[idx];
+		const adi_discovered_component_s *const component_b = &b->components[idx];
+		if (component_a->base_address != component_b->base_address || component_a->pidr != component_b->pidr ||
+			component_a->cidr != component_b->cidr || component_a->arch != component_b->arch)
+			return false;
+	}
+	return true;
+}
+
+bool bmda_discovery_cache_lookup(const adiv5_access_port_s *const ap, adi_discovery_s *const discovery)
+{
+	/* If we've been asked to do a full rescan, pretend there's nothing cached so everything gets walked afresh */
+	if (discovery_cache_rescan)
+		return false;
+	if (!discovery_cache_loaded)
+		discovery_cache_load();
+	uint64_t key[DISCOVERY_CACHE_KEY_LENGTH];
+	discovery_cache_key(ap, key);
+	const discovery_cache_entry_s *const entry = discovery_cache_find(key);
+	if (!entry)
+		return false;
+	*discovery = entry->discovery;
+	return true;
+}
+
+void bmda_discovery_cache_store(const adiv5_access_port_s *const ap, const adi_discovery_s *const discovery)
+{
+	if (!discovery_cache_loaded)
+		discovery_cache_load();
+	uint64_t key[DISCOVERY_CACHE_KEY_LENGTH];
+	discovery_cache_key(ap, key);
+	discovery_cache_entry_s *entry = discovery_cache_find(key);
+	if (!entry) {
+		entry = discovery_cache_new_entry();
+		if (!entry)
+			return;
+		memcpy(entry->key, key, sizeof(key));
+	} else if (discovery_cache_equal(&entry->discovery, discovery))
+		/* Nothing changed, so there's nothing to write back */
+		return;
+	entry->discovery = *discovery;
+	discovery_cache_save();
+}
@@ -67,6 +67,7 @@ typedef int32_t socket_t;
 #endif
 
 #include "gdb_if.h"
+#include "gdb_packet.h"
 #include "bmp_hosted.h"
 #include "command.h"
 
@@ -95,6 +96,15 @@ bool shutdown_bmda = false;
 static size_t gdb_buffer_used = 0U;
 static char gdb_buffer[GDB_BUFFER_LEN];
 
+/*
+ * Receive buffer - this is filled by draining everything the kernel has for us in a single recv(),
+ * and then consumed a character at a time by gdb_if_getchar() or in bulk by gdb_if_getchars()
+ */
+#define GDB_RX_BUFFER_LEN 16384U
+static size_t gdb_rx_buffer_offset = 0U;
+static size_t gdb_rx_buffer_used = 0U;
+static char gdb_rx_buffer[GDB_RX_BUFFER_LEN];
+
 typedef struct sockaddr sockaddr_s;
 typedef struct sockaddr_in sockaddr_in_s;
 typedef struct sockaddr_in6 sockaddr_in6_s;
@@ -280,58 +290,75 @@ int gdb_if_init(void)
 	return -1;
 }
 
-char gdb_if_getchar(void)
+static bool gdb_if_accept(void)
 {
-	if (gdb_if_conn == INVALID_SOCKET) {
-		if (shutdown_bmda)
-			return '\x04';
-		const int flags = socket_get_flags(gdb_if_serv);
-		socket_set_flags(gdb_if_serv, flags | O_NONBLOCK);
-		gdb_if_conn = INVALID_SOCKET;
-		while (gdb_if_conn == INVALID_SOCKET) {
-			gdb_if_conn = accept(gdb_if_serv, NULL, NULL);
-			if (gdb_if_conn == INVALID_SOCKET) {
-				const int error = socket_error();
-				if (error == op_would_block) {
-					SET_IDLE_STATE(1);
-					platform_delay(100);
-				} else {
-					display_socket_error(error, gdb_if_serv, "accepting connection from socket");
-					exit(1);
-				}
-				continue;
+	if (shutdown_bmda)
+		return false;
+	const int flags = socket_get_flags(gdb_if_serv);
+	socket_set_flags(gdb_if_serv, flags | O_NONBLOCK);
+	gdb_if_conn = INVALID_SOCKET;
+	while (gdb_if_conn == INVALID_SOCKET) {
+		gdb_if_conn = accept(gdb_if_serv, NULL, NULL);
+		if (gdb_if_conn == INVALID_SOCKET) {
+			const int error = socket_error();
+			if (error == op_would_block) {
+				SET_IDLE_STATE(1);
+				platform_delay(100);
+			} else {
+				display_socket_error(error, gdb_if_serv, "accepting connection from socket");
+				exit(1);
 			}
+			continue;
 		}
-		DEBUG_INFO("Got connection\n");
-		socket_set_flags(gdb_if_serv, flags);
-		socket_set_flags(gdb_if_conn, socket_get_flags(gdb_if_conn) & ~O_NONBLOCK);
 	}
+	DEBUG_INFO("Got connection\n");
+	socket_set_flags(gdb_if_serv, flags);
+	socket_set_flags(gdb_if_conn, socket_get_flags(gdb_if_conn) & ~O_NONBLOCK);
+	/* Make sure nothing from a previous connection is left lying around */
+	gdb_rx_buffer_offset = 0U;
+	gdb_rx_buffer_used = 0U;
+	return true;
+}
 
-	char value = '\0';
-	int error = op_needs_retry;
-	while (error == op_needs_retry) {
-		const ssize_t result = recv(gdb_if_conn, &value, 1, 0);
-		if (result < 0) {
-			error = socket_error();
-			if (error == op_needs_retry)
-				continue;
-		} else
-			error = 0;
-
-		if (result <= 0) {
-			handle_error(gdb_if_conn, "on socket");
-			gdb_if_conn = INVALID_SOCKET;
-			/* Return '+' in case we were waiting for an ACK */
-			return '+';
+/* Refill the receive buffer with as much data as the kernel has available, blocking until at least 1 byte arrives */
+static bool gdb_if_fill_buffer(void)
+{
+	while (true) {
+		const ssize_t result = recv(gdb_if_conn, gdb_rx_buffer, GDB_RX_BUFFER_LEN, 0);
+		if (result > 0) {
+			gdb_rx_buffer_offset = 0U;
+			gdb_rx_buffer_used = (size_t)result;
+			return true;
 		}
+		if (result < 0 && socket_error() == op_needs_retry)
+			continue;
+
+		handle_error(gdb_if_conn, "on socket");
+		gdb_if_conn = INVALID_SOCKET;
+		gdb_rx_buffer_offset = 0U;
+		gdb_rx_buffer_used = 0U;
+		return false;
 	}
-	return value;
+}
+
+char gdb_if_getchar(void)
+{
+	if (gdb_if_conn == INVALID_SOCKET && !gdb_if_accept())
+		return '\x04';
+
+	if (gdb_rx_buffer_offset == gdb_rx_buffer_used && !gdb_if_fill_buffer())
+		/* Return '+' in case we were waiting for an ACK */
+		return '+';
+	return gdb_rx_buffer[gdb_rx_buffer_offset++];
 }
 
 char gdb_if_getchar_to(uint32_t timeout)
 {
 	if (gdb_if_conn == INVALID_SOCKET)
 		return -1;
+	/* If we already have data buffered, there's no need to go ask the kernel if more is available */
+	if (gdb_rx_buffer_offset != gdb_rx_buffer_used)
+		return gdb_rx_buffer[gdb_rx_buffer_offset++];
 
 #ifndef __CYGWIN__
 	timeval_s select_timeout;
@@ -350,6 +377,22 @@ char gdb_if_getchar_to(uint32_t timeout)
 	return -1;
 }
 
+size_t gdb_if_getchars(char *const buffer, const size_t length)
+{
+	/* Copy out already buffered data up to, but not including, the first GDB framing character */
+	const size_t available = MIN(length, gdb_rx_buffer_used - gdb_rx_buffer_offset);
+	const char *const data = gdb_rx_buffer + gdb_rx_buffer_offset;
+	size_t count = 0U;
+	for (; count < available; ++count) {
+		const char value = data[count];
+		if (value == GDB_PACKET_START || value == GDB_PACKET_END || value == GDB_PACKET_ESCAPE)
+			break;
+	}
+	memcpy(buffer, data, count);
+	gdb_rx_buffer_offset += count;
+	return count;
+}
+
 void gdb_if_putchar(const char c, const bool flush)
 {
 	if (gdb_if_conn == INVALID_SOCKET)
@@ -34,9 +34,11 @@
 #include "target.h"
 #include "target_internal.h"
 #include "adiv5.h"
+#include "cortexm.h"
 #include "riscv_debug.h"
 #include "timing.h"
 #include "cli.h"
+#include "discovery_cache.h"
 #include "gdb_if.h"
 #include "gdb_packet.h"
 #include <signal.h>
@@ -69,6 +71,14 @@ static uint32_t max_frequency = 4000000U;
 
 static bmda_cli_options_s cl_opts;
 
+/* The SWD multi-drop target ID last scanned with, so the probe can repeat the scan to offload Flash programming */
+static uint32_t swd_targetid = 0U;
+/* The target whose Flash operations are being run by the probe, and the last one the probe couldn't take on */
+static const target_s *flash_offload_target = NULL;
+static const target_s *flash_offload_failed_target = NULL;
+
+static void bmda_flash_offload_reset(void);
+
 void bmda_display_probe(void)
 {
 	gdb_outf("Using a %s (%s), %s\n", bmda_probe_info.product, bmda_probe_info.manufacturer, bmda_probe_info.version);
@@ -111,20 +121,9 @@ static void sigterm_handler(int sig)
 	exit(0);
 }
 
-void platform_init(int argc, char **argv)
+/* Find and bring up the probe selected by the command line options, exiting if that fails */
+void bmda_probe_open(void)
 {
-#if defined(_WIN32) || defined(__CYGWIN__)
-	SetConsoleOutputCP(CP_UTF8);
-	if (setvbuf(stdout, NULL, _IONBF, 0) < 0) {
-		int err = errno;
-		fprintf(stderr, "%s: %s returns %s\n", __func__, "setvbuf()", strerror(err));
-	}
-#endif
-	cl_init(&cl_opts, argc, argv);
-	atexit(exit_function);
-	signal(SIGTERM, sigterm_handler);
-	signal(SIGINT, sigterm_handler);
-
 	if (cl_opts.opt_device)
 		bmda_probe_info.type = PROBE_TYPE_BMP;
 	else if (cl_opts.opt_gpio_map)
@@ -178,10 +177,35 @@ void platform_init(int argc, char **argv)
 
 	if (cl_opts.opt_max_frequency)
 		max_frequency = cl_opts.opt_max_frequency;
+}
+
+void platform_init(int argc, char **argv)
+{
+#if defined(_WIN32) || defined(__CYGWIN__)
+	SetConsoleOutputCP(CP_UTF8);
+	if (setvbuf(stdout, NULL, _IONBF, 0) < 0) {
+		int err = errno;
+		fprintf(stderr, "%s: %s returns %s\n", __func__, "setvbuf()", strerror(err));
+	}
+#endif
+	cl_init(&cl_opts, argc, argv);
+	bmda_discovery_cache_init(cl_opts.opt_rescan);
+	target_flash_incremental = cl_opts.opt_flash_incremental;
+	atexit(exit_function);
+	signal(SIGTERM, sigterm_handler);
+	signal(SIGINT, sigterm_handler);
+
+	/* Gang programming runs each probe in a worker of its own, so this process never opens one itself */
+	if (cl_opts.opt_gang_serials)
+		exit(cl_gang_execute(&cl_opts));
+
+	bmda_probe_open();
 
 	if (cl_opts.opt_mode != BMP_MODE_DEBUG)
 		exit(cl_execute(&cl_opts));
 	else {
+		if (cl_opts.opt_gdb_packet_size)
+			gdb_packet_set_max_size(cl_opts.opt_gdb_packet_size);
 		gdb_if_init();
 
 #ifdef ENABLE_RTT
@@ -192,7 +216,9 @@ void platform_init(int argc, char **argv)
 
 bool bmda_swd_scan(const uint32_t targetid)
 {
+	bmda_flash_offload_reset();
 	bmda_probe_info.is_jtag = false;
+	swd_targetid = targetid;
 	platform_max_frequency_set(max_frequency);
 
 	switch (bmda_probe_info.type) {
@@ -256,6 +282,7 @@ void bmda_add_jtag_dev(const uint32_t dev_index, const jtag_dev_s *const jtag_de
 
 bool bmda_jtag_scan(void)
 {
+	bmda_flash_offload_reset();
 	bmda_probe_info.is_jtag = true;
 	platform_max_frequency_set(max_frequency);
 
@@ -309,6 +336,99 @@ bool bmda_jtag_init(void)
 	}
 }
 
+static void bmda_flash_offload_reset(void)
+{
+	if (flash_offload_target)
+		remote_flash_release();
+	flash_offload_target = NULL;
+	flash_offload_failed_target = NULL;
+}
+
+typedef struct bmda_target_search {
+	const target_s *target;
+	size_t index;
+} bmda_target_search_s;
+
+static void bmda_target_search(const size_t index, target_s *const target, void *const context)
+{
+	bmda_target_search_s *const search = (bmda_target_search_s *)context;
+	if (target == search->target)
+		search->index = index;
+}
+
+bool bmda_flash_offload_begin(target_s *const target)
+{
+	/*
+	 * Only BMP firmware can run the Flash drivers itself, and they have to run host-side
+	 * for their statistics to be collected for the CLI
+	 */
+	if (bmda_probe_info.type != PROBE_TYPE_BMP || cl_opts.opt_no_hl || cl_opts.opt_flash_stats_file)
+		return false;
+	/*
+	 * The probe's attach clears the breakpoint and watchpoint units, which would leave the slots
+	 * we've handed out for GDB's breakpoints and watchpoints pointing at nothing
+	 */
+	if (target->bw_list)
+		return false;
+	if (target == flash_offload_target)
+		return true;
+	if (target == flash_offload_failed_target)
+		return false;
+
+	/* Find out where in the scan results this target is so the probe can find its own copy of it */
+	bmda_target_search_s search = {.target = target, .index = 0U};
+	target_foreach(bmda_target_search, &search);
+	if (!search.index)
+		return false;
+
+	if (flash_offload_target)
+		remote_flash_release();
+	flash_offload_target = NULL;
+	/* Write back any register changes GDB made before the probe takes over, as they're dropped afterwards */
+	if (target->regs_flush)
+		target->regs_flush(target);
+	if (remote_flash_attach(bmda_probe_info.is_jtag, swd_targetid, search.index, target)) {
+		flash_offload_target = target;
+		target->flash_offloaded = true;
+	} else {
+		flash_offload_failed_target = target;
+	}
+	return flash_offload_target == target;
+}
+
+bool bmda_flash_offload_active(const target_s *const target)
+{
+	return target && target == flash_offload_target;
+}
+
+bool bmda_flash_offload_erase(target_s *const target, const target_addr_t addr, const size_t len)
+{
+	(void)target;
+	return remote_flash_erase(addr, len);
+}
+
+bool bmda_flash_offload_write(target_s *const target, const target_addr_t dest, const void *const src, const size_t len)
+{
+	(void)target;
+	return remote_flash_write(dest, src, len);
+}
+
+bool bmda_flash_offload_complete(target_s *const target)
+{
+	const bool result = remote_flash_complete();
+	/* Let go of the probe's copy of the target so the next Flash operation starts afresh */
+	remote_flash_release();
+	flash_offload_target = NULL;
+	/* The probe ran code and programmed Flash behind our back, so drop anything we had cached */
+	target_mem_cache_invalidate(target);
+	if (target->regs_invalidate)
+		target->regs_invalidate(target);
+	/* The probe's attach also put its own default vector catch settings into DEMCR, so restore ours */
+	if (target_is_cortexm(target))
+		cortexm_demcr_write(target, cortexm_demcr_read(target));
+	return result;
+}
+
 void bmda_adiv5_dp_init(adiv5_debug_port_s *const dp)
 {
 	switch (bmda_probe_info.type) {
@@ -647,7 +767,12 @@ void platform_buffer_flush(void)
 
 void platform_pace_poll(void)
 {
-	if (!cl_opts.fast_poll)
+	if (cl_opts.fast_poll)
+		return;
+	/* Wait on the link to a BMP so a halt reported by the probe cuts the wait short */
+	if (bmda_probe_info.type == PROBE_TYPE_BMP)
+		platform_buffer_poll(8U);
+	else
 		platform_delay(8);
 }
 
@@ -76,6 +76,25 @@ bool remote_v3_adiv5_check_error(
 	return buffer[0] == REMOTE_RESP_OK;
 }
 
+bool remote_v3_adiv5_posted_check(void *const context, const void *const response, const int length)
+{
+	adiv5_debug_port_s *const dp = (adiv5_debug_port_s *)context;
+	volatile bool result = false;
+	/*
+	 * This runs from whichever request next needed the link, so rather than raise an exception there
+	 * for this write failing, leave the failure in the DP's fault state for the next error check to find
+	 */
+	TRY (EXCEPTION_ALL) {
+		result = remote_v3_adiv5_check_error(__func__, dp, (const char *)response, length);
+	}
+	CATCH () {
+	default:
+		if (!dp->fault)
+			dp->fault = exception_frame.type == EXCEPTION_TIMEOUT ? SWD_ACK_WAIT : SWD_ACK_NO_RESPONSE;
+	}
+	return result;
+}
+
 uint32_t remote_v3_adiv5_raw_access(
 	adiv5_debug_port_s *const dp, const uint8_t rnw, const uint16_t addr, const uint32_t request_value)
 {
@@ -147,11 +166,8 @@ void remote_v3_adiv5_ap_write(adiv5_access_port_s *const ap, const uint16_t addr
 	/* Create the request and send it to the remote */
 	ssize_t length =
 		snprintf(buffer, REMOTE_MAX_MSG_SIZE, REMOTE_ADIV5_AP_WRITE_STR, ap->dp->dev_index, ap->apsel, ap_reg, value);
-	platform_buffer_write(buffer, length);
-	/* Read back the answer and check for errors */
-	length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
-	if (!remote_v3_adiv5_check_error(__func__, ap->dp, buffer, length))
-		return;
+	/* Post the request, its response is checked the next time the posted requests are flushed */
+	remote_posted_write(buffer, length, false, remote_v3_adiv5_posted_check, ap->dp);
 	DEBUG_PROBE("%s: addr %04x <- %08" PRIx32 "\n", __func__, ap_reg, value);
 }
 
@@ -225,11 +241,10 @@ void remote_v3_adiv5_mem_write_bytes(adiv5_access_port_s *const ap, const target
 		length += (ssize_t)(amount * 2U);
 		buffer[length++] = REMOTE_EOM;
 		buffer[length++] = '\0';
-		platform_buffer_write(buffer, length);
-
-		/* Read back the answer and check for errors */
-		length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
-		if (!remote_v3_adiv5_check_error(__func__, ap->dp, buffer, length)) {
+		/* Post the request, its response is checked the next time the posted requests are flushed */
+		remote_posted_write(buffer, length, false, remote_v3_adiv5_posted_check, ap->dp);
+		/* Stop at the first chunk to fail, which shows up in the DP's fault state once its response is collected */
+		if (ap->dp->fault) {
 			DEBUG_ERROR("%s error around 0x%08zx\n", __func__, (size_t)dest + offset);
 			return;
 		}
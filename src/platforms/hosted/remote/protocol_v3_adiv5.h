@@ -47,5 +47,7 @@ void remote_v3_adiv5_mem_write_bytes(
 	adiv5_access_port_s *ap, target_addr64_t dest, const void *src, size_t write_length, align_e align);
 
 bool remote_v3_adiv5_check_error(const char *func, adiv5_debug_port_s *dp, const char *buffer, ssize_t length);
+/* Response check for posted ADIv5 requests, the context is the DP the request was for */
+bool remote_v3_adiv5_posted_check(void *context, const void *response, int length);
 
 #endif /*PLATFORMS_HOSTED_REMOTE_PROTOCOL_V3_ADIV5_H*/
@@ -90,6 +90,12 @@ static void remote_v4_adiv5_dp_targetsel(adiv5_debug_port_s *const dp)
 		remote_v4_current_dp_targetsel = dp->targetsel;
 }
 
+void remote_v4_adiv5_dp_sync(adiv5_debug_port_s *const dp)
+{
+	remote_v4_adiv5_dp_version(dp);
+	remote_v4_adiv5_dp_targetsel(dp);
+}
+
 uint32_t remote_v4_adiv5_raw_access(
 	adiv5_debug_port_s *const dp, const uint8_t rnw, const uint16_t addr, const uint32_t request_value)
 {
@@ -184,11 +190,10 @@ void remote_v4_adiv5_mem_write_bytes(adiv5_access_port_s *const ap, const target
 		length += (ssize_t)(amount * 2U);
 		buffer[length++] = REMOTE_EOM;
 		buffer[length++] = '\0';
-		platform_buffer_write(buffer, length);
-
-		/* Read back the answer and check for errors */
-		length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
-		if (!remote_v3_adiv5_check_error(__func__, ap->dp, buffer, length)) {
+		/* Post the request, its response is checked the next time the posted requests are flushed */
+		remote_posted_write(buffer, length, false, remote_v3_adiv5_posted_check, ap->dp);
+		/* As for remote_v3_adiv5_mem_write_bytes(), stop at the first chunk to fail */
+		if (ap->dp->fault) {
 			DEBUG_ERROR("%s error around 0x%08zx\n", __func__, (size_t)dest + offset);
 			return;
 		}
@@ -43,6 +43,8 @@
  * so as to allow calling the DP version setting command v4 introduces to ensure the probe accelerates
  * things correctly.
  */
+/* Synchronise the probe's idea of the DP version and TARGETSEL value with that of the DP given */
+void remote_v4_adiv5_dp_sync(adiv5_debug_port_s *dp);
 uint32_t remote_v4_adiv5_raw_access(adiv5_debug_port_s *dp, uint8_t rnw, uint16_t addr, uint32_t request_value);
 uint32_t remote_v4_adiv5_dp_read(adiv5_debug_port_s *dp, uint16_t addr);
 uint32_t remote_v4_adiv5_ap_read(adiv5_access_port_s *ap, uint16_t addr);
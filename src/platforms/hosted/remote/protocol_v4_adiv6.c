@@ -65,11 +65,8 @@ void remote_v4_adiv6_ap_write(adiv5_access_port_s *base_ap, uint16_t addr, uint3
 	/* Create the request and send it to the remote */
 	ssize_t length = snprintf(
 		buffer, REMOTE_MAX_MSG_SIZE, REMOTE_ADIV6_AP_WRITE_STR, ap->base.dp->dev_index, ap->ap_address, addr, value);
-	platform_buffer_write(buffer, length);
-	/* Read back the answer and check for errors */
-	length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
-	if (!remote_v3_adiv5_check_error(__func__, ap->base.dp, buffer, length))
-		return;
+	/* Post the request, its response is checked the next time the posted requests are flushed */
+	remote_posted_write(buffer, length, false, remote_v3_adiv5_posted_check, ap->base.dp);
 	DEBUG_PROBE("%s: addr %04x <- %08" PRIx32 "\n", __func__, addr, value);
 }
 
@@ -136,11 +133,10 @@ void remote_v4_adiv6_mem_write_bytes(adiv5_access_port_s *const base_ap, const t
 		length += (ssize_t)(amount * 2U);
 		buffer[length++] = REMOTE_EOM;
 		buffer[length++] = '\0';
-		platform_buffer_write(buffer, length);
-
-		/* Read back the answer and check for errors */
-		length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
-		if (!remote_v3_adiv5_check_error(__func__, ap->base.dp, buffer, length)) {
+		/* Post the request, its response is checked the next time the posted requests are flushed */
+		remote_posted_write(buffer, length, false, remote_v3_adiv5_posted_check, ap->base.dp);
+		/* As for remote_v3_adiv5_mem_write_bytes(), stop at the first chunk to fail */
+		if (ap->base.dp->fault) {
 			DEBUG_ERROR("%s error around 0x%08zx\n", __func__, (size_t)dest + offset);
 			return;
 		}
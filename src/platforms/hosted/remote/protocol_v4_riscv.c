@@ -69,8 +69,16 @@ bool remote_v4_riscv_check_error(
 	return buffer[0U] == REMOTE_RESP_OK;
 }
 
+static bool remote_v4_riscv_posted_check(void *const context, const void *const response, const int length)
+{
+	return remote_v4_riscv_check_error(__func__, (riscv_dmi_s *)context, (const char *)response, length);
+}
+
 bool remote_v4_riscv_jtag_dmi_read(riscv_dmi_s *const dmi, const uint32_t address, uint32_t *const value)
 {
+	/* Collect the responses to any posted writes first, if any of those failed then so does this read */
+	if (!remote_posted_flush())
+		return false;
 	/* Format the read request into a new buffer and send it to the probe */
 	char buffer[REMOTE_MAX_MSG_SIZE];
 	ssize_t length = snprintf(buffer, REMOTE_MAX_MSG_SIZE, REMOTE_RISCV_DMI_READ_STR, dmi->dev_index, dmi->idle_cycles,
@@ -94,13 +102,9 @@ bool remote_v4_riscv_jtag_dmi_write(riscv_dmi_s *const dmi, const uint32_t addre
 	char buffer[REMOTE_MAX_MSG_SIZE];
 	ssize_t length = snprintf(buffer, REMOTE_MAX_MSG_SIZE, REMOTE_RISCV_DMI_WRITE_STR, dmi->dev_index, dmi->idle_cycles,
 		dmi->address_width, address, value);
-	platform_buffer_write(buffer, length);
-
-	/* Read back the answer and check for errors */
-	length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
-	if (!remote_v4_riscv_check_error(__func__, dmi, buffer, length))
-		return false;
-	/* Log the probe-level request now it's succeeded */
+	/* Post the request, its response is checked the next time the posted requests are flushed */
+	remote_posted_write(buffer, length, false, remote_v4_riscv_posted_check, dmi);
+	/* Log the probe-level request now it's been sent */
 	DEBUG_PROBE("%s: %08" PRIx32 " <- %08" PRIx32 "\n", __func__, address, value);
 	return true;
 }
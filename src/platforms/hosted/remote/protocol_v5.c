@@ -0,0 +1,186 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2024 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bmp_remote.h"
+#include "buffer_utils.h"
+
+#include "protocol_v2.h"
+#include "protocol_v4.h"
+#include "protocol_v4_adiv5.h"
+#include "protocol_v5.h"
+#include "protocol_v5_defs.h"
+#include "protocol_v5_adiv5.h"
+#include "protocol_v5_flash.h"
+#include "protocol_v5_jtag.h"
+#include "protocol_v5_riscv.h"
+
+size_t remote_v5_frame_payload_size = 0U;
+/* Whether the probe can watch for a target halting on our behalf */
+static bool remote_v5_mem_watch = false;
+/* Whether the probe can calculate memory CRCs for us */
+static bool remote_v5_mem_crc32 = false;
+/* Whether the probe can run batches of DP and AP accesses in one go */
+static bool remote_v5_batch = false;
+
+bool remote_v5_init(void)
+{
+	/* v5 builds on v4, so start by setting up everything v4 would */
+	if (!remote_v4_init())
+		return false;
+
+	/* Now ask the probe how large a binary frame it can handle */
+	platform_buffer_write(REMOTE_HL_FRAME_SIZE_STR, sizeof(REMOTE_HL_FRAME_SIZE_STR));
+
+	char buffer[REMOTE_MAX_MSG_SIZE];
+	const ssize_t length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+	/* Check for communication failures */
+	if (length < 1 || buffer[0] != REMOTE_RESP_OK) {
+		DEBUG_ERROR("%s comms error: %zd\n", __func__, length);
+		return false;
+	}
+
+	const uint64_t frame_size = remote_decode_response(buffer + 1, length - 1);
+	remote_v5_frame_payload_size = MIN(frame_size, REMOTE_BINARY_MAX_PAYLOAD);
+	DEBUG_INFO("Remote binary frames enabled, up to %zu bytes per frame\n", remote_v5_frame_payload_size);
+	/* If the frames are too small to be useful, stick with the v4 text protocol */
+	if (remote_v5_frame_payload_size <= REMOTE_BINARY_ADIV6_MEM_WRITE_LENGTH + 8U)
+		return true;
+
+	/* Check if the probe can run the Flash drivers itself, watch for halts and calculate CRCs for us */
+	platform_buffer_write(REMOTE_HL_ACCEL_STR, sizeof(REMOTE_HL_ACCEL_STR));
+	const ssize_t accel_length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+	if (accel_length < 1 || buffer[0] != REMOTE_RESP_OK) {
+		DEBUG_ERROR("%s comms error: %zd\n", __func__, accel_length);
+		return false;
+	}
+	const uint64_t accelerations = remote_decode_response(buffer + 1, accel_length - 1);
+	if (accelerations & REMOTE_ACCEL_FLASH) {
+		remote_funcs.flash_attach = remote_v5_flash_attach;
+		remote_funcs.flash_erase = remote_v5_flash_erase;
+		remote_funcs.flash_write = remote_v5_flash_write;
+		remote_funcs.flash_complete = remote_v5_flash_complete;
+		remote_funcs.flash_release = remote_v5_flash_release;
+	}
+	remote_v5_mem_watch = accelerations & REMOTE_ACCEL_MEM_WATCH;
+	remote_v5_mem_crc32 = accelerations & REMOTE_ACCEL_MEM_CRC32;
+	/* Only use batches if a full one will fit in a frame */
+	const size_t batch_length =
+		REMOTE_BINARY_ADIV5_BATCH_LENGTH + (REMOTE_BINARY_ADIV5_BATCH_MAX_OPS * REMOTE_BINARY_ADIV5_BATCH_OP_LENGTH);
+	remote_v5_batch = (accelerations & REMOTE_ACCEL_BATCH) && remote_v5_frame_payload_size >= batch_length;
+
+	/* Switch the bulk operations over to their binary framed versions */
+	remote_funcs.jtag_init = remote_v5_jtag_init;
+	if (remote_funcs.adiv5_init)
+		remote_funcs.adiv5_init = remote_v5_adiv5_init;
+	if (remote_funcs.adiv6_init)
+		remote_funcs.adiv6_init = remote_v5_adiv6_init;
+	if (remote_funcs.riscv_jtag_init)
+		remote_funcs.riscv_jtag_init = remote_v5_riscv_jtag_init;
+	return true;
+}
+
+bool remote_v5_adiv5_init(adiv5_debug_port_s *const dp)
+{
+	if (!remote_v4_adiv5_init(dp))
+		return false;
+	dp->mem_read = remote_v5_adiv5_mem_read_bytes;
+	dp->mem_write = remote_v5_adiv5_mem_write_bytes;
+	if (remote_v5_mem_watch) {
+		dp->mem_watch_arm = remote_v5_adiv5_mem_watch_arm;
+		dp->mem_watch_pending = remote_v5_adiv5_mem_watch_pending;
+		dp->mem_watch_disarm = remote_v5_adiv5_mem_watch_disarm;
+	}
+	if (remote_v5_mem_crc32)
+		dp->mem_crc32 = remote_v5_adiv5_mem_crc32;
+	if (remote_v5_batch)
+		dp->execute_batch = remote_v5_adiv5_execute_batch;
+	return true;
+}
+
+bool remote_v5_adiv6_init(adiv5_debug_port_s *const dp)
+{
+	if (!remote_v4_adiv6_init(dp))
+		return false;
+	dp->mem_read = remote_v5_adiv6_mem_read_bytes;
+	dp->mem_write = remote_v5_adiv6_mem_write_bytes;
+	return true;
+}
+
+bool remote_v5_jtag_init(void)
+{
+	if (!remote_v2_jtag_init())
+		return false;
+	jtag_proc.jtagtap_tdi_tdo_seq = remote_v5_jtag_tdi_tdo_seq;
+	jtag_proc.jtagtap_tdi_seq = remote_v5_jtag_tdi_seq;
+	return true;
+}
+
+bool remote_v5_riscv_jtag_init(riscv_dmi_s *const dmi)
+{
+	if (!remote_v4_riscv_jtag_init(dmi))
+		return false;
+	dmi->read = remote_v5_riscv_jtag_dmi_read;
+	dmi->write = remote_v5_riscv_jtag_dmi_write;
+	return true;
+}
+
+static void remote_v5_frame_header(uint8_t *const frame, const size_t payload_length)
+{
+	frame[0] = REMOTE_SOM;
+	frame[1] = REMOTE_BINARY_PACKET;
+	write_le2(frame, 2U, (uint16_t)payload_length);
+}
+
+int remote_v5_frame_exchange(
+	uint8_t *const frame, const size_t payload_length, uint8_t *const response, const size_t response_length)
+{
+	/* Fill in the frame header and send the whole thing to the probe */
+	remote_v5_frame_header(frame, payload_length);
+	platform_buffer_write(frame, REMOTE_BINARY_HEADER_LENGTH + payload_length);
+	/* Now read back the response frame */
+	return platform_buffer_read_frame(response, response_length);
+}
+
+void remote_v5_frame_post(
+	uint8_t *const frame, const size_t payload_length, const remote_posted_check_f check, void *const context)
+{
+	remote_v5_frame_header(frame, payload_length);
+	remote_posted_write(frame, REMOTE_BINARY_HEADER_LENGTH + payload_length, true, check, context);
+}
+
+uint64_t remote_v5_frame_error(const uint8_t *const response, const int length)
+{
+	/* Error frames carry a 64-bit error value, if it's missing then treat this as an unrecognised request */
+	if (length < (int)REMOTE_BINARY_ERROR_LENGTH)
+		return REMOTE_ERROR_UNRECOGNISED;
+	return read_le8(response, 1U);
+}
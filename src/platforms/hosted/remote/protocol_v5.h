@@ -0,0 +1,64 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2024 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PLATFORMS_HOSTED_REMOTE_PROTOCOL_V5_H
+#define PLATFORMS_HOSTED_REMOTE_PROTOCOL_V5_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "adiv5.h"
+#include "riscv_debug.h"
+#include "bmp_remote.h"
+
+/* Largest binary frame payload negotiated with the probe */
+extern size_t remote_v5_frame_payload_size;
+
+bool remote_v5_init(void);
+
+bool remote_v5_adiv5_init(adiv5_debug_port_s *dp);
+bool remote_v5_adiv6_init(adiv5_debug_port_s *dp);
+bool remote_v5_jtag_init(void);
+bool remote_v5_riscv_jtag_init(riscv_dmi_s *dmi);
+
+/*
+ * Send the binary frame request whose payload has been placed just after the frame header in frame,
+ * and read back the response frame. The response code is stored in the first byte of response, followed
+ * by the response payload. Returns the number of bytes stored, or a negative value on comms failure.
+ */
+int remote_v5_frame_exchange(uint8_t *frame, size_t payload_length, uint8_t *response, size_t response_length);
+/* Post a binary frame request, its response is checked by check() when the posted requests are next flushed */
+void remote_v5_frame_post(uint8_t *frame, size_t payload_length, remote_posted_check_f check, void *context);
+/* Decode the 64-bit error value carried by an error response frame */
+uint64_t remote_v5_frame_error(const uint8_t *response, int length);
+
+#endif /*PLATFORMS_HOSTED_REMOTE_PROTOCOL_V5_H*/
@@ -0,0 +1,392 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2024 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <assert.h>
+#include "bmp_remote.h"
+#include "buffer_utils.h"
+#include "cortexm.h"
+#include "protocol_v4_adiv5.h"
+#include "protocol_v5.h"
+#include "protocol_v5_defs.h"
+#include "protocol_v5_adiv5.h"
+#include "exception.h"
+
+static bool remote_v5_adiv5_check_error(
+	const char *const func, adiv5_debug_port_s *const dp, const uint8_t *const response, const int length)
+{
+	/* Check the response length for error codes */
+	if (length < 1) {
+		DEBUG_ERROR("%s comms error: %d\n", func, length);
+		return false;
+	}
+	/* Now check if the remote is reporting an error */
+	if (response[0] == REMOTE_RESP_ERR) {
+		const uint64_t response_code = remote_v5_frame_error(response, length);
+		const uint8_t error = response_code & 0xffU;
+		/* If the error part of the response code indicates a fault, store the fault value */
+		if (error == REMOTE_ERROR_FAULT) {
+			dp->fault = response_code >> 8U;
+			/* Memory accesses getting no response is always fatal, so turn that into an exception */
+			if (dp->fault == SWD_ACK_NO_RESPONSE)
+				raise_exception(EXCEPTION_ERROR, "SWD invalid ACK");
+		}
+		/* If the error part indicates an exception had occurred, make that happen here too */
+		else if (error == REMOTE_ERROR_EXCEPTION)
+			raise_exception(response_code >> 8U, "Remote protocol exception");
+		/* Otherwise it's an unexpected error */
+		else
+			DEBUG_ERROR("%s: Unexpected error %u\n", func, error);
+	} /* Check if the remote is reporting a parameter error*/
+	else if (response[0] == REMOTE_RESP_PARERR)
+		DEBUG_ERROR("%s: !BUG! Firmware reported a parameter error\n", func);
+	/* Check if the firmware is reporting some other kind of error */
+	else if (response[0] != REMOTE_RESP_OK)
+		DEBUG_ERROR("%s: Firmware reported unexpected error: %c\n", func, response[0]);
+	/* Return whether the remote indicated the request was successful */
+	return response[0] == REMOTE_RESP_OK;
+}
+
+static bool remote_v5_adiv5_posted_check(void *const context, const void *const response, const int length)
+{
+	adiv5_debug_port_s *const dp = (adiv5_debug_port_s *)context;
+	volatile bool result = false;
+	/* As for remote_v3_adiv5_posted_check(), report failures through the DP's fault state, not an exception */
+	TRY (EXCEPTION_ALL) {
+		result = remote_v5_adiv5_check_error(__func__, dp, (const uint8_t *)response, length);
+	}
+	CATCH () {
+	default:
+		if (!dp->fault)
+			dp->fault = exception_frame.type == EXCEPTION_TIMEOUT ? SWD_ACK_WAIT : SWD_ACK_NO_RESPONSE;
+	}
+	return result;
+}
+
+void remote_v5_adiv5_mem_read_bytes(
+	adiv5_access_port_s *const ap, void *const dest, const target_addr64_t src, const size_t read_length)
+{
+	/* Check if we have anything to do */
+	if (!read_length)
+		return;
+	remote_v4_adiv5_dp_sync(ap->dp);
+	uint8_t *const data = (uint8_t *)dest;
+	DEBUG_PROBE("%s: @%08" PRIx64 "+%zx\n", __func__, src, read_length);
+	uint8_t frame[REMOTE_BINARY_HEADER_LENGTH + REMOTE_BINARY_MAX_PAYLOAD];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	/* The response frame payload is nothing but the data read, so we can ask for a whole frame's worth at once */
+	const size_t blocksize = remote_v5_frame_payload_size;
+	/* For each transfer block size, ask the firmware to read that block of bytes */
+	for (size_t offset = 0; offset < read_length; offset += blocksize) {
+		/* Pick the amount left to read or the block size, whichever is smaller */
+		const size_t amount = MIN(read_length - offset, blocksize);
+		/* Create the request and send it to the remote */
+		request[0U] = REMOTE_ADIV5_PACKET;
+		request[1U] = REMOTE_MEM_READ;
+		request[2U] = ap->dp->dev_index;
+		request[3U] = ap->apsel;
+		write_le4(request, 4U, ap->csw);
+		write_le8(request, 8U, src + offset);
+		write_le4(request, 16U, amount);
+		/* The response replaces the request in the buffer, so read it back and check for errors */
+		const int length =
+			remote_v5_frame_exchange(frame, REMOTE_BINARY_ADIV5_MEM_READ_LENGTH, frame, 1U + remote_v5_frame_payload_size);
+		if (!remote_v5_adiv5_check_error(__func__, ap->dp, frame, length) || (size_t)length != amount + 1U) {
+			DEBUG_ERROR("%s error around 0x%08zx\n", __func__, (size_t)src + offset);
+			return;
+		}
+		/* If the response indicates all's OK, copy the data read out */
+		memcpy(data + offset, frame + 1U, amount);
+	}
+}
+
+void remote_v5_adiv5_mem_write_bytes(adiv5_access_port_s *const ap, const target_addr64_t dest, const void *const src,
+	const size_t write_length, const align_e align)
+{
+	/* Check if we have anything to do */
+	if (!write_length)
+		return;
+	remote_v4_adiv5_dp_sync(ap->dp);
+	const uint8_t *const data = (const uint8_t *)src;
+	DEBUG_PROBE("%s: @%08" PRIx64 "+%zx alignment %u\n", __func__, dest, write_length, align);
+	uint8_t frame[REMOTE_BINARY_HEADER_LENGTH + REMOTE_BINARY_MAX_PAYLOAD];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	/* As we do, calculate how large a transfer we can do to the firmware */
+	const size_t alignment_mask = ~((1U << align) - 1U);
+	const size_t blocksize = (remote_v5_frame_payload_size - REMOTE_BINARY_ADIV5_MEM_WRITE_LENGTH) & alignment_mask;
+	/* For each transfer block size, ask the firmware to write that block of bytes */
+	for (size_t offset = 0; offset < write_length; offset += blocksize) {
+		/* Pick the amount left to write or the block size, whichever is smaller */
+		const size_t amount = MIN(write_length - offset, blocksize);
+		/* Create the request and copy the data to write in after it */
+		request[0U] = REMOTE_ADIV5_PACKET;
+		request[1U] = REMOTE_MEM_WRITE;
+		request[2U] = ap->dp->dev_index;
+		request[3U] = ap->apsel;
+		write_le4(request, 4U, ap->csw);
+		request[8U] = align;
+		write_le8(request, 9U, dest + offset);
+		write_le4(request, 17U, amount);
+		memcpy(request + REMOTE_BINARY_ADIV5_MEM_WRITE_LENGTH, data + offset, amount);
+
+		/* Post the request, its response is checked the next time the posted requests are flushed */
+		remote_v5_frame_post(frame, REMOTE_BINARY_ADIV5_MEM_WRITE_LENGTH + amount, remote_v5_adiv5_posted_check, ap->dp);
+		/* As for remote_v3_adiv5_mem_write_bytes(), stop at the first chunk to fail */
+		if (ap->dp->fault) {
+			DEBUG_ERROR("%s error around 0x%08zx\n", __func__, (size_t)dest + offset);
+			return;
+		}
+	}
+}
+
+void remote_v5_adiv6_mem_read_bytes(
+	adiv5_access_port_s *const base_ap, void *const dest, const target_addr64_t src, const size_t read_length)
+{
+	/* Check if we have anything to do */
+	if (!read_length)
+		return;
+	adiv6_access_port_s *const ap = (adiv6_access_port_s *)base_ap;
+	uint8_t *const data = (uint8_t *)dest;
+	DEBUG_PROBE("%s: @%08" PRIx64 "+%zx\n", __func__, src, read_length);
+	uint8_t frame[REMOTE_BINARY_HEADER_LENGTH + REMOTE_BINARY_MAX_PAYLOAD];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	/* The response frame payload is nothing but the data read, so we can ask for a whole frame's worth at once */
+	const size_t blocksize = remote_v5_frame_payload_size;
+	/* For each transfer block size, ask the firmware to read that block of bytes */
+	for (size_t offset = 0; offset < read_length; offset += blocksize) {
+		/* Pick the amount left to read or the block size, whichever is smaller */
+		const size_t amount = MIN(read_length - offset, blocksize);
+		/* Create the request and send it to the remote */
+		request[0U] = REMOTE_ADIV5_PACKET;
+		request[1U] = REMOTE_ADIV6_PACKET;
+		request[2U] = REMOTE_MEM_READ;
+		request[3U] = ap->base.dp->dev_index;
+		write_le8(request, 4U, ap->ap_address);
+		write_le4(request, 12U, ap->base.csw);
+		write_le8(request, 16U, src + offset);
+		write_le4(request, 24U, amount);
+		/* The response replaces the request in the buffer, so read it back and check for errors */
+		const int length =
+			remote_v5_frame_exchange(frame, REMOTE_BINARY_ADIV6_MEM_READ_LENGTH, frame, 1U + remote_v5_frame_payload_size);
+		if (!remote_v5_adiv5_check_error(__func__, ap->base.dp, frame, length) || (size_t)length != amount + 1U) {
+			DEBUG_ERROR("%s error around 0x%08zx\n", __func__, (size_t)src + offset);
+			return;
+		}
+		/* If the response indicates all's OK, copy the data read out */
+		memcpy(data + offset, frame + 1U, amount);
+	}
+}
+
+void remote_v5_adiv6_mem_write_bytes(adiv5_access_port_s *const base_ap, const target_addr64_t dest,
+	const void *const src, const size_t write_length, const align_e align)
+{
+	/* Check if we have anything to do */
+	if (!write_length)
+		return;
+	adiv6_access_port_s *const ap = (adiv6_access_port_s *)base_ap;
+	const uint8_t *const data = (const uint8_t *)src;
+	DEBUG_PROBE("%s: @%08" PRIx64 "+%zx alignment %u\n", __func__, dest, write_length, align);
+	uint8_t frame[REMOTE_BINARY_HEADER_LENGTH + REMOTE_BINARY_MAX_PAYLOAD];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	/* As we do, calculate how large a transfer we can do to the firmware */
+	const size_t alignment_mask = ~((1U << align) - 1U);
+	const size_t blocksize = (remote_v5_frame_payload_size - REMOTE_BINARY_ADIV6_MEM_WRITE_LENGTH) & alignment_mask;
+	/* For each transfer block size, ask the firmware to write that block of bytes */
+	for (size_t offset = 0; offset < write_length; offset += blocksize) {
+		/* Pick the amount left to write or the block size, whichever is smaller */
+		const size_t amount = MIN(write_length - offset, blocksize);
+		/* Create the request and copy the data to write in after it */
+		request[0U] = REMOTE_ADIV5_PACKET;
+		request[1U] = REMOTE_ADIV6_PACKET;
+		request[2U] = REMOTE_MEM_WRITE;
+		request[3U] = ap->base.dp->dev_index;
+		write_le8(request, 4U, ap->ap_address);
+		write_le4(request, 12U, ap->base.csw);
+		request[16U] = align;
+		write_le8(request, 17U, dest + offset);
+		write_le4(request, 25U, amount);
+		memcpy(request + REMOTE_BINARY_ADIV6_MEM_WRITE_LENGTH, data + offset, amount);
+
+		/* Post the request, its response is checked the next time the posted requests are flushed */
+		remote_v5_frame_post(frame, REMOTE_BINARY_ADIV6_MEM_WRITE_LENGTH + amount, remote_v5_adiv5_posted_check, ap->base.dp);
+		/* As for remote_v3_adiv5_mem_write_bytes(), stop at the first chunk to fail */
+		if (ap->base.dp->fault) {
+			DEBUG_ERROR("%s error around 0x%08zx\n", __func__, (size_t)dest + offset);
+			return;
+		}
+	}
+}
+
+/* The AP the probe's memory watch is currently armed against, if any */
+static adiv5_access_port_s *remote_v5_mem_watch_ap = NULL;
+
+bool remote_v5_adiv5_mem_watch_arm(
+	adiv5_access_port_s *const ap, const target_addr64_t addr, const uint32_t mask, const uint32_t match)
+{
+	/* If the watch is already armed for this AP, there's nothing more to do */
+	if (remote_v5_mem_watch_ap == ap)
+		return true;
+	if (remote_v5_mem_watch_ap)
+		remote_v5_adiv5_mem_watch_disarm(remote_v5_mem_watch_ap->dp);
+	remote_v4_adiv5_dp_sync(ap->dp);
+	/* Make sure nothing left over from a previous watch gets mistaken for this one triggering */
+	if (!remote_posted_flush())
+		return false;
+	remote_mem_watch_consume();
+
+	DEBUG_PROBE("%s: @%08" PRIx64 " & %08" PRIx32 " == %08" PRIx32 "\n", __func__, addr, mask, match);
+	uint8_t frame[REMOTE_BINARY_HEADER_LENGTH + REMOTE_BINARY_ADIV5_MEM_WATCH_LENGTH];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	request[0U] = REMOTE_ADIV5_PACKET;
+	request[1U] = REMOTE_MEM_WATCH;
+	request[2U] = ap->dp->dev_index;
+	request[3U] = ap->apsel;
+	write_le4(request, 4U, ap->csw);
+	write_le8(request, 8U, addr);
+	write_le4(request, 16U, mask);
+	write_le4(request, 20U, match);
+	const int length = remote_v5_frame_exchange(frame, REMOTE_BINARY_ADIV5_MEM_WATCH_LENGTH, frame, sizeof(frame));
+	if (!remote_v5_adiv5_check_error(__func__, ap->dp, frame, length))
+		return false;
+	remote_v5_mem_watch_ap = ap;
+	return true;
+}
+
+bool remote_v5_adiv5_mem_watch_pending(adiv5_access_port_s *const ap)
+{
+	if (remote_v5_mem_watch_ap != ap)
+		return false;
+	/* Pick up anything the probe has sent without blocking, then see if that included the watch triggering */
+	platform_buffer_poll(0U);
+	if (!remote_mem_watch_consume())
+		return true;
+	/* The probe disarms the watch itself when it triggers */
+	remote_v5_mem_watch_ap = NULL;
+	return false;
+}
+
+void remote_v5_adiv5_mem_watch_disarm(adiv5_debug_port_s *const dp)
+{
+	if (!remote_v5_mem_watch_ap || remote_v5_mem_watch_ap->dp != dp)
+		return;
+	remote_v5_mem_watch_ap = NULL;
+	/* The request is shorter than an error response, so size the frame for the latter */
+	uint8_t frame[REMOTE_BINARY_HEADER_LENGTH + REMOTE_BINARY_ERROR_LENGTH];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	request[0U] = REMOTE_ADIV5_PACKET;
+	request[1U] = REMOTE_MEM_UNWATCH;
+	/* Any trigger notification that raced the disarm request gets picked up while reading the response */
+	const int length = remote_v5_frame_exchange(frame, REMOTE_BINARY_ADIV5_MEM_UNWATCH_LENGTH, frame, sizeof(frame));
+	remote_v5_adiv5_check_error(__func__, dp, frame, length);
+	remote_mem_watch_consume();
+}
+
+/* The probe reads through the whole region before it can answer, so give it this long to respond */
+#define REMOTE_CRC32_TIMEOUT_MS 60000U
+
+bool remote_v5_adiv5_mem_crc32(
+	adiv5_access_port_s *const ap, uint32_t *const result, const target_addr_t base, const size_t len)
+{
+	remote_v4_adiv5_dp_sync(ap->dp);
+	DEBUG_PROBE("%s: @%08" PRIx32 "+%zx\n", __func__, base, len);
+	uint8_t frame[REMOTE_BINARY_HEADER_LENGTH + REMOTE_BINARY_ADIV5_MEM_READ_LENGTH];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	request[0U] = REMOTE_ADIV5_PACKET;
+	request[1U] = REMOTE_MEM_CRC32;
+	request[2U] = ap->dp->dev_index;
+	request[3U] = ap->apsel;
+	write_le4(request, 4U, ap->csw);
+	write_le8(request, 8U, base);
+	write_le4(request, 16U, len);
+
+	const unsigned saved_timeout = cortexm_wait_timeout;
+	cortexm_wait_timeout = REMOTE_CRC32_TIMEOUT_MS;
+	const int length = remote_v5_frame_exchange(frame, REMOTE_BINARY_ADIV5_MEM_READ_LENGTH, frame, sizeof(frame));
+	cortexm_wait_timeout = saved_timeout;
+	if (!remote_v5_adiv5_check_error(__func__, ap->dp, frame, length) || length != 5) {
+		DEBUG_ERROR("%s failed for 0x%08" PRIx32 "+%zx\n", __func__, base, len);
+		return false;
+	}
+	*result = read_le4(frame, 1U);
+	return true;
+}
+
+static_assert(ADIV5_BATCH_MAX_OPS <= REMOTE_BINARY_ADIV5_BATCH_MAX_OPS, "ADIv5 batch too big for remote protocol");
+
+bool remote_v5_adiv5_execute_batch(const adiv5_batch_s *const batch)
+{
+	adiv5_debug_port_s *const dp = batch->dp;
+	/* The probe only knows how to address ADIv5 APs in a batch, so ADIv6 DPs have to go one access at a time */
+	if (dp->version > 2U)
+		return adiv5_batch_run(batch);
+	remote_v4_adiv5_dp_sync(dp);
+	DEBUG_PROBE("%s: %zu accesses\n", __func__, batch->count);
+
+	uint8_t frame[REMOTE_BINARY_HEADER_LENGTH + REMOTE_BINARY_ADIV5_BATCH_LENGTH +
+		(REMOTE_BINARY_ADIV5_BATCH_MAX_OPS * REMOTE_BINARY_ADIV5_BATCH_OP_LENGTH)];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	request[0U] = REMOTE_ADIV5_PACKET;
+	request[1U] = REMOTE_ADIV5_BATCH;
+	request[2U] = dp->dev_index;
+	request[3U] = (uint8_t)batch->count;
+	size_t reads = 0U;
+	for (size_t idx = 0U; idx < batch->count; ++idx) {
+		const adiv5_batch_op_s *const op = &batch->ops[idx];
+		uint8_t *const entry = request + REMOTE_BINARY_ADIV5_BATCH_LENGTH + (idx * REMOTE_BINARY_ADIV5_BATCH_OP_LENGTH);
+		entry[0U] = (op->rnw ? REMOTE_ADIV5_BATCH_READ : 0U) | (op->ap ? REMOTE_ADIV5_BATCH_AP : 0U);
+		entry[1U] = op->ap ? op->ap->apsel : 0U;
+		write_le2(entry, 2U, op->addr);
+		write_le4(entry, 4U, op->value);
+		if (op->rnw)
+			++reads;
+	}
+
+	const size_t payload_length =
+		REMOTE_BINARY_ADIV5_BATCH_LENGTH + (batch->count * REMOTE_BINARY_ADIV5_BATCH_OP_LENGTH);
+	const int length = remote_v5_frame_exchange(frame, payload_length, frame, sizeof(frame));
+	if (!remote_v5_adiv5_check_error(__func__, dp, frame, length))
+		return false;
+	if ((size_t)length != 1U + (reads * 4U)) {
+		DEBUG_ERROR("%s: expected %zu results, got %d bytes\n", __func__, reads, length - 1);
+		return false;
+	}
+	/* Hand the results of all the reads back out to where they're wanted */
+	size_t offset = 1U;
+	for (size_t idx = 0U; idx < batch->count; ++idx) {
+		const adiv5_batch_op_s *const op = &batch->ops[idx];
+		if (!op->rnw)
+			continue;
+		*op->result = read_le4(frame, offset);
+		offset += 4U;
+	}
+	return true;
+}
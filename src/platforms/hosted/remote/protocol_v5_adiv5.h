@@ -0,0 +1,59 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2024 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PLATFORMS_HOSTED_REMOTE_PROTOCOL_V5_ADIV5_H
+#define PLATFORMS_HOSTED_REMOTE_PROTOCOL_V5_ADIV5_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "adiv5.h"
+#include "adiv6.h"
+
+/* NB, only the memory commands go over binary frames, register accesses stay with the v4 implementations */
+void remote_v5_adiv5_mem_read_bytes(adiv5_access_port_s *ap, void *dest, target_addr64_t src, size_t read_length);
+void remote_v5_adiv5_mem_write_bytes(
+	adiv5_access_port_s *ap, target_addr64_t dest, const void *src, size_t write_length, align_e align);
+void remote_v5_adiv6_mem_read_bytes(adiv5_access_port_s *ap, void *dest, target_addr64_t src, size_t read_length);
+void remote_v5_adiv6_mem_write_bytes(
+	adiv5_access_port_s *ap, target_addr64_t dest, const void *src, size_t write_length, align_e align);
+
+/* Probe-side memory watches, used to have the probe look for the core halting rather than polling for it */
+bool remote_v5_adiv5_mem_watch_arm(adiv5_access_port_s *ap, target_addr64_t addr, uint32_t mask, uint32_t match);
+bool remote_v5_adiv5_mem_watch_pending(adiv5_access_port_s *ap);
+void remote_v5_adiv5_mem_watch_disarm(adiv5_debug_port_s *dp);
+
+bool remote_v5_adiv5_mem_crc32(adiv5_access_port_s *ap, uint32_t *result, target_addr_t base, size_t len);
+
+/* Runs a batch of DP and AP register accesses in a single exchange with the probe */
+bool remote_v5_adiv5_execute_batch(const adiv5_batch_s *batch);
+
+#endif /*PLATFORMS_HOSTED_REMOTE_PROTOCOL_V5_ADIV5_H*/
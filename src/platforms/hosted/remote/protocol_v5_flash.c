@@ -0,0 +1,144 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2024 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "bmp_remote.h"
+#include "buffer_utils.h"
+#include "cortexm.h"
+#include "protocol_v5.h"
+#include "protocol_v5_defs.h"
+#include "protocol_v5_flash.h"
+
+/* Flash operations take far longer than other requests, so give the probe this long to respond to them */
+#define REMOTE_FLASH_TIMEOUT_MS 60000U
+
+static int remote_v5_flash_read(char *const buffer, const size_t length)
+{
+	const unsigned saved_timeout = cortexm_wait_timeout;
+	cortexm_wait_timeout = REMOTE_FLASH_TIMEOUT_MS;
+	const int result = platform_buffer_read(buffer, length);
+	cortexm_wait_timeout = saved_timeout;
+	return result;
+}
+
+bool remote_v5_flash_attach(
+	const bool jtag, const uint32_t targetid, const size_t index, const uint16_t part_id, const char *const driver)
+{
+	/* Ask the probe to scan for and attach to its own copy of the target */
+	char buffer[REMOTE_MAX_MSG_SIZE];
+	int length = snprintf(buffer, REMOTE_MAX_MSG_SIZE, REMOTE_FLASH_ATTACH_STR,
+		jtag ? REMOTE_FLASH_SCAN_JTAG : REMOTE_FLASH_SCAN_SWD, targetid, (uint8_t)index);
+	platform_buffer_write(buffer, length);
+
+	/* Read back the answer and check for errors */
+	length = remote_v5_flash_read(buffer, REMOTE_MAX_MSG_SIZE);
+	if (length < 5 || buffer[0] != REMOTE_RESP_OK) {
+		DEBUG_WARN("Probe-side Flash programming unavailable, probe could not attach to the target\n");
+		return false;
+	}
+	/* Check that what the probe found matches the target we're programming */
+	const uint16_t probe_part_id = remote_decode_response(buffer + 1, 4U);
+	if (probe_part_id != part_id || strcmp(buffer + 5, driver) != 0) {
+		DEBUG_WARN("Probe-side Flash programming unavailable, probe found %s (%04x) instead of %s (%04x)\n",
+			buffer + 5, probe_part_id, driver, part_id);
+		remote_v5_flash_release();
+		return false;
+	}
+	DEBUG_INFO("Using probe-side Flash programming for %s\n", driver);
+	return true;
+}
+
+bool remote_v5_flash_erase(const target_addr_t addr, const size_t length)
+{
+	char buffer[REMOTE_MAX_MSG_SIZE];
+	int result = snprintf(buffer, REMOTE_MAX_MSG_SIZE, REMOTE_FLASH_ERASE_STR, addr, (uint32_t)length);
+	platform_buffer_write(buffer, result);
+
+	result = remote_v5_flash_read(buffer, REMOTE_MAX_MSG_SIZE);
+	if (result < 1 || buffer[0] != REMOTE_RESP_OK) {
+		DEBUG_ERROR("%s failed at 0x%08" PRIx32 "+%zx\n", __func__, addr, length);
+		return false;
+	}
+	return true;
+}
+
+bool remote_v5_flash_write(const target_addr_t dest, const void *const src, const size_t length)
+{
+	const uint8_t *const data = (const uint8_t *)src;
+	uint8_t frame[REMOTE_BINARY_HEADER_LENGTH + REMOTE_BINARY_MAX_PAYLOAD];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	const size_t blocksize = remote_v5_frame_payload_size - REMOTE_BINARY_FLASH_WRITE_LENGTH;
+	/* For each transfer block size, hand the probe that block of data to program */
+	for (size_t offset = 0; offset < length; offset += blocksize) {
+		const size_t amount = MIN(length - offset, blocksize);
+		request[0U] = REMOTE_FLASH_PACKET;
+		request[1U] = REMOTE_FLASH_WRITE;
+		write_le4(request, 2U, dest + offset);
+		write_le4(request, 6U, amount);
+		memcpy(request + REMOTE_BINARY_FLASH_WRITE_LENGTH, data + offset, amount);
+
+		/* The probe may have to program a whole sector before it can answer, so allow for that */
+		const unsigned saved_timeout = cortexm_wait_timeout;
+		cortexm_wait_timeout = REMOTE_FLASH_TIMEOUT_MS;
+		const int result = remote_v5_frame_exchange(
+			frame, REMOTE_BINARY_FLASH_WRITE_LENGTH + amount, frame, 1U + remote_v5_frame_payload_size);
+		cortexm_wait_timeout = saved_timeout;
+		if (result < 1 || frame[0] != REMOTE_RESP_OK) {
+			DEBUG_ERROR("%s failed at 0x%08" PRIx32 "\n", __func__, (uint32_t)(dest + offset));
+			return false;
+		}
+	}
+	return true;
+}
+
+bool remote_v5_flash_complete(void)
+{
+	platform_buffer_write(REMOTE_FLASH_COMPLETE_STR, sizeof(REMOTE_FLASH_COMPLETE_STR));
+
+	char buffer[REMOTE_MAX_MSG_SIZE];
+	const int length = remote_v5_flash_read(buffer, REMOTE_MAX_MSG_SIZE);
+	if (length < 1 || buffer[0] != REMOTE_RESP_OK) {
+		DEBUG_ERROR("%s failed\n", __func__);
+		return false;
+	}
+	return true;
+}
+
+void remote_v5_flash_release(void)
+{
+	platform_buffer_write(REMOTE_FLASH_RELEASE_STR, sizeof(REMOTE_FLASH_RELEASE_STR));
+
+	char buffer[REMOTE_MAX_MSG_SIZE];
+	const int length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+	if (length < 1 || buffer[0] != REMOTE_RESP_OK)
+		DEBUG_ERROR("%s failed\n", __func__);
+}
@@ -0,0 +1,87 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2024 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "bmp_remote.h"
+#include "buffer_utils.h"
+#include "protocol_v5.h"
+#include "protocol_v5_defs.h"
+#include "protocol_v5_jtag.h"
+
+void remote_v5_jtag_tdi_tdo_seq(
+	uint8_t *const data_out, const bool final_tms, const uint8_t *const data_in, const size_t clock_cycles)
+{
+	if (!clock_cycles || (!data_in && !data_out))
+		return;
+
+	uint8_t frame[REMOTE_BINARY_HEADER_LENGTH + REMOTE_BINARY_MAX_PAYLOAD];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	/*
+	 * The probe collects the TDO data just after the TDI data in its buffer, so when we want TDO back
+	 * each chunk can only use half of the frame. Chunks are always a whole number of bytes long.
+	 */
+	const size_t payload = remote_v5_frame_payload_size - REMOTE_BINARY_JTAG_TDITDO_LENGTH;
+	const size_t chunk_bytes = data_out ? payload >> 1U : payload;
+	size_t offset = 0;
+	/* Loop through the data to send/receive and handle it in chunks */
+	for (size_t cycle = 0; cycle < clock_cycles; cycle += chunk_bytes * 8U) {
+		/* Calculate how many bits need to be in this chunk */
+		const size_t chunk_length = MIN(clock_cycles - cycle, chunk_bytes * 8U);
+		const size_t bytes = (chunk_length + 7U) >> 3U;
+		/* If the result would complete the transaction, check if TMS needs to be high at the end */
+		request[0U] = REMOTE_JTAG_PACKET;
+		request[1U] = cycle + chunk_length == clock_cycles && final_tms ? REMOTE_TDITDO_TMS : REMOTE_TDITDO_NOTMS;
+		write_le4(request, 2U, chunk_length);
+		request[6U] = data_out ? 1U : 0U;
+		/* Copy in the data to send, or clock out 0's if there is none */
+		if (data_in)
+			memcpy(request + REMOTE_BINARY_JTAG_TDITDO_LENGTH, data_in + offset, bytes);
+		else
+			memset(request + REMOTE_BINARY_JTAG_TDITDO_LENGTH, 0, bytes);
+
+		/* Send the chunk, receive the response and check if it's an error response */
+		const int length = remote_v5_frame_exchange(
+			frame, REMOTE_BINARY_JTAG_TDITDO_LENGTH + bytes, frame, 1U + remote_v5_frame_payload_size);
+		if (length < 1 || frame[0] != REMOTE_RESP_OK || (data_out && (size_t)length != bytes + 1U)) {
+			DEBUG_ERROR("%s failed, error %c\n", __func__, length < 1 ? '?' : frame[0]);
+			exit(-1);
+		}
+		if (data_out)
+			memcpy(data_out + offset, frame + 1U, bytes);
+		offset += bytes;
+	}
+}
+
+void remote_v5_jtag_tdi_seq(const bool final_tms, const uint8_t *const data_in, const size_t clock_cycles)
+{
+	remote_v5_jtag_tdi_tdo_seq(NULL, final_tms, data_in, clock_cycles);
+}
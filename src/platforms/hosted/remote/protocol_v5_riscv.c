@@ -0,0 +1,120 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2024 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bmp_remote.h"
+#include "buffer_utils.h"
+#include "protocol_v5.h"
+#include "protocol_v5_defs.h"
+#include "protocol_v5_riscv.h"
+#include "exception.h"
+
+static bool remote_v5_riscv_check_error(
+	const char *const func, riscv_dmi_s *const dmi, const uint8_t *const response, const int length)
+{
+	/* Check the response length for error codes */
+	if (length < 1) {
+		DEBUG_ERROR("%s comms error: %d\n", func, length);
+		return false;
+	}
+	/* Now check if the remote is returning an error */
+	if (response[0U] == REMOTE_RESP_ERR) {
+		const uint64_t response_code = remote_v5_frame_error(response, length);
+		const uint8_t error = response_code & 0xffU;
+		/* If the error part of the response code indicates a fault, store the fault value */
+		if (error == REMOTE_ERROR_FAULT)
+			dmi->fault = response_code >> 8U;
+		/* If the error part indicates an exception had occurred, make that happen here too */
+		else if (error == REMOTE_ERROR_EXCEPTION)
+			raise_exception(response_code >> 8U, "Remote protocol exception");
+		/* Otherwise it's an unexpected error */
+		else
+			DEBUG_ERROR("%s: Unexpected error %u\n", func, error);
+	} /* Check if the remote is reporting a parameter error*/
+	else if (response[0U] == REMOTE_RESP_PARERR)
+		DEBUG_ERROR("%s: !BUG! Firmware reported a parameter error\n", func);
+	/* Check if the firmware is reporting some other kind of error */
+	else if (response[0U] != REMOTE_RESP_OK)
+		DEBUG_ERROR("%s: Firmware reported unexpected error: %c\n", func, response[0]);
+	/* Return whether the remote indicated the request was successful */
+	return response[0U] == REMOTE_RESP_OK;
+}
+
+static bool remote_v5_riscv_posted_check(void *const context, const void *const response, const int length)
+{
+	return remote_v5_riscv_check_error(__func__, (riscv_dmi_s *)context, (const uint8_t *)response, length);
+}
+
+bool remote_v5_riscv_jtag_dmi_read(riscv_dmi_s *const dmi, const uint32_t address, uint32_t *const value)
+{
+	/* Collect the responses to any posted writes first, if any of those failed then so does this read */
+	if (!remote_posted_flush())
+		return false;
+	/* Build the read request and send it to the probe */
+	uint8_t frame[REMOTE_BINARY_HEADER_LENGTH + REMOTE_BINARY_RISCV_DMI_WRITE_LENGTH];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	request[0U] = REMOTE_RISCV_PACKET;
+	request[1U] = REMOTE_RISCV_DMI_READ;
+	request[2U] = dmi->dev_index;
+	request[3U] = dmi->idle_cycles;
+	request[4U] = dmi->address_width;
+	write_le4(request, 5U, address);
+
+	/* Read back the answer and check for errors */
+	const int length = remote_v5_frame_exchange(frame, REMOTE_BINARY_RISCV_DMI_READ_LENGTH, frame, sizeof(frame));
+	if (!remote_v5_riscv_check_error(__func__, dmi, frame, length) || length != 5)
+		return false;
+
+	/* Log the probe-level request and its response having decoded it from the buffer */
+	*value = read_le4(frame, 1U);
+	DEBUG_PROBE("%s: %08" PRIx32 " -> %08" PRIx32 "\n", __func__, address, *value);
+	return true;
+}
+
+bool remote_v5_riscv_jtag_dmi_write(riscv_dmi_s *const dmi, const uint32_t address, const uint32_t value)
+{
+	/* Build the write request and send it to the probe */
+	uint8_t frame[REMOTE_BINARY_HEADER_LENGTH + REMOTE_BINARY_RISCV_DMI_WRITE_LENGTH];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	request[0U] = REMOTE_RISCV_PACKET;
+	request[1U] = REMOTE_RISCV_DMI_WRITE;
+	request[2U] = dmi->dev_index;
+	request[3U] = dmi->idle_cycles;
+	request[4U] = dmi->address_width;
+	write_le4(request, 5U, address);
+	write_le4(request, 9U, value);
+
+	/* Post the request, its response is checked the next time the posted requests are flushed */
+	remote_v5_frame_post(frame, REMOTE_BINARY_RISCV_DMI_WRITE_LENGTH, remote_v5_riscv_posted_check, dmi);
+	/* Log the probe-level request now it's been sent */
+	DEBUG_PROBE("%s: %08" PRIx32 " <- %08" PRIx32 "\n", __func__, address, value);
+	return true;
+}
@@ -27,6 +27,8 @@
 #include <windows.h>
 #include "platform.h"
 #include "remote.h"
+#include "bmp_remote.h"
+#include "buffer_utils.h"
 #include "cli.h"
 #include "utils.h"
 
@@ -354,9 +356,16 @@ void serial_close(void)
 }
 
 bool platform_buffer_write(const void *const data, const size_t length)
+{
+	/* Collect the responses to any posted requests first so this request's response is the next one read */
+	remote_posted_flush();
+	return platform_buffer_post(data, length);
+}
+
+bool platform_buffer_post(const void *const data, const size_t length)
 {
 	const char *const buffer = (const char *)data;
-	DEBUG_WIRE("%s\n", buffer);
+	DEBUG_WIRE("%.*s\n", (int)length, buffer);
 	DWORD written = 0;
 	for (size_t offset = 0; offset < length; offset += written) {
 		if (port_handle != INVALID_HANDLE_VALUE) {
@@ -440,21 +449,82 @@ static ssize_t bmda_read_more_data(const uint32_t end_time)
 	return 0;
 }
 
-/* XXX: We should either return size_t or bool */
-int platform_buffer_read(void *const data, const size_t length)
+/* Copy the next count bytes of a binary frame out of the read buffer, or discard them if destination is NULL */
+static int bmda_read_frame_bytes(uint8_t *const destination, const size_t count, const uint32_t end_time)
 {
-	char *const buffer = (char *)data;
-	const uint32_t start_time = platform_time_ms();
-	const uint32_t end_time = start_time + cortexm_wait_timeout;
-	/* Drain the buffer for the remote till we see a start-of-response byte */
-	for (char response = 0; response != REMOTE_RESP;) {
-		while (read_buffer_offset == read_buffer_fullness) {
+	for (size_t offset = 0U; offset < count;) {
+		/* Check if we need more data or should use what's in the buffer already */
+		if (read_buffer_offset == read_buffer_fullness) {
 			const ssize_t result = bmda_read_more_data(end_time);
 			if (result < 0)
 				return result;
 		}
-		response = read_buffer[read_buffer_offset++];
+		const size_t amount = MIN(read_buffer_fullness - read_buffer_offset, count - offset);
+		if (destination)
+			memcpy(destination + offset, read_buffer + read_buffer_offset, amount);
+		read_buffer_offset += amount;
+		offset += amount;
+	}
+	return 0;
+}
+
+/*
+ * Having just seen a start-of-response byte, check if what follows is a memory watch notification and if so
+ * consume it and pass it on. Returns 1 if a notification was consumed, 0 if not, or a negative value on error.
+ */
+static int bmda_read_notification(const uint32_t end_time)
+{
+	while (read_buffer_offset == read_buffer_fullness) {
+		const ssize_t result = bmda_read_more_data(end_time);
+		if (result < 0)
+			return result;
+	}
+	if (read_buffer[read_buffer_offset] != REMOTE_RESP_WATCH)
+		return 0;
+	/* Grab the notification's code and length, then its payload, discarding anything beyond the value */
+	uint8_t header[3U];
+	int result = bmda_read_frame_bytes(header, sizeof(header), end_time);
+	if (result < 0)
+		return result;
+	const size_t payload_length = read_le2(header, 1U);
+	uint8_t value[4U] = {0U};
+	result = bmda_read_frame_bytes(value, MIN(payload_length, sizeof(value)), end_time);
+	if (result >= 0 && payload_length > sizeof(value))
+		result = bmda_read_frame_bytes(NULL, payload_length - sizeof(value), end_time);
+	if (result < 0)
+		return result;
+	remote_mem_watch_notify(read_le4(value, 0U));
+	return 1;
+}
+
+/* Drain the buffer for the remote till we see a start-of-response byte that isn't a memory watch notification */
+static int bmda_read_response_start(const uint32_t end_time)
+{
+	while (true) {
+		for (char response = 0; response != REMOTE_RESP;) {
+			while (read_buffer_offset == read_buffer_fullness) {
+				const ssize_t result = bmda_read_more_data(end_time);
+				if (result < 0)
+					return result;
+			}
+			response = read_buffer[read_buffer_offset++];
+		}
+		const int result = bmda_read_notification(end_time);
+		if (result <= 0)
+			return result;
 	}
+}
+
+/* XXX: We should either return size_t or bool */
+int platform_buffer_read(void *const data, const size_t length)
+{
+	char *const buffer = (char *)data;
+	const uint32_t start_time = platform_time_ms();
+	const uint32_t end_time = start_time + cortexm_wait_timeout;
+	/* Drain the buffer for the remote till we see the start of the response */
+	const int start = bmda_read_response_start(end_time);
+	if (start < 0)
+		return start;
 	/* Now collect the response */
 	for (size_t offset = 0; offset < length;) {
 		/* Check if we've exceeded the allowed time */
@@ -492,3 +562,76 @@ int platform_buffer_read(void *const data, const size_t length)
 	}
 	return length;
 }
+
+/*
+ * Read a binary framed (v5 protocol) response from the probe. The response code is
+ * stored in the first byte of the buffer and the payload follows it. Returns the
+ * number of bytes stored (1 + payload length), or a negative value on error.
+ */
+int platform_buffer_read_frame(void *const data, const size_t length)
+{
+	uint8_t *const buffer = (uint8_t *)data;
+	const uint32_t end_time = platform_time_ms() + cortexm_wait_timeout;
+	/* Drain the buffer for the remote till we see the start of the response */
+	const int start = bmda_read_response_start(end_time);
+	if (start < 0)
+		return start;
+	/* Collect the response code and 16-bit payload length */
+	uint8_t header[3U];
+	const int result = bmda_read_frame_bytes(header, sizeof(header), end_time);
+	if (result < 0)
+		return result;
+	const size_t payload_length = read_le2(header, 1U);
+	/* If the payload won't fit, discard it so the link stays in sync and bail */
+	if (payload_length + 1U > length) {
+		DEBUG_ERROR("Binary frame too large (%zu > %zu)\n", payload_length + 1U, length);
+		const int discard = bmda_read_frame_bytes(NULL, payload_length, end_time);
+		return discard < 0 ? discard : -5;
+	}
+	buffer[0] = header[0];
+	const int status = bmda_read_frame_bytes(buffer + 1U, payload_length, end_time);
+	if (status < 0)
+		return status;
+	DEBUG_WIRE("       %c + %zu bytes\n", buffer[0], payload_length);
+	return (int)(payload_length + 1U);
+}
+
+void platform_buffer_poll(const uint32_t timeout)
+{
+	/* Collect the responses to any posted requests first so they can't be mistaken for anything else */
+	remote_posted_flush();
+	if (read_buffer_offset == read_buffer_fullness) {
+		if (network_socket != INVALID_SOCKET) {
+			struct timeval wait_timeout = {
+				.tv_sec = timeout / 1000U,
+				.tv_usec = 1000U * (timeout % 1000U),
+			};
+			fd_set select_set;
+			FD_ZERO(&select_set);
+			FD_SET(network_socket, &select_set);
+			/* If nothing turns up in time, we're done */
+			if (select(FD_SETSIZE, &select_set, NULL, NULL, &wait_timeout) <= 0)
+				return;
+			const ssize_t bytes_received = recv(network_socket, (char *)read_buffer, READ_BUFFER_LENGTH, 0);
+			if (bytes_received <= 0)
+				return;
+			read_buffer_fullness = (size_t)bytes_received;
+		} else {
+			if (WaitForSingleObject(port_handle, timeout) != WAIT_OBJECT_0)
+				return;
+			DWORD bytes_received = 0;
+			if (!ReadFile(port_handle, read_buffer, READ_BUFFER_LENGTH, &bytes_received, NULL) || !bytes_received)
+				return;
+			read_buffer_fullness = bytes_received;
+		}
+		read_buffer_offset = 0U;
+	}
+	/* With no request outstanding, the only thing the probe should be sending is notifications */
+	const uint32_t end_time = platform_time_ms() + cortexm_wait_timeout;
+	while (read_buffer_offset != read_buffer_fullness) {
+		if (read_buffer[read_buffer_offset++] != REMOTE_RESP)
+			continue;
+		if (bmda_read_notification(end_time) <= 0)
+			break;
+	}
+}
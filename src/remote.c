@@ -33,6 +33,7 @@
 #include "spi.h"
 #include "sfdp.h"
 #include "target.h"
+#include "target_internal.h"
 #include "adiv5.h"
 #include "adiv6.h"
 #if defined(CONFIG_RISCV_ACCEL) && CONFIG_RISCV_ACCEL == 1
@@ -41,6 +42,8 @@
 #include "version.h"
 #include "exception.h"
 #include "hex_utils.h"
+#include "buffer_utils.h"
+#include "crc32.h"
 
 #if CONFIG_BMDA == 0
 static void remote_packet_process_adiv6(const char *packet, size_t packet_len);
@@ -112,6 +115,26 @@ static void remote_respond_string(const char response_code, const char *const st
 	gdb_if_putchar(REMOTE_EOM, true);
 }
 
+/* Send a binary frame response with some data following */
+static void remote_respond_frame(const char response_code, const void *const buffer, const size_t length)
+{
+	const uint8_t *const data = (const uint8_t *)buffer;
+	gdb_if_putchar(REMOTE_RESP, false);
+	gdb_if_putchar(response_code, false);
+	gdb_if_putchar((char)(length & 0xffU), false);
+	gdb_if_putchar((char)((length >> 8U) & 0xffU), length == 0U);
+	for (size_t offset = 0; offset < length; ++offset)
+		gdb_if_putchar((char)data[offset], offset + 1U == length);
+}
+
+/* Send a binary frame response with a simple result code parameter */
+static void remote_respond_frame_code(const char response_code, const uint64_t param)
+{
+	uint8_t value[8U];
+	write_le8(value, 0U, param);
+	remote_respond_frame(response_code, value, sizeof(value));
+}
+
 /*
  * This faked ADIv5 DP structure holds the currently used low-level implementation functions (SWD vs JTAG)
  * and basic DP state for remote protocol requests made. This is shared between remote_packet_process_swd()
@@ -128,6 +151,18 @@ static adiv5_debug_port_s remote_dp = {
 	.mem_write = adiv5_mem_write_bytes,
 };
 
+/*
+ * Memory watch armed by the host with an AW request. While armed, the word at the watch address is read
+ * every REMOTE_MEM_WATCH_INTERVAL while we wait for the next request, so the host doesn't have to poll.
+ */
+static bool remote_mem_watch_active = false;
+static uint8_t remote_mem_watch_dev_index = 0U;
+static adiv5_access_port_s remote_mem_watch_ap;
+static target_addr64_t remote_mem_watch_address = 0U;
+static uint32_t remote_mem_watch_mask = 0U;
+static uint32_t remote_mem_watch_match = 0U;
+static uint32_t remote_mem_watch_value = 0U;
+
 static void remote_packet_process_swd(const char *const packet, const size_t packet_len)
 {
 	switch (packet[1]) {
@@ -138,6 +173,7 @@ static void remote_packet_process_swd(const char *const packet, const size_t pac
 			remote_dp.dp_read = adiv5_swd_read;
 			remote_dp.error = adiv5_swd_clear_error;
 			remote_dp.low_access = adiv5_swd_raw_access;
+			remote_dp.ap_read_block = adiv5_swd_ap_read_block;
 			remote_dp.abort = adiv5_swd_abort;
 			swdptap_init();
 			remote_respond(REMOTE_RESP_OK, 0);
@@ -191,6 +227,7 @@ static void remote_packet_process_jtag(const char *const packet, const size_t pa
 		remote_dp.dp_read = adiv5_jtag_read;
 		remote_dp.error = adiv5_jtag_clear_error;
 		remote_dp.low_access = adiv5_jtag_raw_access;
+		remote_dp.ap_read_block = NULL;
 		remote_dp.abort = adiv5_jtag_abort;
 		jtagtap_init();
 		remote_respond(REMOTE_RESP_OK, 0);
@@ -302,6 +339,8 @@ static void remote_packet_process_general(char *packet, const size_t packet_len)
 #endif
 		break;
 	case REMOTE_START:
+		/* A new session shouldn't inherit a watch left armed by the last one */
+		remote_mem_watch_active = false;
 #if ENABLE_DEBUG == 1 && defined(PLATFORM_HAS_DEBUG)
 		debug_bmp = true;
 #endif
@@ -330,6 +369,10 @@ static void remote_packet_process_high_level(const char *packet, const size_t pa
 		remote_respond(REMOTE_RESP_OK, REMOTE_HL_VERSION);
 		break;
 
+	case REMOTE_HL_FRAME_SIZE: /* HF = request the largest binary frame payload we can handle */
+		remote_respond(REMOTE_RESP_OK, GDB_PACKET_BUFFER_SIZE);
+		break;
+
 	case REMOTE_HL_ADD_JTAG_DEV: { /* HJ = fill firmware jtag_devs */
 		/* Check the packet is an appropriate length */
 		if (packet_len < 22U) {
@@ -353,7 +396,8 @@ static void remote_packet_process_high_level(const char *packet, const size_t pa
 	case REMOTE_HL_ACCEL: { /* HA = request what accelerations are available */
 		/* Build a response value that depends on what things are built into the firmare */
 		remote_respond(REMOTE_RESP_OK,
-			REMOTE_ACCEL_ADIV5 | REMOTE_ACCEL_ADIV6
+			REMOTE_ACCEL_ADIV5 | REMOTE_ACCEL_ADIV6 | REMOTE_ACCEL_FLASH | REMOTE_ACCEL_MEM_WATCH |
+				REMOTE_ACCEL_MEM_CRC32 | REMOTE_ACCEL_BATCH
 #if defined(CONFIG_RISCV_ACCEL) && CONFIG_RISCV_ACCEL == 1
 				| REMOTE_ACCEL_RISCV
 #endif
@@ -430,7 +474,7 @@ static void remote_packet_process_adiv5(const char *const packet, const size_t p
 	/* Set up the DP and a fake AP structure to perform the access with */
 	remote_dp.dev_index = hex_string_to_num(2, packet + 2);
 	remote_dp.fault = 0U;
-	adiv5_access_port_s remote_ap;
+	adiv5_access_port_s remote_ap = {0};
 	remote_ap.apsel = hex_string_to_num(2, packet + 4);
 	remote_ap.dp = &remote_dp;
 
@@ -549,7 +593,7 @@ static void remote_packet_process_adiv6(const char *const packet, const size_t p
 	/* Set up the DP and a fake AP structure to perform the access with */
 	remote_dp.dev_index = hex_string_to_num(2, packet + 3);
 	remote_dp.fault = 0U;
-	adiv6_access_port_s remote_ap;
+	adiv6_access_port_s remote_ap = {0};
 	remote_ap.ap_address = hex_string_to_num(16, packet + 5);
 	remote_ap.base.dp = &dp;
 
@@ -843,6 +887,117 @@ void remote_packet_process_spi(const char *const packet, const size_t packet_len
 	}
 }
 
+/*
+ * This holds the probe's own copy of the target the host is programming when Flash
+ * programming has been offloaded to us. Target output is discarded as the host owns
+ * the GDB connection.
+ */
+static target_s *remote_flash_target = NULL;
+
+static void remote_flash_destroy_callback(target_controller_s *const controller, target_s *const target)
+{
+	(void)controller;
+	(void)target;
+}
+
+static void remote_flash_printf(target_controller_s *const controller, const char *const fmt, va_list args)
+{
+	(void)controller;
+	(void)fmt;
+	(void)args;
+}
+
+static target_controller_s remote_flash_controller = {
+	.destroy_callback = remote_flash_destroy_callback,
+	.printf = remote_flash_printf,
+};
+
+static void remote_flash_release(void)
+{
+	if (!remote_flash_target)
+		return;
+	/*
+	 * The host still owns the target, so mark our copies as detached to stop
+	 * target_list_free() resuming the target out from under it
+	 */
+	for (target_s *target = target_list; target; target = target->next)
+		target->attached = false;
+	target_list_free();
+	remote_flash_target = NULL;
+}
+
+static void remote_flash_attach(const char scan_type, const uint32_t targetid, const size_t index)
+{
+	/* Drop any copy of a target we already had, then scan for and attach to the one requested */
+	remote_flash_release();
+	bool scan_result = false;
+	if (scan_type == REMOTE_FLASH_SCAN_SWD)
+		scan_result = adiv5_swd_scan(targetid);
+	else if (scan_type == REMOTE_FLASH_SCAN_JTAG)
+		scan_result = jtag_scan();
+	if (scan_result)
+		remote_flash_target = target_attach_n(index, &remote_flash_controller);
+	if (!remote_flash_target) {
+		remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_FAULT);
+		return;
+	}
+	/* Tell the host which driver and part we found so it can check this is the same target it has */
+	char response[64U];
+	snprintf(response, sizeof(response), "%04x%s", remote_flash_target->part_id, remote_flash_target->driver);
+	remote_respond_string(REMOTE_RESP_OK, response);
+}
+
+static void remote_packet_process_flash(const char *const packet, const size_t packet_len)
+{
+	switch (packet[1U]) {
+	case REMOTE_FLASH_ATTACH: /* FA = scan for and attach to a target to program */
+		if (packet_len != 13U) {
+			remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_WRONGLEN);
+			break;
+		}
+		remote_flash_attach(packet[2U], hex_string_to_num(8U, packet + 3U), hex_string_to_num(2U, packet + 11U));
+		break;
+
+	case REMOTE_FLASH_ERASE: { /* FE = erase a region of Flash */
+		if (packet_len != 18U) {
+			remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_WRONGLEN);
+			break;
+		}
+		if (!remote_flash_target) {
+			remote_respond(REMOTE_RESP_PARERR, 0U);
+			break;
+		}
+		const target_addr_t address = hex_string_to_num(8U, packet + 2U);
+		const size_t length = hex_string_to_num(8U, packet + 10U);
+		if (target_flash_erase(remote_flash_target, address, length))
+			remote_respond(REMOTE_RESP_OK, 0U);
+		else
+			remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_FAULT);
+		break;
+	}
+
+	case REMOTE_FLASH_COMPLETE: /* FC = finish off any Flash writes in progress */
+		if (!remote_flash_target) {
+			remote_respond(REMOTE_RESP_PARERR, 0U);
+			break;
+		}
+		if (target_flash_complete(remote_flash_target))
+			remote_respond(REMOTE_RESP_OK, 0U);
+		else
+			remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_FAULT);
+		break;
+
+	case REMOTE_FLASH_RELEASE: /* FD = release our copy of the target */
+		remote_flash_release();
+		remote_respond(REMOTE_RESP_OK, 0U);
+		break;
+
+	default:
+		remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_UNRECOGNISED);
+		break;
+	}
+}
+
 void remote_packet_process(char *const packet, const size_t packet_length)
 {
 	/* Check there's at least a request byte */
@@ -890,9 +1045,421 @@ void remote_packet_process(char *const packet, const size_t packet_length)
 		remote_packet_process_spi(packet, packet_length);
 		break;
 
+	case REMOTE_FLASH_PACKET: {
+		/* Check there's a command byte, then set up an exception frame to run the Flash operation in */
+		if (packet_length < 2U) {
+			remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_WRONGLEN);
+			break;
+		}
+		TRY (EXCEPTION_ALL) {
+			remote_packet_process_flash(packet, packet_length);
+		}
+		CATCH () {
+		default:
+			remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_EXCEPTION | ((uint64_t)exception_frame.type << 8U));
+		}
+		break;
+	}
+
 	default: /* Oh dear, unrecognised, return an error */
 		remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_UNRECOGNISED);
 		break;
 	}
 }
+
+static void remote_adiv5_respond_frame(const uint8_t fault, const void *const data, const size_t length)
+{
+	if (fault)
+		/* If the request didn't work and caused a fault, tell the host */
+		remote_respond_frame_code(REMOTE_RESP_ERR, REMOTE_ERROR_FAULT | ((uint16_t)fault << 8U));
+	else
+		/* Otherwise reply back with the data */
+		remote_respond_frame(REMOTE_RESP_OK, data, length);
+}
+
+static void remote_binary_process_adiv6(uint8_t *const packet, const size_t packet_len)
+{
+	/* Our shortest binary ADIv6 frame is a memory read, check that we have at least that */
+	if (packet_len < REMOTE_BINARY_ADIV6_MEM_READ_LENGTH) {
+		remote_respond_frame_code(REMOTE_RESP_ERR, REMOTE_ERROR_WRONGLEN);
+		return;
+	}
+
+	/* Set up the DP and a fake AP structure to perform the access with, as remote_packet_process_adiv6() does */
+	adiv5_debug_port_s dp = remote_dp;
+	dp.ap_read = adiv6_ap_reg_read;
+	dp.ap_write = adiv6_ap_reg_write;
+	dp.dev_index = packet[3U];
+	dp.fault = 0U;
+	adiv6_access_port_s remote_ap = {0};
+	remote_ap.ap_address = read_le8(packet, 4U);
+	remote_ap.base.dp = &dp;
+	remote_ap.base.csw = read_le4(packet, 12U);
+
+	switch (packet[2U]) {
+	case REMOTE_MEM_READ: { /* A6m = Read from memory */
+		const target_addr64_t address = read_le8(packet, 16U);
+		const uint32_t length = read_le4(packet, 24U);
+		/* Validate the read will fit in the packet buffer */
+		if (packet_len != REMOTE_BINARY_ADIV6_MEM_READ_LENGTH || length > GDB_PACKET_BUFFER_SIZE) {
+			remote_respond_frame_code(REMOTE_RESP_PARERR, 0U);
+			break;
+		}
+		/* Get the aligned packet buffer to reuse for the data read, then perform the read and send the results */
+		void *data = gdb_packet_buffer();
+		adiv5_mem_read(&remote_ap.base, data, address, length);
+		remote_adiv5_respond_frame(dp.fault, data, length);
+		break;
+	}
+	case REMOTE_MEM_WRITE: { /* A6M = Write to memory */
+		const align_e align = packet[16U];
+		const target_addr64_t address = read_le8(packet, 17U);
+		const uint32_t length = read_le4(packet, 25U);
+		/* Validate the frame holds all the data and that the alignment is suitable */
+		if (packet_len != REMOTE_BINARY_ADIV6_MEM_WRITE_LENGTH + length || align > ALIGN_64BIT ||
+			(length & ((1U << align) - 1U))) {
+			remote_respond_frame_code(REMOTE_RESP_PARERR, 0U);
+			break;
+		}
+		/* Move the data down to the start of the aligned packet buffer, then perform the write */
+		void *data = gdb_packet_buffer();
+		memmove(data, packet + REMOTE_BINARY_ADIV6_MEM_WRITE_LENGTH, length);
+		adiv5_mem_write_aligned(&remote_ap.base, address, data, length, align);
+		remote_adiv5_respond_frame(dp.fault, NULL, 0U);
+		break;
+	}
+	default:
+		remote_respond_frame_code(REMOTE_RESP_ERR, REMOTE_ERROR_UNRECOGNISED);
+		break;
+	}
+}
+
+/* Read target memory through a remote AP for bmd_crc32_read() */
+static bool remote_crc32_read(void *const context, void *const dest, const uint32_t src, const size_t len)
+{
+	adiv5_access_port_s *const ap = (adiv5_access_port_s *)context;
+	adiv5_mem_read(ap, dest, src, len);
+	return !ap->dp->fault;
+}
+
+static void remote_binary_process_adiv5_batch(const uint8_t *const packet, const size_t packet_len)
+{
+	const size_t count = packet_len >= REMOTE_BINARY_ADIV5_BATCH_LENGTH ? packet[3U] : 0U;
+	/* Validate the frame holds all the entries it claims to and that they'll all fit in a response */
+	if (packet_len != REMOTE_BINARY_ADIV5_BATCH_LENGTH + (count * REMOTE_BINARY_ADIV5_BATCH_OP_LENGTH) ||
+		count > REMOTE_BINARY_ADIV5_BATCH_MAX_OPS) {
+		remote_respond_frame_code(REMOTE_RESP_PARERR, 0U);
+		return;
+	}
+
+	remote_dp.dev_index = packet[2U];
+	remote_dp.fault = 0U;
+	adiv5_access_port_s remote_ap = {0};
+	remote_ap.dp = &remote_dp;
+	uint8_t results[REMOTE_BINARY_ADIV5_BATCH_MAX_OPS * 4U];
+	size_t results_length = 0U;
+	/* Run through each of the entries in turn, stopping at the first one that faults */
+	for (size_t idx = 0U; idx < count && !remote_dp.fault; ++idx) {
+		const uint8_t *const entry =
+			packet + REMOTE_BINARY_ADIV5_BATCH_LENGTH + (idx * REMOTE_BINARY_ADIV5_BATCH_OP_LENGTH);
+		const uint8_t flags = entry[0U];
+		const uint16_t addr = read_le2(entry, 2U);
+		const uint32_t value = read_le4(entry, 4U);
+		remote_ap.apsel = entry[1U];
+		if (flags & REMOTE_ADIV5_BATCH_READ) {
+			const uint32_t result =
+				flags & REMOTE_ADIV5_BATCH_AP ? adiv5_ap_read(&remote_ap, addr) : adiv5_dp_read(&remote_dp, addr);
+			write_le4(results, results_length, result);
+			results_length += 4U;
+		} else if (flags & REMOTE_ADIV5_BATCH_AP)
+			adiv5_ap_write(&remote_ap, addr, value);
+		else
+			adiv5_dp_write(&remote_dp, addr, value);
+	}
+	remote_adiv5_respond_frame(remote_dp.fault, results, results_length);
+}
+
+static void remote_binary_process_adiv5(uint8_t *const packet, const size_t packet_len)
+{
+	/* Check if this is actually an ADIv6 acceleration frame and dispatch */
+	if (packet_len >= 3U && packet[1U] == REMOTE_ADIV6_PACKET) {
+		remote_binary_process_adiv6(packet, packet_len);
+		return;
+	}
+	/* Disarming a memory watch takes no parameters, so deal with it up front */
+	if (packet[1U] == REMOTE_MEM_UNWATCH) {
+		remote_mem_watch_active = false;
+		remote_respond_frame(REMOTE_RESP_OK, NULL, 0U);
+		return;
+	}
+	/* Access batches are variable length, so deal with them up front too */
+	if (packet[1U] == REMOTE_ADIV5_BATCH) {
+		remote_binary_process_adiv5_batch(packet, packet_len);
+		return;
+	}
+	/* Our shortest binary ADIv5 frame is a memory read, check that we have at least that */
+	if (packet_len < REMOTE_BINARY_ADIV5_MEM_READ_LENGTH) {
+		remote_respond_frame_code(REMOTE_RESP_ERR, REMOTE_ERROR_WRONGLEN);
+		return;
+	}
+
+	/* Set up the DP and a fake AP structure to perform the access with */
+	remote_dp.dev_index = packet[2U];
+	remote_dp.fault = 0U;
+	adiv5_access_port_s remote_ap = {0};
+	remote_ap.apsel = packet[3U];
+	remote_ap.dp = &remote_dp;
+	remote_ap.csw = read_le4(packet, 4U);
+
+	switch (packet[1U]) {
+	case REMOTE_MEM_READ: { /* Am = Read from memory */
+		const target_addr64_t address = read_le8(packet, 8U);
+		const uint32_t length = read_le4(packet, 16U);
+		/* Validate the read will fit in the packet buffer */
+		if (packet_len != REMOTE_BINARY_ADIV5_MEM_READ_LENGTH || length > GDB_PACKET_BUFFER_SIZE) {
+			remote_respond_frame_code(REMOTE_RESP_PARERR, 0U);
+			break;
+		}
+		/* Get the aligned packet buffer to reuse for the data read, then perform the read and send the results */
+		void *data = gdb_packet_buffer();
+		adiv5_mem_read(&remote_ap, data, address, length);
+		remote_adiv5_respond_frame(remote_dp.fault, data, length);
+		break;
+	}
+	case REMOTE_MEM_WRITE: { /* AM = Write to memory */
+		const align_e align = packet[8U];
+		const target_addr64_t address = read_le8(packet, 9U);
+		const uint32_t length = read_le4(packet, 17U);
+		/* Validate the frame holds all the data and that the alignment is suitable */
+		if (packet_len != REMOTE_BINARY_ADIV5_MEM_WRITE_LENGTH + length || align > ALIGN_64BIT ||
+			(length & ((1U << align) - 1U))) {
+			remote_respond_frame_code(REMOTE_RESP_PARERR, 0U);
+			break;
+		}
+		/* Move the data down to the start of the aligned packet buffer, then perform the write */
+		void *data = gdb_packet_buffer();
+		memmove(data, packet + REMOTE_BINARY_ADIV5_MEM_WRITE_LENGTH, length);
+		adiv5_mem_write_aligned(&remote_ap, address, data, length, align);
+		remote_adiv5_respond_frame(remote_dp.fault, NULL, 0U);
+		break;
+	}
+	case REMOTE_MEM_CRC32: { /* Ac = Calculate the CRC32 of a memory region */
+		const target_addr64_t address = read_le8(packet, 8U);
+		const uint32_t length = read_le4(packet, 16U);
+		if (packet_len != REMOTE_BINARY_ADIV5_MEM_READ_LENGTH || address + length > UINT32_MAX + 1ULL) {
+			remote_respond_frame_code(REMOTE_RESP_PARERR, 0U);
+			break;
+		}
+		uint32_t crc = 0U;
+		const bool result = bmd_crc32_read(remote_crc32_read, &remote_ap, &crc, (uint32_t)address, length);
+		uint8_t data[4U];
+		write_le4(data, 0U, crc);
+		remote_adiv5_respond_frame(result ? 0U : MAX(remote_dp.fault, 1U), data, sizeof(data));
+		break;
+	}
+	case REMOTE_MEM_WATCH: { /* AW = Arm a memory watch */
+		if (packet_len != REMOTE_BINARY_ADIV5_MEM_WATCH_LENGTH) {
+			remote_respond_frame_code(REMOTE_RESP_PARERR, 0U);
+			break;
+		}
+		/* Copy the access setup out as the DP state gets reused by every other request that comes in */
+		remote_mem_watch_dev_index = remote_dp.dev_index;
+		remote_mem_watch_ap.apsel = remote_ap.apsel;
+		remote_mem_watch_ap.csw = remote_ap.csw;
+		remote_mem_watch_ap.dp = &remote_dp;
+		remote_mem_watch_address = read_le8(packet, 8U);
+		remote_mem_watch_mask = read_le4(packet, 16U);
+		remote_mem_watch_match = read_le4(packet, 20U);
+		remote_mem_watch_active = true;
+		remote_respond_frame(REMOTE_RESP_OK, NULL, 0U);
+		break;
+	}
+	default:
+		remote_respond_frame_code(REMOTE_RESP_ERR, REMOTE_ERROR_UNRECOGNISED);
+		break;
+	}
+}
+
+bool remote_mem_watch_armed(void)
+{
+	return remote_mem_watch_active;
+}
+
+void remote_mem_watch_poll(void)
+{
+	if (!remote_mem_watch_active)
+		return;
+
+	/* Point the DP back at the device the watch was armed against, other requests may have moved it */
+	remote_dp.dev_index = remote_mem_watch_dev_index;
+	remote_dp.fault = 0U;
+	TRY (EXCEPTION_ALL) {
+		adiv5_mem_read(&remote_mem_watch_ap, &remote_mem_watch_value, remote_mem_watch_address, 4U);
+	}
+	CATCH () {
+	case EXCEPTION_TIMEOUT:
+		/* The target is most likely in WFI and so still running, try again next time round */
+		return;
+	default:
+		break;
+	}
+	/* If the read went through and the word doesn't match yet, keep watching */
+	if (!exception_frame.type && !remote_dp.fault &&
+		(remote_mem_watch_value & remote_mem_watch_mask) != remote_mem_watch_match)
+		return;
+
+	/* Either the watch triggered or the access failed, both of which the host needs to take a look at */
+	remote_mem_watch_active = false;
+	uint8_t notification[4U];
+	write_le4(notification, 0U, remote_mem_watch_value);
+	remote_respond_frame(REMOTE_RESP_WATCH, notification, sizeof(notification));
+}
+
+static void remote_binary_process_jtag(uint8_t *const packet, const size_t packet_len)
+{
+	if (packet_len < REMOTE_BINARY_JTAG_TDITDO_LENGTH ||
+		(packet[1U] != REMOTE_TDITDO_TMS && packet[1U] != REMOTE_TDITDO_NOTMS)) {
+		remote_respond_frame_code(REMOTE_RESP_ERR, REMOTE_ERROR_UNRECOGNISED);
+		return;
+	}
+	const uint32_t clock_cycles = read_le4(packet, 2U);
+	const bool return_tdo = packet[6U] != 0U;
+	const size_t bytes = (clock_cycles + 7U) >> 3U;
+	/* The TDO data is collected just after the TDI data, so make sure both fit in the packet buffer */
+	if (!clock_cycles || packet_len != REMOTE_BINARY_JTAG_TDITDO_LENGTH + bytes ||
+		(return_tdo && packet_len + bytes > GDB_PACKET_BUFFER_SIZE)) {
+		remote_respond_frame_code(REMOTE_RESP_PARERR, 0U);
+		return;
+	}
+	const uint8_t *const data_in = packet + REMOTE_BINARY_JTAG_TDITDO_LENGTH;
+	uint8_t *const data_out = return_tdo ? packet + packet_len : NULL;
+	if (data_out)
+		jtag_proc.jtagtap_tdi_tdo_seq(data_out, packet[1U] == REMOTE_TDITDO_TMS, data_in, clock_cycles);
+	else
+		jtag_proc.jtagtap_tdi_seq(packet[1U] == REMOTE_TDITDO_TMS, data_in, clock_cycles);
+	remote_respond_frame(REMOTE_RESP_OK, data_out, data_out ? bytes : 0U);
+}
+
+#if defined(CONFIG_RISCV_ACCEL) && CONFIG_RISCV_ACCEL == 1
+static void remote_binary_process_riscv(uint8_t *const packet, const size_t packet_len)
+{
+	/* Our shortest binary RISC-V frame is a DMI read, check that we have at least that */
+	if (packet_len < REMOTE_BINARY_RISCV_DMI_READ_LENGTH || !remote_dmi.read) {
+		remote_respond_frame_code(REMOTE_RESP_PARERR, 0U);
+		return;
+	}
+
+	/* Set up the fake DMI structure to perform the access with */
+	remote_dmi.dev_index = packet[2U];
+	remote_dmi.idle_cycles = packet[3U];
+	remote_dmi.address_width = packet[4U];
+	remote_dmi.fault = 0U;
+	const uint32_t addr = read_le4(packet, 5U);
+
+	switch (packet[1U]) {
+	case REMOTE_RISCV_DMI_READ: {
+		uint32_t value = 0;
+		if (!remote_dmi.read(&remote_dmi, addr, &value))
+			/* If the request didn't work, and caused a fault, tell the host */
+			remote_respond_frame_code(REMOTE_RESP_ERR, REMOTE_ERROR_FAULT | ((uint16_t)remote_dmi.fault << 8U));
+		else {
+			/* Otherwise reply back with the read data */
+			uint8_t data[4U];
+			write_le4(data, 0U, value);
+			remote_respond_frame(REMOTE_RESP_OK, data, sizeof(data));
+		}
+		break;
+	}
+	case REMOTE_RISCV_DMI_WRITE: {
+		if (packet_len != REMOTE_BINARY_RISCV_DMI_WRITE_LENGTH) {
+			remote_respond_frame_code(REMOTE_RESP_PARERR, 0U);
+			break;
+		}
+		const uint32_t value = read_le4(packet, 9U);
+		if (!remote_dmi.write(&remote_dmi, addr, value))
+			/* If the request didn't work, and caused a fault, tell the host */
+			remote_respond_frame_code(REMOTE_RESP_ERR, REMOTE_ERROR_FAULT | ((uint16_t)remote_dmi.fault << 8U));
+		else
+			/* Otherwise inform the host the request succeeded */
+			remote_respond_frame(REMOTE_RESP_OK, NULL, 0U);
+		break;
+	}
+	default:
+		remote_respond_frame_code(REMOTE_RESP_ERR, REMOTE_ERROR_UNRECOGNISED);
+		break;
+	}
+}
+#endif
+
+static void remote_binary_process_flash(const uint8_t *const packet, const size_t packet_len)
+{
+	if (packet[1U] != REMOTE_FLASH_WRITE) {
+		remote_respond_frame_code(REMOTE_RESP_ERR, REMOTE_ERROR_UNRECOGNISED);
+		return;
+	}
+	/* Validate the frame holds all the data and that we have a target to program */
+	const uint32_t length = packet_len >= REMOTE_BINARY_FLASH_WRITE_LENGTH ? read_le4(packet, 6U) : 0U;
+	if (packet_len != REMOTE_BINARY_FLASH_WRITE_LENGTH + length || !remote_flash_target) {
+		remote_respond_frame_code(REMOTE_RESP_PARERR, 0U);
+		return;
+	}
+	const target_addr_t address = read_le4(packet, 2U);
+	if (target_flash_write(remote_flash_target, address, packet + REMOTE_BINARY_FLASH_WRITE_LENGTH, length))
+		remote_respond_frame(REMOTE_RESP_OK, NULL, 0U);
+	else
+		remote_respond_frame_code(REMOTE_RESP_ERR, REMOTE_ERROR_FAULT);
+}
+
+void remote_packet_process_binary(uint8_t *const packet, const size_t packet_length)
+{
+	/* Check there's at least a frame type and command byte */
+	if (packet_length < 2U) {
+		remote_respond_frame_code(REMOTE_RESP_ERR, REMOTE_ERROR_WRONGLEN);
+		return;
+	}
+	SET_IDLE_STATE(0);
+	switch (packet[0]) {
+	case REMOTE_JTAG_PACKET:
+		remote_binary_process_jtag(packet, packet_length);
+		break;
+
+	case REMOTE_ADIV5_PACKET: {
+		/* Setup an exception frame to try the ADIv5 operation in */
+		TRY (EXCEPTION_ALL) {
+			remote_binary_process_adiv5(packet, packet_length);
+		}
+		CATCH () {
+		/* Handle any exception we've caught by translating it into a remote protocol response */
+		default:
+			remote_respond_frame_code(
+				REMOTE_RESP_ERR, REMOTE_ERROR_EXCEPTION | ((uint64_t)exception_frame.type << 8U));
+		}
+		break;
+	}
+
+#if defined(CONFIG_RISCV_ACCEL) && CONFIG_RISCV_ACCEL == 1
+	case REMOTE_RISCV_PACKET:
+		remote_binary_process_riscv(packet, packet_length);
+		break;
+#endif
+
+	case REMOTE_FLASH_PACKET: {
+		/* Setup an exception frame to try the Flash write in */
+		TRY (EXCEPTION_ALL) {
+			remote_binary_process_flash(packet, packet_length);
+		}
+		CATCH () {
+		default:
+			remote_respond_frame_code(
+				REMOTE_RESP_ERR, REMOTE_ERROR_EXCEPTION | ((uint64_t)exception_frame.type << 8U));
+		}
+		break;
+	}
+
+	default: /* Oh dear, unrecognised, return an error */
+		remote_respond_frame_code(REMOTE_RESP_ERR, REMOTE_ERROR_UNRECOGNISED);
+		break;
+	}
+	SET_IDLE_STATE(1);
+}
 #endif
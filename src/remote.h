@@ -25,8 +25,9 @@
 
 #include <stddef.h>
 #include "general.h"
+#include "remote_protocol_v5.h"
 
-#define REMOTE_HL_VERSION 4
+#define REMOTE_HL_VERSION 5
 
 /*
  * Commands to remote end, and responses
@@ -52,6 +53,30 @@
  * to be marshalled in remote.c, swdptap.c and jtagtap.c, so be
  * careful to ensure the parameter handling matches the protocol
  * definition when anything is changed.
+ *
+ * Binary frames (protocol v5 onwards)
+ * ===================================
+ *
+ * Bulk requests may instead be sent as length-prefixed binary frames,
+ * which avoids hex-encoding their data:
+ *
+ * !B<LEN><PAYLOAD>
+ *   <LEN>     - 16-bit little endian length of <PAYLOAD>
+ *   <PAYLOAD> - <TYPE><CMD> followed by the command's parameters as
+ *               little endian binary values, then any data
+ *
+ * There is no end of message marker, the length is authoritative. The
+ * probe replies in kind:
+ *
+ * &<CODE><LEN><PAYLOAD>
+ *   <CODE>    - one of the REMOTE_RESP_* response codes
+ *   <LEN>     - 16-bit little endian length of <PAYLOAD>
+ *   <PAYLOAD> - any data returned, or the 64-bit little endian error
+ *               value for REMOTE_RESP_ERR responses
+ *
+ * The largest payload the probe can accept or return in a single frame
+ * is found with the HF (REMOTE_HL_FRAME_SIZE) request. The v5 definitions
+ * live in remote_protocol_v5.h so BMDA can share them.
  */
 
 /* Protocol error messages */
@@ -463,5 +488,12 @@
 	}
 
 void remote_packet_process(char *packet, size_t packet_length);
+void remote_packet_process_binary(uint8_t *packet, size_t packet_length);
+
+/* How often, in milliseconds, an armed memory watch checks the target while waiting for requests */
+#define REMOTE_MEM_WATCH_INTERVAL 1U
+
+bool remote_mem_watch_armed(void);
+void remote_mem_watch_poll(void);
 
 #endif /* REMOTE_H */
@@ -0,0 +1,152 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2024 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef REMOTE_PROTOCOL_V5_H
+#define REMOTE_PROTOCOL_V5_H
+
+/*
+ * Remote protocol v5 definitions shared by the probe firmware (via remote.h) and
+ * BMDA (via protocol_v5_defs.h). See remote.h for the binary frame format.
+ */
+
+/* Binary frame identifier and the size of the frame header (start marker, type/code and length) */
+#define REMOTE_BINARY_PACKET        'B'
+#define REMOTE_BINARY_HEADER_LENGTH 4U
+/* Error responses carry the response code followed by a 64-bit error value */
+#define REMOTE_BINARY_ERROR_LENGTH 9U
+
+/* Unsolicited binary frame sent when an armed memory watch triggers, see REMOTE_MEM_WATCH */
+#define REMOTE_RESP_WATCH 'W'
+
+/* High-level protocol request for the largest binary frame payload */
+#define REMOTE_HL_FRAME_SIZE 'F'
+
+#define REMOTE_HL_FRAME_SIZE_STR                                          \
+	(char[])                                                              \
+	{                                                                     \
+		REMOTE_SOM, REMOTE_HL_PACKET, REMOTE_HL_FRAME_SIZE, REMOTE_EOM, 0 \
+	}
+
+/* Acceleration capabilities added in this version of the protocol */
+#define REMOTE_ACCEL_FLASH     (1U << 4U)
+#define REMOTE_ACCEL_MEM_WATCH (1U << 5U)
+#define REMOTE_ACCEL_MEM_CRC32 (1U << 6U)
+#define REMOTE_ACCEL_BATCH     (1U << 7U)
+
+/* ADIv5 acceleration requests added in this version of the protocol */
+#define REMOTE_MEM_WATCH   'W'
+#define REMOTE_MEM_UNWATCH 'w'
+#define REMOTE_MEM_CRC32   'c'
+#define REMOTE_ADIV5_BATCH 'L'
+
+/*
+ * Flash programming offload protocol elements (protocol v5 onwards)
+ *
+ * The probe scans and attaches to its own copy of the target the host is
+ * driving, then runs that target's Flash driver locally.
+ */
+#define REMOTE_FLASH_PACKET    'F'
+#define REMOTE_FLASH_ATTACH    'A'
+#define REMOTE_FLASH_ERASE     'E'
+#define REMOTE_FLASH_WRITE     'W'
+#define REMOTE_FLASH_COMPLETE  'C'
+#define REMOTE_FLASH_RELEASE   'D'
+#define REMOTE_FLASH_SCAN_SWD  'S'
+#define REMOTE_FLASH_SCAN_JTAG 'J'
+
+#define REMOTE_FLASH_ATTACH_STR                                                                        \
+	(char[])                                                                                           \
+	{                                                                                                  \
+		REMOTE_SOM, REMOTE_FLASH_PACKET, REMOTE_FLASH_ATTACH, '%', 'c', REMOTE_UINT32, REMOTE_UINT8, \
+			REMOTE_EOM, 0                                                                              \
+	}
+#define REMOTE_FLASH_ERASE_STR                                                                             \
+	(char[])                                                                                               \
+	{                                                                                                      \
+		REMOTE_SOM, REMOTE_FLASH_PACKET, REMOTE_FLASH_ERASE, REMOTE_UINT32, REMOTE_UINT32, REMOTE_EOM, 0 \
+	}
+#define REMOTE_FLASH_COMPLETE_STR                                              \
+	(char[])                                                                   \
+	{                                                                          \
+		REMOTE_SOM, REMOTE_FLASH_PACKET, REMOTE_FLASH_COMPLETE, REMOTE_EOM, 0 \
+	}
+#define REMOTE_FLASH_RELEASE_STR                                              \
+	(char[])                                                                  \
+	{                                                                         \
+		REMOTE_SOM, REMOTE_FLASH_PACKET, REMOTE_FLASH_RELEASE, REMOTE_EOM, 0 \
+	}
+
+/*
+ * Binary frame payload layouts (protocol v5 onwards), all values little endian:
+ *
+ * Am - ADIv5 memory read:  dev_index(1) apsel(1) csw(4) address(8) count(4)
+ * AM - ADIv5 memory write: dev_index(1) apsel(1) csw(4) alignment(1) address(8) count(4) data(count)
+ * A6m - ADIv6 memory read:  dev_index(1) ap_address(8) csw(4) address(8) count(4)
+ * A6M - ADIv6 memory write: dev_index(1) ap_address(8) csw(4) alignment(1) address(8) count(4) data(count)
+ * JD/Jd - JTAG TDI/TDO sequence (with/without TMS on the final cycle): cycles(4) return_tdo(1) tdi((cycles + 7) / 8)
+ * Ac - ADIv5 memory CRC32: dev_index(1) apsel(1) csw(4) address(8) length(4)
+ * AW - ADIv5 memory watch: dev_index(1) apsel(1) csw(4) address(8) mask(4) match(4)
+ * AL - ADIv5 access batch: dev_index(1) count(1) then count entries of flags(1) apsel(1) address(2) value(4)
+ * Aw - ADIv5 memory watch disarm (no parameters)
+ * FW - Flash write (offload): address(4) length(4) data(length)
+ * Rd - RISC-V DMI read:  dev_index(1) idle_cycles(1) address_width(1) address(4)
+ * RD - RISC-V DMI write: dev_index(1) idle_cycles(1) address_width(1) address(4) value(4)
+ *
+ * Memory reads reply with the data read, JTAG sequences with the TDO data (if requested) and DMI reads with
+ * the 32-bit value read. Memory CRC32 requests reply with the 32-bit CRC of the region, calculated as for qCRC.
+ * Access batches run each entry in turn, as an AP register access (using apsel) if the entry's AP flag is set or
+ * as a DP register access otherwise, stopping at the first fault. They reply with the 32-bit values of all reads.
+ *
+ * An armed memory watch has the probe read the 32-bit word at address while it waits for requests from the
+ * host. Once (word & mask) == match, or the read faults, the watch disarms and the probe sends an unsolicited
+ * REMOTE_RESP_WATCH frame carrying the word read. The host must be prepared to find this frame ahead of the
+ * response to any request it makes while a watch is armed.
+ */
+#define REMOTE_BINARY_ADIV5_MEM_READ_LENGTH    20U
+#define REMOTE_BINARY_ADIV5_MEM_WRITE_LENGTH   21U
+#define REMOTE_BINARY_ADIV6_MEM_READ_LENGTH    28U
+#define REMOTE_BINARY_ADIV6_MEM_WRITE_LENGTH   29U
+#define REMOTE_BINARY_JTAG_TDITDO_LENGTH       7U
+#define REMOTE_BINARY_RISCV_DMI_READ_LENGTH    9U
+#define REMOTE_BINARY_RISCV_DMI_WRITE_LENGTH   13U
+#define REMOTE_BINARY_FLASH_WRITE_LENGTH       10U
+#define REMOTE_BINARY_ADIV5_MEM_WATCH_LENGTH   24U
+#define REMOTE_BINARY_ADIV5_MEM_UNWATCH_LENGTH 2U
+#define REMOTE_BINARY_ADIV5_BATCH_LENGTH       4U
+#define REMOTE_BINARY_ADIV5_BATCH_OP_LENGTH    8U
+#define REMOTE_BINARY_ADIV5_BATCH_MAX_OPS      16U
+
+/* Access batch entry flags */
+#define REMOTE_ADIV5_BATCH_READ (1U << 0U)
+#define REMOTE_ADIV5_BATCH_AP   (1U << 1U)
+
+#endif /* REMOTE_PROTOCOL_V5_H */
@@ -472,6 +472,14 @@ static bool adi_configure_mem_ap(adiv5_access_port_s *const ap)
 		return false;
 	}
 
+	/*
+	 * Packed transfer support is optional, and AddrInc reads back as single increment if it is not implemented,
+	 * so try to turn it on to find out if we can use it for sub-word accesses
+	 */
+	adiv5_ap_write(ap, ADIV5_AP_CSW, ap->csw | ADIV5_AP_CSW_ADDRINC_PACKED | ADIV5_AP_CSW_SIZE_BYTE);
+	if ((adiv5_ap_read(ap, ADIV5_AP_CSW) & ADIV5_AP_CSW_ADDRINC_MASK) == ADIV5_AP_CSW_ADDRINC_PACKED)
+		ap->flags |= ADIV5_AP_FLAGS_PACKED;
+
 	return true;
 }
 
@@ -510,10 +518,11 @@ void adi_ap_resume_cores(adiv5_access_port_s *const ap)
 	}
 }
 
-/* Program the CSW and TAR for sequential access at a given width */
-void adi_ap_mem_access_setup(adiv5_access_port_s *const ap, const target_addr64_t addr, const align_e align)
+/* Program the CSW and TAR for sequential access at a given width using the given address increment mode */
+static void adi_ap_mem_access_setup_inc(
+	adiv5_access_port_s *const ap, const target_addr64_t addr, const align_e align, const uint32_t addr_inc)
 {
-	uint32_t csw = ap->csw | ADIV5_AP_CSW_ADDRINC_SINGLE;
+	uint32_t csw = ap->csw | addr_inc;
 
 	switch (align) {
 	case ALIGN_8BIT:
@@ -527,21 +536,49 @@ void adi_ap_mem_access_setup(adiv5_access_port_s *const ap, const target_addr64_
 		csw |= ADIV5_AP_CSW_SIZE_WORD;
 		break;
 	}
-	/* Select AP bank 0 and write CSW */
-	adiv5_ap_write(ap, ADIV5_AP_CSW, csw);
+	/* Skip rewriting CSW and TAR if the last memory access left them how we need them */
+	const bool shadow_valid = adiv5_ap_shadow_valid(ap);
+	if (!shadow_valid || ap->shadow_csw != csw)
+		/* Select AP bank 0 and write CSW */
+		adiv5_ap_write(ap, ADIV5_AP_CSW, csw);
+	else {
+		/* CSW is already correct, but TAR and DRW still need AP bank 0 selecting */
+		const uint32_t select = ((uint32_t)ap->apsel << 24U) | (ADIV5_AP_CSW & 0xf0U);
+		if (!adiv5_dp_select_current(ap->dp, select))
+			adiv5_dp_write(ap->dp, ADIV5_DP_SELECT, select);
+	}
 	/* Then write TAR which is in the same AP bank */
-	if (ap->flags & ADIV5_AP_FLAGS_64BIT)
+	if ((ap->flags & ADIV5_AP_FLAGS_64BIT) && (!shadow_valid || (ap->shadow_tar >> 32U) != (addr >> 32U)))
 		adiv5_dp_write(ap->dp, ADIV5_AP_TAR_HIGH, (uint32_t)(addr >> 32U));
-	adiv5_dp_write(ap->dp, ADIV5_AP_TAR_LOW, (uint32_t)addr);
+	if (!shadow_valid || (uint32_t)ap->shadow_tar != (uint32_t)addr)
+		adiv5_dp_write(ap->dp, ADIV5_AP_TAR_LOW, (uint32_t)addr);
+	adiv5_ap_shadow_update(ap, csw, addr);
+}
+
+/* Program the CSW and TAR for sequential access at a given width */
+void adi_ap_mem_access_setup(adiv5_access_port_s *const ap, const target_addr64_t addr, const align_e align)
+{
+	adi_ap_mem_access_setup_inc(ap, addr, align, ADIV5_AP_CSW_ADDRINC_SINGLE);
+}
+
+/*
+ * Program the CSW and TAR for packed access at a given width, where each DRW access performs as many
+ * accesses of that width as fit between TAR and the next word boundary. Only valid on APs with ADIV5_AP_FLAGS_PACKED
+ */
+void adi_ap_mem_access_setup_packed(adiv5_access_port_s *const ap, const target_addr64_t addr, const align_e align)
+{
+	adi_ap_mem_access_setup_inc(ap, addr, align, ADIV5_AP_CSW_ADDRINC_PACKED);
 }
 
 void adi_ap_banked_access_setup(adiv5_access_port_s *base_ap)
 {
 	/* Check which ADI version this is for, v5 only requires we set up the DP's SELECT register */
-	if (base_ap->dp->version <= 2U)
+	if (base_ap->dp->version <= 2U) {
 		/* Configure the bank selection to the appropriate AP register bank */
-		adiv5_dp_write(base_ap->dp, ADIV5_DP_SELECT, ((uint32_t)base_ap->apsel << 24U) | (ADIV5_AP_DB(0) & 0x00f0U));
-	else {
+		const uint32_t select = ((uint32_t)base_ap->apsel << 24U) | (ADIV5_AP_DB(0) & 0x00f0U);
+		if (!adiv5_dp_select_current(base_ap->dp, select))
+			adiv5_dp_write(base_ap->dp, ADIV5_DP_SELECT, select);
+	} else {
 		/* ADIv6 requires we set up the DP's SELECT1 and SELECT registers to correctly acccess the AP */
 		adiv6_access_port_s *const ap = (adiv6_access_port_s *)base_ap;
 		/* Set SELECT1 in the DP up first */
@@ -552,21 +589,30 @@ void adi_ap_banked_access_setup(adiv5_access_port_s *base_ap)
 	}
 }
 
-static uint32_t adi_ap_read_id(adiv5_access_port_s *ap, uint32_t addr)
-{
-	uint32_t res = 0;
-	uint8_t data[16];
-	adiv5_mem_read(ap, data, addr, sizeof(data));
-	for (size_t i = 0; i < 4U; ++i)
-		res |= (uint32_t)data[4U * i] << (i * 8U);
-	return res;
-}
-
-static uint64_t adi_ap_read_pidr(adiv5_access_port_s *ap, uint32_t addr)
+/*
+ * Read a component's CIDR and PIDR in one go. PIDR4-7, PIDR0-3 and CIDR0-3 sit one after another from
+ * PIDR4, with each holding one byte of the ID in its lowest 8 bits, so this is a single batched run of reads.
+ */
+static void adi_ap_read_ids(adiv5_access_port_s *const ap, const target_addr64_t base_address, uint32_t *const cidr,
+	uint64_t *const pidr)
 {
-	const uint32_t pidr_upper = adi_ap_read_id(ap, addr + PIDR4_OFFSET);
-	const uint32_t pidr_lower = adi_ap_read_id(ap, addr + PIDR0_OFFSET);
-	return ((uint64_t)pidr_upper << 32U) | (uint64_t)pidr_lower;
+	uint32_t ids[12U] = {0U};
+	adiv5_batch_s batch;
+	adiv5_batch_init(&batch, ap->dp);
+	adiv5_batch_mem_access_setup(&batch, ap, base_address + PIDR4_OFFSET);
+	for (size_t i = 0; i < ARRAY_LENGTH(ids); ++i)
+		adiv5_batch_ap_read(&batch, ap, ADIV5_AP_DRW, &ids[i]);
+	adiv5_batch_execute(&batch);
+
+	uint32_t pidr_upper = 0U;
+	uint32_t pidr_lower = 0U;
+	*cidr = 0U;
+	for (size_t i = 0; i < 4U; ++i) {
+		pidr_upper |= (ids[i] & 0xffU) << (i * 8U);
+		pidr_lower |= (ids[4U + i] & 0xffU) << (i * 8U);
+		*cidr |= (ids[8U + i] & 0xffU) << (i * 8U);
+	}
+	*pidr = ((uint64_t)pidr_upper << 32U) | (uint64_t)pidr_lower;
 }
 
 uint32_t adi_mem_read32(adiv5_access_port_s *const ap, const target_addr32_t addr)
@@ -581,6 +627,35 @@ void adi_mem_write32(adiv5_access_port_s *const ap, const target_addr32_t addr,
 	adiv5_mem_write(ap, addr, &value, sizeof(value));
 }
 
+#if CONFIG_BMDA == 1
+/* Where the AP component tree walk in progress is recording what it finds for the discovery cache, if anywhere */
+static adi_discovery_s *adi_discovery;
+#endif
+
+/* Note down a core debug component the walk is about to hand off to a probe routine */
+static void adi_discovery_record(
+	const target_addr64_t base_address, const uint32_t cidr, const uint64_t pidr, const arm_arch_e arch)
+{
+#if CONFIG_BMDA == 1
+	if (!adi_discovery)
+		return;
+	if (adi_discovery->count == ADI_DISCOVERY_MAX_COMPONENTS) {
+		adi_discovery->incomplete = true;
+		return;
+	}
+	adi_discovered_component_s *const component = &adi_discovery->components[adi_discovery->count++];
+	component->base_address = base_address;
+	component->cidr = cidr;
+	component->pidr = pidr;
+	component->arch = arch;
+#else
+	(void)base_address;
+	(void)cidr;
+	(void)pidr;
+	(void)arch;
+#endif
+}
+
 static void adi_parse_adi_rom_table(adiv5_access_port_s *const ap, const target_addr32_t base_address,
 	const size_t recursion_depth, const char *const indent, const uint64_t pidr)
 {
@@ -603,6 +678,7 @@ static void adi_parse_adi_rom_table(adiv5_access_port_s *const ap, const target_
 					 * Handle it here, as access only to limited memory region
 					 * is allowed
 					 */
+				adi_discovery_record(base_address, CID_PREAMBLE | (cidc_romtab << CID_CLASS_SHIFT), pidr, aa_cortexm);
 				cortexm_probe(ap);
 				return;
 			}
@@ -783,7 +859,9 @@ void adi_ap_component_probe(
 	(void)entry_number;
 #endif
 
-	const uint32_t cidr = adi_ap_read_id(ap, base_address + CIDR0_OFFSET);
+	uint32_t cidr = 0U;
+	uint64_t pidr = 0U;
+	adi_ap_read_ids(ap, base_address, &cidr, &pidr);
 	if (ap->dp->fault) {
 		DEBUG_ERROR("Error reading CIDR on AP%u: %u\n", ap->apsel, ap->dp->fault);
 		return;
@@ -804,6 +882,13 @@ void adi_ap_component_probe(
 		return;
 	}
 
+#if CONFIG_BMDA == 1
+	if (recursion == 0U && adi_discovery) {
+		adi_discovery->root_cidr = cidr;
+		adi_discovery->root_pidr = pidr;
+	}
+#endif
+
 	/* CIDR preamble sanity check */
 	if ((cidr & ~CID_CLASS_MASK) != CID_PREAMBLE) {
 		DEBUG_WARN("%s%" PRIu32 " 0x%0" PRIx32 "%08" PRIx32 ": 0x%08" PRIx32 " <- does not match preamble (0x%08" PRIx32
@@ -815,9 +900,6 @@ void adi_ap_component_probe(
 	/* Extract Component ID class nibble */
 	const uint8_t cid_class = (cidr & CID_CLASS_MASK) >> CID_CLASS_SHIFT;
 
-	/* Read out the peripheral ID register */
-	const uint64_t pidr = adi_ap_read_pidr(ap, base_address);
-
 	/* ROM table */
 	if (cid_class == cidc_romtab) {
 		/* Validate that the SIZE field is 0 per the spec */
@@ -864,14 +946,17 @@ void adi_ap_component_probe(
 		switch (component->arch) {
 		case aa_cortexm:
 			DEBUG_INFO("%s-> cortexm_probe\n", indent + 1);
+			adi_discovery_record(base_address, cidr, pidr, aa_cortexm);
 			cortexm_probe(ap);
 			break;
 		case aa_cortexa:
 			DEBUG_INFO("%s-> cortexa_probe\n", indent + 1);
+			adi_discovery_record(base_address, cidr, pidr, aa_cortexa);
 			cortexa_probe(ap, base_address);
 			break;
 		case aa_cortexr:
 			DEBUG_INFO("%s-> cortexr_probe\n", indent + 1);
+			adi_discovery_record(base_address, cidr, pidr, aa_cortexr);
 			cortexr_probe(ap, base_address);
 			break;
 		/* Handle when the component is a CoreSight component ROM table */
@@ -886,3 +971,74 @@ void adi_ap_component_probe(
 		}
 	}
 }
+
+#if CONFIG_BMDA == 1
+/*
+ * Redo the probing a previous walk of this AP's component tree did, without walking it again.
+ * The IDs of the AP's root component and of every core found are read back first to check that
+ * this is still the same part, and if anything doesn't match, we return false to get a full walk done instead
+ */
+static bool adi_ap_discovery_replay(adiv5_access_port_s *const ap, const adi_discovery_s *const discovery)
+{
+	uint32_t cidr = 0U;
+	uint64_t pidr = 0U;
+	adi_ap_read_ids(ap, ap->base, &cidr, &pidr);
+	if (ap->dp->fault || adiv5_dp_error(ap->dp) || cidr != discovery->root_cidr || pidr != discovery->root_pidr)
+		return false;
+	for (size_t idx = 0U; idx < discovery->count; ++idx) {
+		const adi_discovered_component_s *const component = &discovery->components[idx];
+		/* The root component was already checked above, and may be a ROM table standing in for a protected core */
+		if (component->base_address == ap->base)
+			continue;
+		adi_ap_read_ids(ap, component->base_address, &cidr, &pidr);
+		if (ap->dp->fault || adiv5_dp_error(ap->dp) || cidr != component->cidr || pidr != component->pidr)
+			return false;
+	}
+
+	DEBUG_INFO("AP %3u: Using cached discovery results (%zu cores)\n", ap->apsel, discovery->count);
+	ap->designer_code = discovery->designer_code;
+	ap->partno = discovery->partno;
+	ap->flags |= discovery->flags;
+	for (size_t idx = 0U; idx < discovery->count; ++idx) {
+		const adi_discovered_component_s *const component = &discovery->components[idx];
+		switch (component->arch) {
+		case aa_cortexm:
+			cortexm_probe(ap);
+			break;
+		case aa_cortexa:
+			cortexa_probe(ap, component->base_address);
+			break;
+		case aa_cortexr:
+			cortexr_probe(ap, component->base_address);
+			break;
+		default:
+			break;
+		}
+	}
+	return true;
+}
+#endif
+
+void adi_ap_discover(adiv5_access_port_s *const ap)
+{
+#if CONFIG_BMDA == 1
+	adi_discovery_s discovery;
+	if (bmda_discovery_cache_lookup(ap, &discovery) && adi_ap_discovery_replay(ap, &discovery))
+		return;
+
+	memset(&discovery, 0, sizeof(discovery));
+	const uint8_t flags = ap->flags;
+	adi_discovery = &discovery;
+#endif
+	adi_ap_component_probe(ap, ap->base, 0, 0);
+#if CONFIG_BMDA == 1
+	adi_discovery = NULL;
+	/* Only cache walks that got all the way through without the link falling over */
+	if (discovery.incomplete || ap->dp->fault || !discovery.root_cidr)
+		return;
+	discovery.designer_code = ap->designer_code;
+	discovery.partno = ap->partno;
+	discovery.flags = ap->flags & ~flags;
+	bmda_discovery_cache_store(ap, &discovery);
+#endif
+}
@@ -39,11 +39,14 @@ uint32_t adi_mem_read32(adiv5_access_port_s *ap, target_addr32_t addr);
 /* Helper for probing a CoreSight debug component */
 void adi_ap_component_probe(
 	adiv5_access_port_s *ap, target_addr64_t base_address, size_t recursion, uint32_t entry_number);
+/* Helper for discovering everything on an AP by walking its component tree */
+void adi_ap_discover(adiv5_access_port_s *ap);
 /* Helper for resuming all cores halted on an AP during probe */
 void adi_ap_resume_cores(adiv5_access_port_s *ap);
 
 /* Helpers for setting up memory accesses and banked accesses */
 void adi_ap_mem_access_setup(adiv5_access_port_s *ap, target_addr64_t addr, align_e align);
+void adi_ap_mem_access_setup_packed(adiv5_access_port_s *ap, target_addr64_t addr, align_e align);
 void adi_ap_banked_access_setup(adiv5_access_port_s *base_ap);
 
 /*
@@ -56,4 +59,35 @@ static inline uint16_t adi_decode_designer(const uint16_t designer)
 	return (designer & ADIV5_DP_DESIGNER_JEP106_CONT_MASK) << 1U | (designer & ADIV5_DP_DESIGNER_JEP106_CODE_MASK);
 }
 
+#if CONFIG_BMDA == 1
+#define ADI_DISCOVERY_MAX_COMPONENTS 16U
+
+/* A core debug component found on an AP by a component tree walk, and which probe routine it was handed to */
+typedef struct adi_discovered_component {
+	target_addr64_t base_address;
+	uint64_t pidr;
+	uint32_t cidr;
+	arm_arch_e arch;
+} adi_discovered_component_s;
+
+/* The results of walking an AP's component tree, enough to redo the walk's probing without the walk */
+typedef struct adi_discovery {
+	/* IDs of the component at the AP's base address, so we can tell if this is still the same part */
+	uint64_t root_pidr;
+	uint32_t root_cidr;
+	/* AP state the walk sets up as it goes */
+	uint16_t designer_code;
+	uint16_t partno;
+	uint8_t flags;
+	/* Set if the walk found more components than would fit, or otherwise can't be replayed */
+	bool incomplete;
+	size_t count;
+	adi_discovered_component_s components[ADI_DISCOVERY_MAX_COMPONENTS];
+} adi_discovery_s;
+
+/* BMDA interposition functions for the on-disk discovery cache */
+bool bmda_discovery_cache_lookup(const adiv5_access_port_s *ap, adi_discovery_s *discovery);
+void bmda_discovery_cache_store(const adiv5_access_port_s *ap, const adi_discovery_s *discovery);
+#endif
+
 #endif /* TARGET_ADI_H */
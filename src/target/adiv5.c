@@ -461,6 +461,14 @@ void adiv5_dp_init(adiv5_debug_port_s *const dp)
 			(targetid & (ADIV5_DP_TARGETID_TDESIGNER_MASK | ADIV5_DP_TARGETID_TPARTNO_MASK)) | 1U;
 	}
 
+	/*
+	 * SELECT, CSW and TAR can only be shadowed if all accesses to them go through the generic routines,
+	 * rather than through a probe backend that manages them for itself
+	 */
+	if (dp->ap_read == adiv5_ap_reg_read && dp->ap_write == adiv5_ap_reg_write &&
+		dp->mem_read == adiv5_mem_read_bytes && dp->mem_write == adiv5_mem_write_bytes && !dp->execute_batch)
+		dp->quirks |= ADIV5_DP_SHADOWED;
+
 	if (dp->designer_code == JEP106_MANUFACTURER_RASPBERRY && dp->partno == 0x2U) {
 		rp2040_rescue_setup(dp);
 		return;
@@ -526,7 +534,7 @@ void adiv5_dp_init(adiv5_debug_port_s *const dp)
 			}
 
 			/* The rest should only be added after checking ROM table */
-			adi_ap_component_probe(ap, ap->base, 0, 0);
+			adi_ap_discover(ap);
 			/* Having completed discovery on this AP, try to resume any halted cores */
 			adi_ap_resume_cores(ap);
 
@@ -614,22 +622,31 @@ const void *adiv5_pack_data(
 	return (const uint8_t *)src + (1U << align);
 }
 
-void adiv5_mem_read_bytes(adiv5_access_port_s *const ap, void *dest, const target_addr64_t src, const size_t len)
+/* Read count values from the AP's DRW, using the DP's pipelined block read if it has one */
+static void adiv5_ap_drw_read_block(adiv5_debug_port_s *const dp, uint32_t *const values, const size_t count)
 {
-	/* Do nothing and return if there's nothing to read */
-	if (len == 0U)
+	if (dp->ap_read_block) {
+		dp->ap_read_block(dp, ADIV5_AP_DRW, values, count);
 		return;
+	}
+	for (size_t idx = 0U; idx < count; ++idx)
+		values[idx] = adiv5_dp_read(dp, ADIV5_AP_DRW);
+}
+
+/* Read a run of data that is naturally aligned to the given access width */
+static void *adiv5_mem_read_aligned(adiv5_access_port_s *const ap, void *dest, const target_addr64_t src,
+	const size_t len, const align_e align)
+{
 	/* Calculate the extent of the transfer */
 	target_addr64_t begin = src;
 	const target_addr64_t end = begin + len;
-	/* Calculate the alignment of the transfer */
-	const align_e align = MIN_ALIGN(src, len);
 	/* Calculate how much each loop will increment the destination address by */
 	const uint8_t stride = 1U << align;
+	uint32_t values[32U];
 	/* Set up the transfer */
 	adi_ap_mem_access_setup(ap, src, align);
-	/* Now loop through the data and move it 1 stride at a time to the target */
-	for (; begin < end; begin += stride) {
+	/* Now loop through the data, grabbing runs of strides that stay within the same TAR auto increment block */
+	while (begin < end) {
 		/*
 		 * Check if the address doesn't overflow the 10-bit auto increment bound for TAR,
 		 * if it's not the first transfer (offset == 0)
@@ -640,11 +657,69 @@ void adiv5_mem_read_bytes(adiv5_access_port_s *const ap, void *dest, const targe
 				adiv5_dp_write(ap->dp, ADIV5_AP_TAR_HIGH, (uint32_t)(begin >> 32));
 			adiv5_dp_write(ap->dp, ADIV5_AP_TAR_LOW, (uint32_t)begin);
 		}
-		/* Grab the next chunk of data from the target */
+		/* Work out how many strides we can do before hitting the end of the block or the transfer */
+		const target_addr64_t block_end = MIN(end, (begin | 0x000003ffU) + 1U);
+		const size_t count = MIN((size_t)((block_end - begin) >> align), ARRAY_LENGTH(values));
+		/* Grab the next run of data from the target */
+		adiv5_ap_drw_read_block(ap->dp, values, count);
+		/* Unpack the data from the run */
+		for (size_t idx = 0U; idx < count; ++idx, begin += stride)
+			dest = adiv5_unpack_data(dest, begin, values[idx], align);
+	}
+	/* TAR is left pointing just past the data, unless it ran off the end of the auto increment block */
+	if (align <= ALIGN_32BIT && (end & 0x000003ffU) != 0U)
+		adiv5_ap_shadow_update(ap, ap->shadow_csw, end);
+	return dest;
+}
+
+/* Read the up to 3 bytes either side of the word aligned body of an unaligned read */
+static void *adiv5_mem_read_edge(adiv5_access_port_s *const ap, void *dest, target_addr64_t src, size_t len)
+{
+	/*
+	 * If the AP can do packed transfers and this edge runs up to a word boundary, one DRW access
+	 * gets the AP to do all the byte accesses for us, with each byte landing in its natural byte lane
+	 */
+	if ((ap->flags & ADIV5_AP_FLAGS_PACKED) && len > 1U && (src & 3U) + len == 4U) {
+		adi_ap_mem_access_setup_packed(ap, src, ALIGN_8BIT);
 		const uint32_t value = adiv5_dp_read(ap->dp, ADIV5_AP_DRW);
-		/* Unpack the data from the chunk */
-		dest = adiv5_unpack_data(dest, begin, value, align);
+		for (; len; --len, ++src)
+			dest = adiv5_unpack_data(dest, src, value, ALIGN_8BIT);
+		return dest;
+	}
+	/* Otherwise do the edge in as few naturally aligned byte and half-word accesses as we can */
+	while (len) {
+		const align_e align = MIN_ALIGN(src, MIN(len, 2U));
+		const size_t amount = 1U << align;
+		dest = adiv5_mem_read_aligned(ap, dest, src, amount, align);
+		src += amount;
+		len -= amount;
 	}
+	return dest;
+}
+
+void adiv5_mem_read_bytes(adiv5_access_port_s *const ap, void *dest, const target_addr64_t src, const size_t len)
+{
+	/* Do nothing and return if there's nothing to read */
+	if (len == 0U)
+		return;
+	/* Calculate the alignment of the transfer */
+	const align_e align = MIN_ALIGN(src, len);
+	/* If the transfer is naturally word aligned, do it in one go */
+	if (align >= ALIGN_32BIT) {
+		adiv5_mem_read_aligned(ap, dest, src, len, align);
+		return;
+	}
+	/*
+	 * Otherwise rather than read the whole thing a byte or half-word at a time,
+	 * split it into the unaligned head, the word aligned body, and the unaligned tail
+	 */
+	const size_t head = MIN(len, (4U - (src & 3U)) & 3U);
+	const size_t body = (len - head) & ~(size_t)3U;
+	const size_t tail = len - head - body;
+	dest = adiv5_mem_read_edge(ap, dest, src, head);
+	if (body)
+		dest = adiv5_mem_read_aligned(ap, dest, src + head, body, ALIGN_32BIT);
+	adiv5_mem_read_edge(ap, dest, src + head + body, tail);
 }
 
 void adiv5_mem_write_bytes(
@@ -680,22 +755,148 @@ void adiv5_mem_write_bytes(
 	}
 	/* Make sure this write is complete by doing a dummy read */
 	adiv5_dp_read(ap->dp, ADIV5_DP_RDBUFF);
+	/* TAR is left pointing just past the data, unless it ran off the end of the auto increment block */
+	if (align <= ALIGN_32BIT && (end & 0x000003ffU) != 0U)
+		adiv5_ap_shadow_update(ap, ap->shadow_csw, end);
+}
+
+bool adiv5_dp_select_current(const adiv5_debug_port_s *const dp, const uint32_t select)
+{
+	return (dp->quirks & ADIV5_DP_SHADOWED) && dp->select_valid && dp->select == select && !dp->fault;
+}
+
+bool adiv5_ap_shadow_valid(const adiv5_access_port_s *const ap)
+{
+	const adiv5_debug_port_s *const dp = ap->dp;
+	return (dp->quirks & ADIV5_DP_SHADOWED) && ap->shadow_valid && ap->shadow_epoch == dp->shadow_epoch && !dp->fault;
+}
+
+void adiv5_ap_shadow_update(adiv5_access_port_s *const ap, const uint32_t csw, const target_addr64_t tar)
+{
+	/* If the accesses that got CSW and TAR here faulted, we don't know what they now hold */
+	ap->shadow_valid = !ap->dp->fault;
+	ap->shadow_epoch = ap->dp->shadow_epoch;
+	ap->shadow_csw = csw;
+	ap->shadow_tar = tar;
 }
 
 void adiv5_ap_reg_write(adiv5_access_port_s *ap, uint16_t addr, uint32_t value)
 {
-	adiv5_dp_recoverable_access(
-		ap->dp, ADIV5_LOW_WRITE, ADIV5_DP_SELECT, ((uint32_t)ap->apsel << 24U) | (addr & 0xf0U));
+	const uint32_t select = ((uint32_t)ap->apsel << 24U) | (addr & 0xf0U);
+	if (!adiv5_dp_select_current(ap->dp, select))
+		adiv5_dp_recoverable_access(ap->dp, ADIV5_LOW_WRITE, ADIV5_DP_SELECT, select);
 	adiv5_dp_write(ap->dp, addr, value);
 }
 
 uint32_t adiv5_ap_reg_read(adiv5_access_port_s *ap, uint16_t addr)
 {
-	adiv5_dp_recoverable_access(
-		ap->dp, ADIV5_LOW_WRITE, ADIV5_DP_SELECT, ((uint32_t)ap->apsel << 24U) | (addr & 0xf0U));
+	const uint32_t select = ((uint32_t)ap->apsel << 24U) | (addr & 0xf0U);
+	if (!adiv5_dp_select_current(ap->dp, select))
+		adiv5_dp_recoverable_access(ap->dp, ADIV5_LOW_WRITE, ADIV5_DP_SELECT, select);
 	return adiv5_dp_read(ap->dp, addr);
 }
 
+void adiv5_batch_init(adiv5_batch_s *const batch, adiv5_debug_port_s *const dp)
+{
+	batch->dp = dp;
+	batch->count = 0U;
+}
+
+static void adiv5_batch_queue(adiv5_batch_s *const batch, adiv5_access_port_s *const ap, const uint16_t addr,
+	const uint8_t rnw, const uint32_t value, uint32_t *const result)
+{
+	/* If the batch is full, run what's in it so far to make room - a failure shows up in the DP's fault state */
+	if (batch->count == ADIV5_BATCH_MAX_OPS)
+		adiv5_batch_execute(batch);
+	adiv5_batch_op_s *const op = &batch->ops[batch->count++];
+	op->ap = ap;
+	op->addr = addr;
+	op->rnw = rnw;
+	op->value = value;
+	op->result = result;
+}
+
+void adiv5_batch_dp_read(adiv5_batch_s *const batch, const uint16_t addr, uint32_t *const result)
+{
+	adiv5_batch_queue(batch, NULL, addr, ADIV5_LOW_READ, 0U, result);
+}
+
+void adiv5_batch_dp_write(adiv5_batch_s *const batch, const uint16_t addr, const uint32_t value)
+{
+	adiv5_batch_queue(batch, NULL, addr, ADIV5_LOW_WRITE, value, NULL);
+}
+
+void adiv5_batch_ap_read(
+	adiv5_batch_s *const batch, adiv5_access_port_s *const ap, const uint16_t addr, uint32_t *const result)
+{
+	adiv5_batch_queue(batch, ap, addr, ADIV5_LOW_READ, 0U, result);
+}
+
+void adiv5_batch_ap_write(
+	adiv5_batch_s *const batch, adiv5_access_port_s *const ap, const uint16_t addr, const uint32_t value)
+{
+	adiv5_batch_queue(batch, ap, addr, ADIV5_LOW_WRITE, value, NULL);
+}
+
+/*
+ * Queue the accesses needed to set up the AP for 32-bit memory access starting at addr, as adi_ap_mem_access_setup()
+ * does. These are all queued as full AP accesses so they work on backends that can't do raw AP accesses.
+ */
+void adiv5_batch_mem_access_setup(adiv5_batch_s *const batch, adiv5_access_port_s *const ap, const target_addr64_t addr)
+{
+	adiv5_batch_ap_write(batch, ap, ADIV5_AP_CSW, ap->csw | ADIV5_AP_CSW_ADDRINC_SINGLE | ADIV5_AP_CSW_SIZE_WORD);
+	if (ap->flags & ADIV5_AP_FLAGS_64BIT)
+		adiv5_batch_ap_write(batch, ap, ADIV5_AP_TAR_HIGH, (uint32_t)(addr >> 32U));
+	adiv5_batch_ap_write(batch, ap, ADIV5_AP_TAR_LOW, (uint32_t)addr);
+}
+
+void adiv5_batch_mem_read32(
+	adiv5_batch_s *const batch, adiv5_access_port_s *const ap, const target_addr64_t addr, uint32_t *const result)
+{
+	adiv5_batch_mem_access_setup(batch, ap, addr);
+	adiv5_batch_ap_read(batch, ap, ADIV5_AP_DRW, result);
+}
+
+void adiv5_batch_mem_write32(
+	adiv5_batch_s *const batch, adiv5_access_port_s *const ap, const target_addr64_t addr, const uint32_t value)
+{
+	adiv5_batch_mem_access_setup(batch, ap, addr);
+	adiv5_batch_ap_write(batch, ap, ADIV5_AP_DRW, value);
+}
+
+bool adiv5_batch_run(const adiv5_batch_s *const batch)
+{
+	adiv5_debug_port_s *const dp = batch->dp;
+	for (size_t idx = 0U; idx < batch->count; ++idx) {
+		const adiv5_batch_op_s *const op = &batch->ops[idx];
+		if (op->ap) {
+			if (op->rnw)
+				*op->result = adiv5_ap_read(op->ap, op->addr);
+			else
+				adiv5_ap_write(op->ap, op->addr, op->value);
+		} else {
+			if (op->rnw)
+				*op->result = adiv5_dp_read(dp, op->addr);
+			else
+				adiv5_dp_write(dp, op->addr, op->value);
+		}
+		/* Stop at the first access to fail, everything after it is likely to depend on it */
+		if (dp->fault)
+			return false;
+	}
+	return true;
+}
+
+bool adiv5_batch_execute(adiv5_batch_s *const batch)
+{
+	if (!batch->count)
+		return true;
+	adiv5_debug_port_s *const dp = batch->dp;
+	const bool result = dp->execute_batch ? dp->execute_batch(batch) : adiv5_batch_run(batch);
+	batch->count = 0U;
+	return result;
+}
+
 void adiv5_mem_write(adiv5_access_port_s *const ap, const target_addr64_t dest, const void *const src, const size_t len)
 {
 	const align_e align = MIN_ALIGN(dest, len);
@@ -186,6 +186,7 @@
 #define ADIV5_AP_FLAGS_HAS_MEM         (1U << 1U)
 #define ADIV6_DP_FLAGS_HAS_PWRCTRL     (1U << 2U)
 #define ADIV6_DP_FLAGS_HAS_SYSRESETREQ (1U << 3U)
+#define ADIV5_AP_FLAGS_PACKED          (1U << 4U)
 
 /* ADIv5 Class 0x1 ROM Table Registers */
 #define ADI_ROM_MEMTYPE          0xfccU
@@ -239,6 +240,8 @@
 #define ADIV5_DP_JTAG (1U << 6U)
 /* This one is not a quirk, but the field's a convinient place to store this */
 #define ADIV5_AP_ACCESS_BANKED (1U << 7U) /* Last AP access was done using the banked interface */
+/* Nor is this - SELECT, CSW and TAR are only touched by the generic routines, so can be shadowed to skip rewrites */
+#define ADIV5_DP_SHADOWED (1U << 5U)
 
 /* JTAG DP discovery handler */
 void adiv5_jtag_dp_handler(uint8_t dev_index);
@@ -278,6 +281,48 @@ void adiv5_mem_read_bytes(adiv5_access_port_s *ap, void *dest, target_addr64_t s
 void adiv5_ap_reg_write(adiv5_access_port_s *ap, uint16_t addr, uint32_t value);
 uint32_t adiv5_ap_reg_read(adiv5_access_port_s *ap, uint16_t addr);
 
+/* The most accesses a batch can queue up before it gets run automatically to make room */
+#define ADIV5_BATCH_MAX_OPS 16U
+
+/* A single queued DP or AP register access */
+typedef struct adiv5_batch_op {
+	/* The AP this access is for, or NULL for a DP register or an AP register in the already selected bank */
+	adiv5_access_port_s *ap;
+	uint16_t addr;
+	uint8_t rnw;
+	uint32_t value;
+	/* Where to store the result of a read */
+	uint32_t *result;
+} adiv5_batch_op_s;
+
+/*
+ * A batch of DP and AP accesses to run together. The accesses are run in the order queued,
+ * with the results of reads only valid once adiv5_batch_execute() has returned true.
+ */
+struct adiv5_batch {
+	adiv5_debug_port_s *dp;
+	size_t count;
+	adiv5_batch_op_s ops[ADIV5_BATCH_MAX_OPS];
+};
+
+/* ADIv5 transaction batch functions */
+void adiv5_batch_init(adiv5_batch_s *batch, adiv5_debug_port_s *dp);
+void adiv5_batch_dp_read(adiv5_batch_s *batch, uint16_t addr, uint32_t *result);
+void adiv5_batch_dp_write(adiv5_batch_s *batch, uint16_t addr, uint32_t value);
+void adiv5_batch_ap_read(adiv5_batch_s *batch, adiv5_access_port_s *ap, uint16_t addr, uint32_t *result);
+void adiv5_batch_ap_write(adiv5_batch_s *batch, adiv5_access_port_s *ap, uint16_t addr, uint32_t value);
+void adiv5_batch_mem_access_setup(adiv5_batch_s *batch, adiv5_access_port_s *ap, target_addr64_t addr);
+void adiv5_batch_mem_read32(adiv5_batch_s *batch, adiv5_access_port_s *ap, target_addr64_t addr, uint32_t *result);
+void adiv5_batch_mem_write32(adiv5_batch_s *batch, adiv5_access_port_s *ap, target_addr64_t addr, uint32_t value);
+bool adiv5_batch_execute(adiv5_batch_s *batch);
+/* Generic implementation running a batch one access at a time, for backends that can't do better */
+bool adiv5_batch_run(const adiv5_batch_s *batch);
+
+/* SELECT, CSW and TAR shadowing helpers, used to skip writes that wouldn't change anything */
+bool adiv5_dp_select_current(const adiv5_debug_port_s *dp, uint32_t select);
+bool adiv5_ap_shadow_valid(const adiv5_access_port_s *ap);
+void adiv5_ap_shadow_update(adiv5_access_port_s *ap, uint32_t csw, target_addr64_t tar);
+
 /* ADIv5 DP logical operation function for reading DPIDR safely */
 uint32_t adiv5_dp_read_dpidr(adiv5_debug_port_s *dp);
 
@@ -286,6 +331,7 @@ bool adiv5_swd_write_no_check(uint16_t addr, uint32_t data);
 uint32_t adiv5_swd_read_no_check(uint16_t addr);
 uint32_t adiv5_swd_read(adiv5_debug_port_s *dp, uint16_t addr);
 uint32_t adiv5_swd_raw_access(adiv5_debug_port_s *dp, uint8_t rnw, uint16_t addr, uint32_t value);
+void adiv5_swd_ap_read_block(adiv5_debug_port_s *dp, uint16_t addr, uint32_t *values, size_t count);
 uint32_t adiv5_swd_clear_error(adiv5_debug_port_s *dp, bool protocol_recovery);
 void adiv5_swd_abort(adiv5_debug_port_s *dp, uint32_t abort);
 
@@ -50,9 +50,32 @@ static inline uint32_t adiv5_read_no_check(adiv5_debug_port_s *const dp, const u
 	return result;
 }
 
+/* Make a note of what a DP access did to the state shadowed for the generic access routines */
+static inline void adiv5_dp_shadow_track(
+	adiv5_debug_port_s *const dp, const uint8_t rnw, const uint16_t addr, const uint32_t value)
+{
+	if (addr == ADIV5_DP_SELECT) {
+		if (rnw == ADIV5_LOW_WRITE) {
+			dp->select = value;
+			/* If the write faulted, there's no telling what SELECT now holds */
+			dp->select_valid = !dp->fault;
+		}
+	} else if ((addr & ADIV5_APnDP) && !(addr & 0x00f0U))
+		/* CSW, TAR and DRW (which moves TAR on) live in AP bank 0, so accessing them invalidates the AP shadows */
+		++dp->shadow_epoch;
+}
+
+/* Forget everything shadowed for this DP, used when a fault or abort leaves the DP and AP state uncertain */
+static inline void adiv5_dp_shadow_invalidate(adiv5_debug_port_s *const dp)
+{
+	dp->select_valid = false;
+	++dp->shadow_epoch;
+}
+
 static inline uint32_t adiv5_dp_read(adiv5_debug_port_s *const dp, const uint16_t addr)
 {
 	uint32_t ret = dp->dp_read(dp, addr);
+	adiv5_dp_shadow_track(dp, ADIV5_LOW_READ, addr, 0U);
 #ifndef DEBUG_PROTO_IS_NOOP
 	decode_access(addr, ADIV5_LOW_READ, 0U, 0U);
 	DEBUG_PROTO("0x%08" PRIx32 "\n", ret);
@@ -67,12 +90,14 @@ static inline void adiv5_dp_write(adiv5_debug_port_s *const dp, const uint16_t a
 	DEBUG_PROTO("0x%08" PRIx32 "\n", value);
 #endif
 	dp->low_access(dp, ADIV5_LOW_WRITE, addr, value);
+	adiv5_dp_shadow_track(dp, ADIV5_LOW_WRITE, addr, value);
 }
 
 static inline uint32_t adiv5_dp_low_access(
 	adiv5_debug_port_s *const dp, const uint8_t rnw, const uint16_t addr, const uint32_t value)
 {
 	uint32_t ret = dp->low_access(dp, rnw, addr, value);
+	adiv5_dp_shadow_track(dp, rnw, addr, value);
 #ifndef DEBUG_PROTO_IS_NOOP
 	decode_access(addr, rnw, 0U, value);
 	DEBUG_PROTO("0x%08" PRIx32 "\n", rnw ? ret : value);
@@ -83,14 +108,28 @@ static inline uint32_t adiv5_dp_low_access(
 static inline uint32_t adiv5_dp_error(adiv5_debug_port_s *const dp)
 {
 	uint32_t ret = dp->error(dp, false);
+	adiv5_dp_shadow_invalidate(dp);
 	DEBUG_PROTO("DP Error 0x%08" PRIx32 "\n", ret);
 	return ret;
 }
 
+/* Make sure any writes the probe still has in flight have had their say in the DP's fault state */
+static inline void adiv5_dp_posted_flush(adiv5_debug_port_s *const dp)
+{
+#if CONFIG_BMDA == 1
+	if (dp->posted_flush)
+		dp->posted_flush(dp);
+#else
+	(void)dp;
+#endif
+}
+
 static inline void adiv5_dp_abort(adiv5_debug_port_s *const dp, const uint32_t abort)
 {
+	adiv5_dp_posted_flush(dp);
 	DEBUG_PROTO("Abort: %08" PRIx32 "\n", abort);
 	dp->abort(dp, abort);
+	adiv5_dp_shadow_invalidate(dp);
 }
 
 static inline uint32_t adiv5_ap_read(adiv5_access_port_s *const ap, const uint16_t addr)
@@ -158,12 +197,15 @@ static inline uint32_t adiv5_dp_recoverable_access(adiv5_debug_port_s *dp, uint8
 		swd_proc.seq_in_parity(&response, 32);
 		DEBUG_WARN("Recovering and re-trying access\n");
 		dp->error(dp, true);
+		adiv5_dp_shadow_invalidate(dp);
 		response = dp->low_access(dp, rnw, addr, value);
 		/* If the access results in no-response again, throw to propergate that up */
 		if (dp->fault == SWD_ACK_NO_RESPONSE)
 			raise_exception(EXCEPTION_ERROR, "SWD invalid ACK");
+		adiv5_dp_shadow_track(dp, rnw, addr, value);
 		return response;
 	}
+	adiv5_dp_shadow_track(dp, rnw, addr, value);
 	return result;
 }
 
@@ -192,6 +192,7 @@
 
 typedef struct adiv5_access_port adiv5_access_port_s;
 typedef struct adiv5_debug_port adiv5_debug_port_s;
+typedef struct adiv5_batch adiv5_batch_s;
 
 struct adiv5_debug_port {
 	int refcnt;
@@ -202,18 +203,31 @@ struct adiv5_debug_port {
 	uint32_t (*dp_read)(adiv5_debug_port_s *dp, uint16_t addr);
 	uint32_t (*error)(adiv5_debug_port_s *dp, bool protocol_recovery);
 	uint32_t (*low_access)(adiv5_debug_port_s *dp, uint8_t RnW, uint16_t addr, uint32_t value);
+	/* Optional: read an AP register count times over, pipelining the reads where the protocol allows */
+	void (*ap_read_block)(adiv5_debug_port_s *dp, uint16_t addr, uint32_t *values, size_t count);
 	void (*abort)(adiv5_debug_port_s *dp, uint32_t abort);
 
 #if CONFIG_BMDA == 1
 	void (*ap_regs_read)(adiv5_access_port_s *ap, void *data);
 	uint32_t (*ap_reg_read)(adiv5_access_port_s *ap, uint8_t reg_num);
 	void (*ap_reg_write)(adiv5_access_port_s *ap, uint8_t num, uint32_t value);
+	/* Have the probe watch a memory word for (word & mask) == match, so the host need not poll it */
+	bool (*mem_watch_arm)(adiv5_access_port_s *ap, target_addr64_t addr, uint32_t mask, uint32_t match);
+	/* Check if a watch armed on this AP is still waiting to trigger */
+	bool (*mem_watch_pending)(adiv5_access_port_s *ap);
+	void (*mem_watch_disarm)(adiv5_debug_port_s *dp);
+	/* Have the probe calculate the CRC32 of a memory region rather than reading it all back */
+	bool (*mem_crc32)(adiv5_access_port_s *ap, uint32_t *result, target_addr_t base, size_t len);
+	/* Optional, collects the outcome of any writes still in flight so they're reflected in fault */
+	void (*posted_flush)(adiv5_debug_port_s *dp);
 #endif
 	uint32_t (*ap_read)(adiv5_access_port_s *ap, uint16_t addr);
 	void (*ap_write)(adiv5_access_port_s *ap, uint16_t addr, uint32_t value);
 
 	void (*mem_read)(adiv5_access_port_s *ap, void *dest, target_addr64_t src, size_t len);
 	void (*mem_write)(adiv5_access_port_s *ap, target_addr64_t dest, const void *src, size_t len, align_e align);
+	/* Run a batch of queued DP and AP accesses in as few exchanges with the probe as possible */
+	bool (*execute_batch)(const adiv5_batch_s *batch);
 	/* The index of the device on the JTAG scan chain or DP index on SWD */
 	uint8_t dev_index;
 	/* Whether a fault has occured, and which one */
@@ -236,6 +250,12 @@ struct adiv5_debug_port {
 
 	/* DPv3+ bus address width */
 	uint8_t address_width;
+
+	/* Shadow copy of the last value written to SELECT, see ADIV5_DP_SHADOWED */
+	bool select_valid;
+	uint32_t select;
+	/* Bumped whenever an AP's CSW or TAR may have changed behind its shadow copies */
+	uint32_t shadow_epoch;
 };
 
 struct adiv5_access_port {
@@ -253,6 +273,12 @@ struct adiv5_access_port {
 	/* AP designer and partno */
 	uint16_t designer_code;
 	uint16_t partno;
+
+	/* Shadow copies of CSW and TAR from the last memory access, only valid while shadow_epoch matches the DP's */
+	bool shadow_valid;
+	uint32_t shadow_epoch;
+	uint32_t shadow_csw;
+	target_addr64_t shadow_tar;
 };
 
 /* The following enum is based on the Component Class value table 13-3 of the ADIv5 specification. */
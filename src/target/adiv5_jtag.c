@@ -108,6 +108,7 @@ uint32_t adiv5_jtag_read(adiv5_debug_port_s *dp, uint16_t addr)
 uint32_t adiv5_jtag_clear_error(adiv5_debug_port_s *dp, const bool protocol_recovery)
 {
 	(void)protocol_recovery;
+	adiv5_dp_posted_flush(dp);
 	const uint32_t status = adiv5_dp_read(dp, ADIV5_DP_CTRLSTAT) & ADIV5_DP_CTRLSTAT_ERRMASK;
 	dp->fault = 0;
 	return adiv5_dp_low_access(dp, ADIV5_LOW_WRITE, ADIV5_DP_CTRLSTAT, status) & 0x32U;
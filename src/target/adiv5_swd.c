@@ -181,6 +181,9 @@ bool adiv5_swd_scan(const uint32_t targetid)
 		return false;
 	}
 #endif
+	/* Pipelined AP reads need us to be the ones driving the SWD transactions */
+	if (dp->low_access == adiv5_swd_raw_access)
+		dp->ap_read_block = adiv5_swd_ap_read_block;
 
 	platform_target_clk_output_enable(true);
 
@@ -350,6 +353,7 @@ uint32_t adiv5_swd_read(adiv5_debug_port_s *dp, uint16_t addr)
 
 uint32_t adiv5_swd_clear_error(adiv5_debug_port_s *const dp, const bool protocol_recovery)
 {
+	adiv5_dp_posted_flush(dp);
 	/* Only do the comms reset dance on DPv2+ w/ fault or to perform protocol recovery. */
 	if ((dp->version >= 2U && dp->fault) || protocol_recovery) {
 		/*
@@ -398,7 +402,8 @@ uint32_t adiv5_swd_clear_error(adiv5_debug_port_s *const dp, const bool protocol
 			ADIV5_DP_CTRLSTAT_WDATAERR);
 }
 
-uint32_t adiv5_swd_raw_access(adiv5_debug_port_s *dp, const uint8_t rnw, const uint16_t addr, const uint32_t value)
+static uint32_t adiv5_swd_transfer(adiv5_debug_port_s *const dp, const uint8_t rnw, const uint16_t addr,
+	const uint32_t value, const bool idle_after)
 {
 	if ((addr & ADIV5_APnDP) && dp->fault)
 		return 0;
@@ -461,13 +466,38 @@ uint32_t adiv5_swd_raw_access(adiv5_debug_port_s *dp, const uint8_t rnw, const u
 	 * - or clock at least 8 idle cycles
 	 *
 	 * Implement last option to favour correctness over
-	 *   slight speed decrease
+	 *   slight speed decrease, unless the caller is about to start another transaction
 	 */
-	swd_proc.seq_out(0, 8U);
+	if (idle_after)
+		swd_proc.seq_out(0, 8U);
 
 	return response;
 }
 
+uint32_t adiv5_swd_raw_access(adiv5_debug_port_s *dp, const uint8_t rnw, const uint16_t addr, const uint32_t value)
+{
+	return adiv5_swd_transfer(dp, rnw, addr, value, true);
+}
+
+/*
+ * Read an AP register count times over. AP reads are posted on SWD and return the result of the previous
+ * AP read, so rather than follow every read with a RDBUFF read as adiv5_swd_read() must, issue the reads
+ * back to back, keeping the results as they come out of the pipeline, and pick up the last with one RDBUFF read.
+ */
+void adiv5_swd_ap_read_block(
+	adiv5_debug_port_s *const dp, const uint16_t addr, uint32_t *const values, const size_t count)
+{
+	if (!count)
+		return;
+	/* The first read just primes the pipeline, its result is whatever the last AP read was */
+	adiv5_dp_recoverable_access(dp, ADIV5_LOW_READ, addr, 0U);
+	for (size_t idx = 1U; idx < count; ++idx) {
+		values[idx - 1U] = adiv5_swd_transfer(dp, ADIV5_LOW_READ, addr, 0U, false);
+		adiv5_dp_shadow_track(dp, ADIV5_LOW_READ, addr, 0U);
+	}
+	values[count - 1U] = adiv5_dp_low_access(dp, ADIV5_LOW_READ, ADIV5_DP_RDBUFF, 0U);
+}
+
 void adiv5_swd_abort(adiv5_debug_port_s *dp, uint32_t abort)
 {
 	adiv5_dp_write(dp, ADIV5_DP_ABORT, abort);
@@ -69,6 +69,8 @@ bool adiv6_dp_init(adiv5_debug_port_s *const dp)
 {
 	dp->ap_read = adiv6_ap_reg_read;
 	dp->ap_write = adiv6_ap_reg_write;
+	/* The shadowing only knows about ADIv5 SELECT, so turn it off for ADIv6 */
+	dp->quirks &= ~ADIV5_DP_SHADOWED;
 #if CONFIG_BMDA == 1
 	bmda_adiv6_dp_init(dp);
 #endif
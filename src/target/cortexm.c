@@ -65,11 +65,15 @@ static void cortexm_regs_write(target_s *target, const void *data);
 static uint32_t cortexm_pc_read(target_s *target);
 static size_t cortexm_reg_read(target_s *target, uint32_t reg, void *data, size_t max);
 static size_t cortexm_reg_write(target_s *target, uint32_t reg, const void *data, size_t max);
+static void cortexm_regs_flush(target_s *target);
 
 static void cortexm_reset(target_s *target);
 static target_halt_reason_e cortexm_halt_poll(target_s *target, target_addr64_t *watch);
 static void cortexm_halt_request(target_s *target);
 static int cortexm_fault_unwind(target_s *target);
+#if CONFIG_BMDA == 1
+static void cortexm_halt_watch_disarm(target_s *target);
+#endif
 
 static int cortexm_breakwatch_set(target_s *target, breakwatch_s *breakwatch);
 static int cortexm_breakwatch_clear(target_s *target, breakwatch_s *breakwatch);
@@ -87,8 +91,28 @@ typedef struct cortexm_priv {
 	uint8_t flash_patch_revision;
 	/* Copy of DEMCR for vector-catch */
 	uint32_t demcr;
+	/*
+	 * Register file cache, indexed by GDB register number. Entries are fetched on demand while the
+	 * core is halted, writes are held back until just before the core is resumed
+	 */
+	uint64_t regs_valid;
+	uint64_t regs_dirty;
+	uint32_t regs[CORTEXM_MAX_REG_COUNT];
 } cortexm_priv_s;
 
+static_assert(CORTEXM_MAX_REG_COUNT <= 64U, "Cortex-M register cache masks too small for the register file");
+
+static inline void cortexm_regs_invalidate(cortexm_priv_s *const priv)
+{
+	priv->regs_valid = 0U;
+	priv->regs_dirty = 0U;
+}
+
+static void cortexm_target_regs_invalidate(target_s *const target)
+{
+	cortexm_regs_invalidate(target->priv);
+}
+
 /* Register number tables */
 static const uint8_t regnum_cortex_m[CORTEXM_GENERAL_REG_COUNT] = {
 	0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 9U, 10U, 11U, 12U, 13U, 14U, 15U, /* r0-r15 */
@@ -233,6 +257,16 @@ static void cortexm_mem_write(target_s *target, target_addr64_t dest, const void
 	adiv5_mem_write(cortex_ap(target), dest, src, len);
 }
 
+#if CONFIG_BMDA == 1
+static bool cortexm_mem_crc32(target_s *const target, uint32_t *const result, const target_addr_t base, const size_t len)
+{
+	/* Make sure the probe sees what the core does, same as for a normal read */
+	cortexm_cache_clean(target, base, len, false);
+	adiv5_access_port_s *const ap = cortex_ap(target);
+	return ap->dp->mem_crc32(ap, result, base, len);
+}
+#endif
+
 bool target_is_cortexm(const target_s *target)
 {
 	return target != NULL && target->regs_description == cortexm_target_description;
@@ -251,133 +285,123 @@ void cortexm_demcr_write(target_s *target, uint32_t demcr)
 	target_mem32_write32(target, CORTEXM_DEMCR, demcr);
 }
 
-bool cortexm_probe(adiv5_access_port_s *ap)
-{
-	target_s *target = target_new();
-	if (!target)
-		return false;
-
-	adiv5_ap_ref(ap);
-	if (ap->dp->version >= 2 && ap->dp->target_designer_code != 0) {
-		/* Use TARGETID register to identify target */
-		target->designer_code = ap->dp->target_designer_code;
-		target->part_id = ap->dp->target_partno;
-	} else {
-		/* Use AP DESIGNER and AP PARTNO to identify target */
-		target->designer_code = ap->designer_code;
-		target->part_id = ap->partno;
-	}
-
-	/* MM32F5xxx: part designer code is Arm China, target designer code uses forbidden continuation code */
-	if (target->designer_code == JEP106_MANUFACTURER_ERRATA_ARM_CHINA &&
-		ap->dp->designer_code == JEP106_MANUFACTURER_ARM_CHINA)
-		target->designer_code = JEP106_MANUFACTURER_ARM_CHINA;
-
-	cortexm_priv_s *priv = calloc(1, sizeof(*priv));
-	if (!priv) { /* calloc failed: heap exhaustion */
-		DEBUG_ERROR("calloc: failed in %s\n", __func__);
-		return false;
-	}
-
-	target->priv = priv;
-	target->priv_free = cortex_priv_free;
-	priv->base.ap = ap;
-	priv->base.base_addr = CORTEXM_SCS_BASE;
-
-	target->check_error = cortex_check_error;
-	target->mem_read = cortexm_mem_read;
-	target->mem_write = cortexm_mem_write;
-
-	target->driver = "ARM Cortex-M";
-
-	cortex_read_cpuid(target);
-
-	target->attach = cortexm_attach;
-	target->detach = cortexm_detach;
-
-	/* Probe for the security extension if the core is not an ARMv6-M core */
-	if (!(target->target_options & CORTEXM_TOPT_FLAVOUR_V6M) &&
-		target_mem32_read32(target, CORTEXM_ID_PFR1) & CORTEXM_ID_PFR1_SECEXT_IMPL)
-		target->target_options |= CORTEXM_TOPT_TRUSTZONE;
-
-	/* Probe for FP extension. */
-	uint32_t cpacr = target_mem32_read32(target, CORTEXM_CPACR);
-	cpacr |= 0x00f00000U; /* CP10 = 0b11, CP11 = 0b11 */
-	target_mem32_write32(target, CORTEXM_CPACR, cpacr);
-	bool is_cortexmf = target_mem32_read32(target, CORTEXM_CPACR) == cpacr;
-
-	target->regs_description = cortexm_target_description;
-	target->regs_read = cortexm_regs_read;
-	target->regs_write = cortexm_regs_write;
-	target->reg_read = cortexm_reg_read;
-	target->reg_write = cortexm_reg_write;
-
-	target->reset = cortexm_reset;
-	target->halt_request = cortexm_halt_request;
-	target->halt_poll = cortexm_halt_poll;
-	target->halt_resume = cortexm_halt_resume;
-	target->regs_size = sizeof(uint32_t) * CORTEXM_GENERAL_REG_COUNT;
-
-	/* Adjust the regs_size value for TrustZone */
-	if (target->target_options & CORTEXM_TOPT_TRUSTZONE)
-		target->regs_size += sizeof(uint32_t) * CORTEXM_TRUSTZONE_REG_COUNT;
-
-	/* Adjust the regs_size value for having a FPU */
-	if (is_cortexmf) {
-		target->target_options |= CORTEXM_TOPT_FLAVOUR_FLOAT;
-		target->regs_size += sizeof(uint32_t) * CORTEX_FLOAT_REG_COUNT;
-	}
-
-	target->breakwatch_set = cortexm_breakwatch_set;
-	target->breakwatch_clear = cortexm_breakwatch_clear;
-
-	target_add_commands(target, cortexm_cmd_list, target->driver);
-
-	/* Default vectors to catch */
-	priv->demcr = CORTEXM_DEMCR_TRCENA | CORTEXM_DEMCR_VC_HARDERR | CORTEXM_DEMCR_VC_CORERESET;
-
-	/*
-	 * Some devices, such as the STM32F0, will not correctly respond to probes under reset.
-	 * Therefore, if we're attempting to connect under reset, we should first write to
-	 * the debug register to catch the reset vector so that we immediately halt when reset
-	 * is released, then request a halt and release reset. This will prevent any user code
-	 * from running on the target.
-	 */
-	bool conn_reset = false;
-	if (platform_nrst_get_val()) {
-		conn_reset = true;
+/*
+ * Parts whose designer code and part ID are enough to tell which drivers can handle them, so we can
+ * skip straight to those rather than have every driver for the designer poke at the part in turn.
+ * Parts not listed here, or which none of the listed drivers claim, go through the full probe sequence.
+ */
+typedef bool (*cortexm_probe_func)(target_s *target);
+
+typedef struct cortexm_probe_index {
+	uint16_t designer_code;
+	uint16_t part_id;
+	cortexm_probe_func probes[2];
+} cortexm_probe_index_s;
+
+static const cortexm_probe_index_s cortexm_probe_index[] = {
+	/* STM32F0, F1 and F3 */
+	{JEP106_MANUFACTURER_STM, 0x410U, {stm32f1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x412U, {stm32f1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x414U, {stm32f1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x418U, {stm32f1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x420U, {stm32f1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x422U, {stm32f1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x428U, {stm32f1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x430U, {stm32f1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x432U, {stm32f1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x438U, {stm32f1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x439U, {stm32f1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x440U, {stm32f1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x442U, {stm32f1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x444U, {stm32f1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x445U, {stm32f1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x446U, {stm32f1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x448U, {stm32f1_probe}},
+	/* STM32F2, F4 and F7 */
+	{JEP106_MANUFACTURER_STM, 0x411U, {stm32f4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x413U, {stm32f4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x419U, {stm32f4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x421U, {stm32f4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x423U, {stm32f4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x431U, {stm32f4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x433U, {stm32f4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x434U, {stm32f4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x441U, {stm32f4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x449U, {stm32f4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x451U, {stm32f4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x452U, {stm32f4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x458U, {stm32f4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x463U, {stm32f4_probe}},
+	/* STM32H5 */
+	{JEP106_MANUFACTURER_STM, 0x474U, {stm32h5_probe}},
+	{JEP106_MANUFACTURER_STM, 0x484U, {stm32h5_probe}},
+	/* STM32H7, and the STM32MP15 Cortex-M4 which erroneously shares the H74x part ID */
+	{JEP106_MANUFACTURER_STM, 0x450U, {stm32h7_probe, stm32mp15_cm4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x480U, {stm32h7_probe}},
+	{JEP106_MANUFACTURER_STM, 0x483U, {stm32h7_probe}},
+	{JEP106_MANUFACTURER_STM, 0x500U, {stm32mp15_cm4_probe}},
+	/* STM32L0 */
+	{JEP106_MANUFACTURER_STM, 0x417U, {stm32l0_probe}},
+	{JEP106_MANUFACTURER_STM, 0x425U, {stm32l0_probe}},
+	{JEP106_MANUFACTURER_STM, 0x447U, {stm32l0_probe}},
+	{JEP106_MANUFACTURER_STM, 0x457U, {stm32l0_probe}},
+	/* STM32L1 */
+	{JEP106_MANUFACTURER_STM, 0x416U, {stm32l1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x427U, {stm32l1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x429U, {stm32l1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x436U, {stm32l1_probe}},
+	{JEP106_MANUFACTURER_STM, 0x437U, {stm32l1_probe}},
+	/* STM32L4, L5, G4, U5, WB and WL */
+	{JEP106_MANUFACTURER_STM, 0x415U, {stm32l4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x435U, {stm32l4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x455U, {stm32l4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x461U, {stm32l4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x462U, {stm32l4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x464U, {stm32l4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x468U, {stm32l4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x469U, {stm32l4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x470U, {stm32l4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x471U, {stm32l4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x472U, {stm32l4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x476U, {stm32l4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x479U, {stm32l4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x481U, {stm32l4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x482U, {stm32l4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x494U, {stm32l4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x495U, {stm32l4_probe}},
+	{JEP106_MANUFACTURER_STM, 0x497U, {stm32l4_probe}},
+	/* STM32G0 and C0 */
+	{JEP106_MANUFACTURER_STM, 0x456U, {stm32g0_probe}},
+	{JEP106_MANUFACTURER_STM, 0x460U, {stm32g0_probe}},
+	{JEP106_MANUFACTURER_STM, 0x466U, {stm32g0_probe}},
+	{JEP106_MANUFACTURER_STM, 0x467U, {stm32g0_probe}},
+	/* STM32WB0 */
+	{JEP106_MANUFACTURER_STM, 0x01eU, {stm32wb0_probe}},
+};
 
-		/* Request halt when reset is de-asseted */
-		target_mem32_write32(target, CORTEXM_DEMCR, priv->demcr);
-		/* Force a halt */
-		cortexm_halt_request(target);
-		/* Release reset */
-		platform_nrst_set_val(false);
-		/* Poll for release from reset */
-		platform_timeout_s timeout;
-		platform_timeout_set(&timeout, 1000);
-		while (target_mem32_read32(target, CORTEXM_DHCSR) & CORTEXM_DHCSR_S_RESET_ST) {
-			if (platform_timeout_is_expired(&timeout)) {
-				DEBUG_ERROR("Error releasing from reset\n");
-				/* Go on and try to detect the target anyways */
-				break;
-			}
+/* Try the drivers listed in the probe index for this part, returning true if one of them claimed it */
+static bool cortexm_probe_indexed(target_s *const target)
+{
+	for (size_t idx = 0U; idx < ARRAY_LENGTH(cortexm_probe_index); ++idx) {
+		const cortexm_probe_index_s *const entry = &cortexm_probe_index[idx];
+		if (entry->designer_code != target->designer_code || entry->part_id != target->part_id)
+			continue;
+		for (size_t probe = 0U; probe < ARRAY_LENGTH(entry->probes) && entry->probes[probe]; ++probe) {
+			if (entry->probes[probe](target))
+				return true;
+			target_check_error(target);
 		}
+		DEBUG_TARGET("%s: No indexed driver claimed the part, falling back to the full probe sequence\n", __func__);
+		break;
 	}
+	return false;
+}
 
-	/* Check cache type */
-	const uint32_t cache_type = target_mem32_read32(target, CORTEXM_CTR);
-	if (cache_type >> CORTEX_CTR_FORMAT_SHIFT == CORTEX_CTR_FORMAT_ARMv7) {
-		priv->base.icache_line_length = CORTEX_CTR_ICACHE_LINE(cache_type);
-		priv->base.dcache_line_length = CORTEX_CTR_DCACHE_LINE(cache_type);
-	} else
-		target_check_error(target);
-
-	/* If we set the interrupt catch vector earlier, clear it. */
-	if (conn_reset)
-		target_mem32_write32(target, CORTEXM_DEMCR, 0);
-
-	DEBUG_TARGET("%s: Examining Part ID 0x%04x, AP Part ID: 0x%04x\n", __func__, target->part_id, ap->partno);
+/* Run the part through the drivers that might handle it, returning true if one of them claimed it */
+static bool cortexm_probe_drivers(target_s *const target)
+{
+	if (cortexm_probe_indexed(target))
+		return true;
 
 	switch (target->designer_code) {
 	case JEP106_MANUFACTURER_FREESCALE:
@@ -503,12 +527,154 @@ bool cortexm_probe(adiv5_access_port_s *ap)
 		PROBE(lpc11xx_probe); /* LPC1343 */
 		break;
 	}
+	return false;
+}
+
+bool cortexm_probe(adiv5_access_port_s *ap)
+{
+	target_s *target = target_new();
+	if (!target)
+		return false;
+
+	adiv5_ap_ref(ap);
+	if (ap->dp->version >= 2 && ap->dp->target_designer_code != 0) {
+		/* Use TARGETID register to identify target */
+		target->designer_code = ap->dp->target_designer_code;
+		target->part_id = ap->dp->target_partno;
+	} else {
+		/* Use AP DESIGNER and AP PARTNO to identify target */
+		target->designer_code = ap->designer_code;
+		target->part_id = ap->partno;
+	}
+
+	/* MM32F5xxx: part designer code is Arm China, target designer code uses forbidden continuation code */
+	if (target->designer_code == JEP106_MANUFACTURER_ERRATA_ARM_CHINA &&
+		ap->dp->designer_code == JEP106_MANUFACTURER_ARM_CHINA)
+		target->designer_code = JEP106_MANUFACTURER_ARM_CHINA;
+
+	cortexm_priv_s *priv = calloc(1, sizeof(*priv));
+	if (!priv) { /* calloc failed: heap exhaustion */
+		DEBUG_ERROR("calloc: failed in %s\n", __func__);
+		return false;
+	}
+
+	target->priv = priv;
+	target->priv_free = cortex_priv_free;
+	priv->base.ap = ap;
+	priv->base.base_addr = CORTEXM_SCS_BASE;
+
+	target->check_error = cortex_check_error;
+	target->mem_read = cortexm_mem_read;
+	target->mem_write = cortexm_mem_write;
+#if CONFIG_BMDA == 1
+	/* If the probe can calculate CRCs itself, have it do that rather than reading everything back */
+	if (ap->dp->mem_crc32)
+		target->mem_crc32 = cortexm_mem_crc32;
+#endif
+
+	target->driver = "ARM Cortex-M";
+
+	cortex_read_cpuid(target);
+
+	target->attach = cortexm_attach;
+	target->detach = cortexm_detach;
+
+	/* Probe for the security extension if the core is not an ARMv6-M core */
+	if (!(target->target_options & CORTEXM_TOPT_FLAVOUR_V6M) &&
+		target_mem32_read32(target, CORTEXM_ID_PFR1) & CORTEXM_ID_PFR1_SECEXT_IMPL)
+		target->target_options |= CORTEXM_TOPT_TRUSTZONE;
+
+	/* Probe for FP extension. */
+	uint32_t cpacr = target_mem32_read32(target, CORTEXM_CPACR);
+	cpacr |= 0x00f00000U; /* CP10 = 0b11, CP11 = 0b11 */
+	target_mem32_write32(target, CORTEXM_CPACR, cpacr);
+	bool is_cortexmf = target_mem32_read32(target, CORTEXM_CPACR) == cpacr;
+
+	target->regs_description = cortexm_target_description;
+	target->regs_read = cortexm_regs_read;
+	target->regs_write = cortexm_regs_write;
+	target->reg_read = cortexm_reg_read;
+	target->reg_write = cortexm_reg_write;
+	target->regs_invalidate = cortexm_target_regs_invalidate;
+	target->regs_flush = cortexm_regs_flush;
+
+	target->reset = cortexm_reset;
+	target->halt_request = cortexm_halt_request;
+	target->halt_poll = cortexm_halt_poll;
+	target->halt_resume = cortexm_halt_resume;
+	target->regs_size = sizeof(uint32_t) * CORTEXM_GENERAL_REG_COUNT;
+
+	/* Adjust the regs_size value for TrustZone */
+	if (target->target_options & CORTEXM_TOPT_TRUSTZONE)
+		target->regs_size += sizeof(uint32_t) * CORTEXM_TRUSTZONE_REG_COUNT;
+
+	/* Adjust the regs_size value for having a FPU */
+	if (is_cortexmf) {
+		target->target_options |= CORTEXM_TOPT_FLAVOUR_FLOAT;
+		target->regs_size += sizeof(uint32_t) * CORTEX_FLOAT_REG_COUNT;
+	}
+
+	target->breakwatch_set = cortexm_breakwatch_set;
+	target->breakwatch_clear = cortexm_breakwatch_clear;
+
+	target_add_commands(target, cortexm_cmd_list, target->driver);
+
+	/* Default vectors to catch */
+	priv->demcr = CORTEXM_DEMCR_TRCENA | CORTEXM_DEMCR_VC_HARDERR | CORTEXM_DEMCR_VC_CORERESET;
+
+	/*
+	 * Some devices, such as the STM32F0, will not correctly respond to probes under reset.
+	 * Therefore, if we're attempting to connect under reset, we should first write to
+	 * the debug register to catch the reset vector so that we immediately halt when reset
+	 * is released, then request a halt and release reset. This will prevent any user code
+	 * from running on the target.
+	 */
+	bool conn_reset = false;
+	if (platform_nrst_get_val()) {
+		conn_reset = true;
+
+		/* Request halt when reset is de-asseted */
+		target_mem32_write32(target, CORTEXM_DEMCR, priv->demcr);
+		/* Force a halt */
+		cortexm_halt_request(target);
+		/* Release reset */
+		platform_nrst_set_val(false);
+		/* Poll for release from reset */
+		platform_timeout_s timeout;
+		platform_timeout_set(&timeout, 1000);
+		while (target_mem32_read32(target, CORTEXM_DHCSR) & CORTEXM_DHCSR_S_RESET_ST) {
+			if (platform_timeout_is_expired(&timeout)) {
+				DEBUG_ERROR("Error releasing from reset\n");
+				/* Go on and try to detect the target anyways */
+				break;
+			}
+		}
+	}
+
+	/* Check cache type */
+	const uint32_t cache_type = target_mem32_read32(target, CORTEXM_CTR);
+	if (cache_type >> CORTEX_CTR_FORMAT_SHIFT == CORTEX_CTR_FORMAT_ARMv7) {
+		priv->base.icache_line_length = CORTEX_CTR_ICACHE_LINE(cache_type);
+		priv->base.dcache_line_length = CORTEX_CTR_DCACHE_LINE(cache_type);
+	} else
+		target_check_error(target);
+
+	/* If we set the interrupt catch vector earlier, clear it. */
+	if (conn_reset)
+		target_mem32_write32(target, CORTEXM_DEMCR, 0);
+
+	DEBUG_TARGET("%s: Examining Part ID 0x%04x, AP Part ID: 0x%04x\n", __func__, target->part_id, ap->partno);
+
+	if (!cortexm_probe_drivers(target)) {
 #if CONFIG_BMDA == 0
-	gdb_outf("Please report unknown device with Designer 0x%x Part ID 0x%x\n", target->designer_code, target->part_id);
+		gdb_outf(
+			"Please report unknown device with Designer 0x%x Part ID 0x%x\n", target->designer_code, target->part_id);
 #else
-	DEBUG_WARN(
-		"Please report unknown device with Designer 0x%x Part ID 0x%x\n", target->designer_code, target->part_id);
+		DEBUG_WARN(
+			"Please report unknown device with Designer 0x%x Part ID 0x%x\n", target->designer_code, target->part_id);
 #endif
+	}
+	DEBUG_TARGET("%s: Probing took %" PRIu32 " memory reads\n", __func__, target->mem_reads);
 	return true;
 }
 
@@ -518,6 +684,7 @@ bool cortexm_attach(target_s *target)
 	/* Mark the DP as being in fault so error recovery will switch to this core when in multi-drop mode */
 	ap->dp->fault = 1;
 	cortexm_priv_s *priv = target->priv;
+	cortexm_regs_invalidate(priv);
 
 	/* Clear any pending fault condition (and switch to this core) */
 	target_check_error(target);
@@ -588,6 +755,10 @@ bool cortexm_attach(target_s *target)
 void cortexm_detach(target_s *target)
 {
 	cortexm_priv_s *priv = target->priv;
+#if CONFIG_BMDA == 1
+	/* Stop the probe watching for halts, the resume dance below would otherwise trip it */
+	cortexm_halt_watch_disarm(target);
+#endif
 
 	/* Clear any stale breakpoints */
 	for (size_t i = 0; i < priv->base.breakpoints_available; i++)
@@ -600,6 +771,9 @@ void cortexm_detach(target_s *target)
 	/* Restore DEMCR */
 	adiv5_access_port_s *ap = cortex_ap(target);
 	target_mem32_write32(target, CORTEXM_DEMCR, ap->ap_cortexm_demcr);
+	/* Write back any register changes that were made before the detach */
+	cortexm_regs_flush(target);
+	cortexm_regs_invalidate(priv);
 	/* Resume target and disable debug, re-enabling interrupts in the process */
 	target_mem32_write32(target, CORTEXM_DHCSR, CORTEXM_DHCSR_DBGKEY | CORTEXM_DHCSR_C_DEBUGEN | CORTEXM_DHCSR_C_HALT);
 	target_mem32_write32(target, CORTEXM_DHCSR, CORTEXM_DHCSR_DBGKEY | CORTEXM_DHCSR_C_DEBUGEN);
@@ -613,9 +787,8 @@ enum {
 	DB_DEMCR
 };
 
-static void cortexm_regs_read(target_s *const target, void *const data)
+static void cortexm_regs_fetch(target_s *const target, uint32_t *const regs)
 {
-	uint32_t *const regs = data;
 	adiv5_access_port_s *const ap = cortex_ap(target);
 #if CONFIG_BMDA == 1
 	if (ap->dp->ap_regs_read && ap->dp->ap_reg_read) {
@@ -639,35 +812,38 @@ static void cortexm_regs_read(target_s *const target, void *const data)
 		adi_ap_mem_access_setup(ap, CORTEXM_DHCSR, ALIGN_32BIT);
 		adi_ap_banked_access_setup(ap);
 
+		/* Queue up the DCRSR writes and DCRDR reads for every register so they go out together */
+		adiv5_batch_s batch;
+		adiv5_batch_init(&batch, ap->dp);
 		/* Walk the regnum_cortex_m array, reading the registers it specifies */
 		for (size_t i = 0U; i < CORTEXM_GENERAL_REG_COUNT; ++i) {
-			adiv5_dp_write(ap->dp, ADIV5_AP_DB(DB_DCRSR), regnum_cortex_m[i]);
-			regs[i] = adiv5_dp_read(ap->dp, ADIV5_AP_DB(DB_DCRDR));
+			adiv5_batch_dp_write(&batch, ADIV5_AP_DB(DB_DCRSR), regnum_cortex_m[i]);
+			adiv5_batch_dp_read(&batch, ADIV5_AP_DB(DB_DCRDR), &regs[i]);
 		}
 		size_t offset = CORTEXM_GENERAL_REG_COUNT;
 		/* If the core implements TrustZone, pull out the extra stack pointers */
 		if (target->target_options & CORTEXM_TOPT_TRUSTZONE) {
 			for (size_t i = 0U; i < CORTEXM_TRUSTZONE_REG_COUNT; ++i) {
-				adiv5_dp_write(ap->dp, ADIV5_AP_DB(DB_DCRSR), regnum_cortex_m_trustzone[i]);
-				regs[offset + i] = adiv5_dp_read(ap->dp, ADIV5_AP_DB(DB_DCRDR));
+				adiv5_batch_dp_write(&batch, ADIV5_AP_DB(DB_DCRSR), regnum_cortex_m_trustzone[i]);
+				adiv5_batch_dp_read(&batch, ADIV5_AP_DB(DB_DCRDR), &regs[offset + i]);
 			}
 			offset += CORTEXM_TRUSTZONE_REG_COUNT;
 		}
 		/* If the core has a FPU, also walk the regnum_cortex_mf array */
 		if (target->target_options & CORTEXM_TOPT_FLAVOUR_FLOAT) {
 			for (size_t i = 0U; i < CORTEX_FLOAT_REG_COUNT; ++i) {
-				adiv5_dp_write(ap->dp, ADIV5_AP_DB(DB_DCRSR), regnum_cortex_mf[i]);
-				regs[offset + i] = adiv5_dp_read(ap->dp, ADIV5_AP_DB(DB_DCRDR));
+				adiv5_batch_dp_write(&batch, ADIV5_AP_DB(DB_DCRSR), regnum_cortex_mf[i]);
+				adiv5_batch_dp_read(&batch, ADIV5_AP_DB(DB_DCRDR), &regs[offset + i]);
 			}
 		}
+		adiv5_batch_execute(&batch);
 #if CONFIG_BMDA == 1
 	}
 #endif
 }
 
-static void cortexm_regs_write(target_s *const target, const void *const data)
+static void cortexm_regs_store(target_s *const target, const uint32_t *const regs)
 {
-	const uint32_t *const regs = data;
 	adiv5_access_port_s *const ap = cortex_ap(target);
 #if CONFIG_BMDA == 1
 	if (ap->dp->ap_reg_write) {
@@ -739,44 +915,138 @@ static int dcrsr_regnum(target_s *target, uint32_t reg)
 	return -1;
 }
 
+static inline uint64_t cortexm_regs_mask(const target_s *const target)
+{
+	return (UINT64_C(1) << (target->regs_size / sizeof(uint32_t))) - 1U;
+}
+
+/* Write back any cached registers that have been modified since the core halted */
+static void cortexm_regs_flush(target_s *const target)
+{
+	cortexm_priv_s *const priv = target->priv;
+	if (!priv->regs_dirty)
+		return;
+	/* If the whole register file was replaced, write it back in one batch */
+	if (priv->regs_dirty == cortexm_regs_mask(target))
+		cortexm_regs_store(target, priv->regs);
+	else {
+		for (uint32_t reg = 0U; reg < target->regs_size / sizeof(uint32_t); ++reg) {
+			if (!(priv->regs_dirty & (UINT64_C(1) << reg)))
+				continue;
+			target_mem32_write32(target, CORTEXM_DCRDR, priv->regs[reg]);
+			target_mem32_write32(target, CORTEXM_DCRSR, CORTEXM_DCRSR_REGWnR | dcrsr_regnum(target, reg));
+		}
+	}
+	priv->regs_dirty = 0U;
+}
+
+static void cortexm_regs_read(target_s *const target, void *const data)
+{
+	cortexm_priv_s *const priv = target->priv;
+	const uint64_t regs_mask = cortexm_regs_mask(target);
+	/* If any part of the register file is not yet cached, fetch the whole thing in one go */
+	if ((priv->regs_valid & regs_mask) != regs_mask) {
+		uint32_t regs[CORTEXM_MAX_REG_COUNT];
+		cortexm_regs_fetch(target, regs);
+		/* Don't clobber any values that are still waiting to be written back */
+		for (size_t i = 0U; i < target->regs_size / sizeof(uint32_t); ++i) {
+			if (!(priv->regs_dirty & (UINT64_C(1) << i)))
+				priv->regs[i] = regs[i];
+		}
+		priv->regs_valid = regs_mask;
+	}
+	memcpy(data, priv->regs, target->regs_size);
+}
+
+static void cortexm_regs_write(target_s *const target, const void *const data)
+{
+	cortexm_priv_s *const priv = target->priv;
+	/* Replace the cached register file, deferring the write to the core until it is resumed */
+	memcpy(priv->regs, data, target->regs_size);
+	priv->regs_valid = cortexm_regs_mask(target);
+	priv->regs_dirty = priv->regs_valid;
+}
+
+static uint32_t cortexm_cached_reg_read(target_s *const target, const uint32_t reg)
+{
+	cortexm_priv_s *const priv = target->priv;
+	const uint64_t reg_bit = UINT64_C(1) << reg;
+	if (!(priv->regs_valid & reg_bit)) {
+		target_mem32_write32(target, CORTEXM_DCRSR, dcrsr_regnum(target, reg));
+		priv->regs[reg] = target_mem32_read32(target, CORTEXM_DCRDR);
+		priv->regs_valid |= reg_bit;
+	}
+	return priv->regs[reg];
+}
+
+static void cortexm_cached_reg_write(target_s *const target, const uint32_t reg, const uint32_t value)
+{
+	cortexm_priv_s *const priv = target->priv;
+	const uint64_t reg_bit = UINT64_C(1) << reg;
+	priv->regs[reg] = value;
+	priv->regs_valid |= reg_bit;
+	priv->regs_dirty |= reg_bit;
+}
+
 static size_t cortexm_reg_read(target_s *target, uint32_t reg, void *data, size_t max)
 {
-	if (max < 4U)
+	if (max < 4U || reg >= target->regs_size / sizeof(uint32_t))
 		return 0;
 	uint32_t *reg_value = data;
-	target_mem32_write32(target, CORTEXM_DCRSR, dcrsr_regnum(target, reg));
-	*reg_value = target_mem32_read32(target, CORTEXM_DCRDR);
+	*reg_value = cortexm_cached_reg_read(target, reg);
 	return 4U;
 }
 
 static size_t cortexm_reg_write(target_s *target, uint32_t reg, const void *data, size_t max)
 {
-	if (max < 4U)
+	if (max < 4U || reg >= target->regs_size / sizeof(uint32_t))
 		return 0;
 	const uint32_t *reg_value = data;
-	target_mem32_write32(target, CORTEXM_DCRDR, *reg_value);
-	target_mem32_write32(target, CORTEXM_DCRSR, CORTEXM_DCRSR_REGWnR | dcrsr_regnum(target, reg));
+	cortexm_cached_reg_write(target, reg, *reg_value);
 	return 4U;
 }
 
 static uint32_t cortexm_pc_read(target_s *target)
 {
-	target_mem32_write32(target, CORTEXM_DCRSR, 0x0f);
-	return target_mem32_read32(target, CORTEXM_DCRDR);
+	return cortexm_cached_reg_read(target, CORTEX_REG_PC);
 }
 
 static void cortexm_pc_write(target_s *target, const uint32_t val)
 {
-	target_mem32_write32(target, CORTEXM_DCRDR, val);
-	target_mem32_write32(target, CORTEXM_DCRSR, CORTEXM_DCRSR_REGWnR | 0x0fU);
+	cortexm_cached_reg_write(target, CORTEX_REG_PC, val);
 }
 
 /*
  * The following three routines implement target halt/resume
  * using the core debug registers in the NVIC.
  */
+#if CONFIG_BMDA == 1
+/*
+ * Hand watching DHCSR for the core halting off to the probe when it is able to do that for us.
+ * This is armed once as the core is set running, and disarmed again before anything else touches the core.
+ */
+static void cortexm_halt_watch_arm(target_s *const target)
+{
+	adiv5_access_port_s *const ap = cortex_ap(target);
+	if (ap->dp->mem_watch_arm)
+		ap->dp->mem_watch_arm(ap, CORTEXM_DHCSR, CORTEXM_DHCSR_S_HALT, CORTEXM_DHCSR_S_HALT);
+}
+
+static void cortexm_halt_watch_disarm(target_s *const target)
+{
+	adiv5_debug_port_s *const dp = cortex_ap(target)->dp;
+	if (dp->mem_watch_disarm)
+		dp->mem_watch_disarm(dp);
+}
+#endif
+
 static void cortexm_reset(target_s *const target)
 {
+#if CONFIG_BMDA == 1
+	cortexm_halt_watch_disarm(target);
+#endif
+	/* Any cached register state is about to become meaningless */
+	cortexm_regs_invalidate(target->priv);
 	/* Read DHCSR here to clear S_RESET_ST bit before reset */
 	target_mem32_read32(target, CORTEXM_DHCSR);
 	/* If the physical reset pin is not inhibited, use it */
@@ -821,6 +1091,9 @@ static void cortexm_reset(target_s *const target)
 
 static void cortexm_halt_request(target_s *target)
 {
+#if CONFIG_BMDA == 1
+	cortexm_halt_watch_disarm(target);
+#endif
 	TRY (EXCEPTION_TIMEOUT) {
 		target_mem32_write32(
 			target, CORTEXM_DHCSR, CORTEXM_DHCSR_DBGKEY | CORTEXM_DHCSR_C_HALT | CORTEXM_DHCSR_C_DEBUGEN);
@@ -834,6 +1107,13 @@ static void cortexm_halt_request(target_s *target)
 static target_halt_reason_e cortexm_halt_poll(target_s *target, target_addr64_t *watch)
 {
 	cortexm_priv_s *priv = target->priv;
+	adiv5_access_port_s *const ap = cortex_ap(target);
+
+#if CONFIG_BMDA == 1
+	/* If the probe is watching DHCSR for us, there's nothing to do until it says the core stopped */
+	if (ap->dp->mem_watch_pending && ap->dp->mem_watch_pending(ap))
+		return TARGET_HALT_RUNNING;
+#endif
 
 	volatile uint32_t dhcsr = 0;
 	TRY (EXCEPTION_ALL) {
@@ -847,20 +1127,27 @@ static target_halt_reason_e cortexm_halt_poll(target_s *target, target_addr64_t
 		return TARGET_HALT_ERROR;
 	case EXCEPTION_TIMEOUT:
 		/* Timeout isn't actually a problem and probably means target is in WFI */
+		cortexm_regs_invalidate(priv);
 		return TARGET_HALT_RUNNING;
 	}
 
-	/* Check that the core actually halted */
-	if (!(dhcsr & CORTEXM_DHCSR_S_HALT))
+	/* Check that the core actually halted, the register cache can't be trusted if it is running */
+	if (!(dhcsr & CORTEXM_DHCSR_S_HALT)) {
+		cortexm_regs_invalidate(priv);
 		return TARGET_HALT_RUNNING;
+	}
 
-	/* Read out the status register to determine why */
-	const uint32_t dfsr = target_mem32_read32(target, CORTEXM_DFSR);
+	/* Read out the status register to determine why, and check what caches are currently enabled */
+	uint32_t dfsr = 0U;
+	uint32_t ccr = 0U;
+	adiv5_batch_s batch;
+	adiv5_batch_init(&batch, ap->dp);
+	adiv5_batch_mem_read32(&batch, ap, CORTEXM_DFSR, &dfsr);
+	adiv5_batch_mem_read32(&batch, ap, CORTEXM_CCR, &ccr);
+	adiv5_batch_execute(&batch);
 	/* Write the same value back to clear the register */
 	target_mem32_write32(target, CORTEXM_DFSR, dfsr);
 
-	/* Check what caches are currently enabled */
-	const uint32_t ccr = target_mem32_read32(target, CORTEXM_CCR);
 	priv->dcache_enabled = ccr & CORTEXM_CCR_DCACHE_ENABLE;
 	priv->icache_enabled = ccr & CORTEXM_CCR_ICACHE_ENABLE;
 
@@ -900,6 +1187,9 @@ static target_halt_reason_e cortexm_halt_poll(target_s *target, target_addr64_t
 void cortexm_halt_resume(target_s *const target, const bool step)
 {
 	cortexm_priv_s *priv = target->priv;
+#if CONFIG_BMDA == 1
+	cortexm_halt_watch_disarm(target);
+#endif
 	/* Begin building the new DHCSR value to resume the core with */
 	uint32_t dhcsr = CORTEXM_DHCSR_DBGKEY | CORTEXM_DHCSR_C_DEBUGEN;
 
@@ -924,11 +1214,20 @@ void cortexm_halt_resume(target_s *const target, const bool step)
 			cortexm_pc_write(target, pc + 2U);
 	}
 
+	/* Write back any modified registers, the cache is no longer valid once the core runs */
+	cortexm_regs_flush(target);
+	cortexm_regs_invalidate(priv);
+
 	if (priv->base.icache_line_length)
 		target_mem32_write32(target, CORTEXM_ICIALLU, 0U);
 
 	/* Release C_HALT to resume the core in whichever mode is selected */
 	target_mem32_write32(target, CORTEXM_DHCSR, dhcsr);
+#if CONFIG_BMDA == 1
+	/* A single step halts again straight away, so only have the probe watch for free running halts */
+	if (!step)
+		cortexm_halt_watch_arm(target);
+#endif
 }
 
 static int cortexm_fault_unwind(target_s *target)
@@ -993,7 +1292,8 @@ static int cortexm_fault_unwind(target_s *target)
 	return 0;
 }
 
-bool cortexm_run_stub(target_s *target, uint32_t loadaddr, uint32_t r0, uint32_t r1, uint32_t r2, uint32_t r3)
+/* Set up the core to execute a stub at loadaddr with the given arguments, without starting it */
+bool cortexm_stub_setup(target_s *target, uint32_t loadaddr, uint32_t r0, uint32_t r1, uint32_t r2, uint32_t r3)
 {
 	uint32_t regs[CORTEXM_MAX_REG_COUNT] = {0};
 
@@ -1006,11 +1306,12 @@ bool cortexm_run_stub(target_s *target, uint32_t loadaddr, uint32_t r0, uint32_t
 	regs[19] = 0;
 
 	cortexm_regs_write(target, regs);
+	return !target_check_error(target);
+}
 
-	if (target_check_error(target))
-		return false;
-
-	/* Execute the stub */
+/* Run a stub set up by cortexm_stub_setup() to completion, returning the code from its bkpt */
+static bool cortexm_stub_execute(target_s *const target)
+{
 	target_halt_reason_e reason = TARGET_HALT_RUNNING;
 #if defined(PLATFORM_HAS_DEBUG)
 	uint32_t arm_regs_start[CORTEXM_MAX_REG_COUNT];
@@ -1050,6 +1351,96 @@ bool cortexm_run_stub(target_s *target, uint32_t loadaddr, uint32_t r0, uint32_t
 	return bkpt_instr & 0xffU;
 }
 
+bool cortexm_run_stub(target_s *target, uint32_t loadaddr, uint32_t r0, uint32_t r1, uint32_t r2, uint32_t r3)
+{
+	if (!cortexm_stub_setup(target, loadaddr, r0, r1, r2, r3))
+		return false;
+	return cortexm_stub_execute(target);
+}
+
+#if CONFIG_BMDA == 1
+static const uint16_t cortexm_crc32_stub[] = {
+#include "flashstub/crc32.stub"
+};
+
+/* The stub only stops on its final bkpt once it has worked through everything it was given */
+#define CORTEXM_CRC32_STUB_EXIT  (sizeof(cortexm_crc32_stub) - 2U)
+#define CORTEXM_CRC32_TABLE_SIZE (256U * sizeof(uint32_t))
+/* Room for the core to stack an exception frame (NMI or a fault) should one be taken while the stub runs */
+#define CORTEXM_CRC32_STACK_SIZE 64U
+/* Amount of memory handed to the stub per run, keeping it well inside cortexm_run_stub()'s timeout on slow clocks */
+#define CORTEXM_CRC32_BATCH_SIZE 0x20000U
+
+/*
+ * Calculate the CRC32 of each block_size block of [base, base + len) on the target itself using a RAM
+ * stub, rather than reading it all back over the debug link. The stub gets a stack of its own and runs
+ * with interrupts masked, and the RAM and core registers it uses are put back afterwards, so this can be
+ * used on a target that's only been attached to.
+ */
+bool cortexm_crc32_blocks(
+	target_s *const target, uint32_t *const crcs, const target_addr32_t base, const size_t len, const size_t block_size)
+{
+	const size_t block_count = (len + block_size - 1U) / block_size;
+	const size_t batch_blocks = MIN(MAX(CORTEXM_CRC32_BATCH_SIZE / block_size, 1U), block_count);
+	const size_t stub_length = ALIGN(sizeof(cortexm_crc32_stub), 4U);
+	const size_t data_length = ALIGN(stub_length + CORTEXM_CRC32_TABLE_SIZE + (batch_blocks * sizeof(uint32_t)), 8U);
+	const size_t ram_length = data_length + CORTEXM_CRC32_STACK_SIZE;
+
+	const target_ram_s *const ram = target_find_stub_ram(target, ram_length);
+	if (!ram) {
+		DEBUG_TARGET("%s: no RAM region large enough for a %zu byte CRC stub\n", __func__, ram_length);
+		return false;
+	}
+	const target_addr32_t stub_addr = ram->start;
+	const target_addr32_t table_addr = stub_addr + stub_length;
+	const target_addr32_t results_addr = table_addr + CORTEXM_CRC32_TABLE_SIZE;
+	const uint32_t stack_top = stub_addr + ram_length;
+	/* Run with PRIMASK set, as the target may only have been attached to with the application's interrupts enabled */
+	const uint32_t special = 1U;
+
+	uint8_t *const saved_ram = malloc(ram_length);
+	if (!saved_ram) { /* malloc failed: heap exhaustion */
+		DEBUG_ERROR("malloc: failed in %s\n", __func__);
+		return false;
+	}
+	uint32_t saved_regs[CORTEXM_MAX_REG_COUNT];
+	target_regs_read(target, saved_regs);
+	target_mem32_read(target, saved_ram, stub_addr, ram_length);
+
+	uint32_t table[256U];
+	for (uint32_t entry = 0U; entry < 256U; ++entry) {
+		uint32_t crc = entry << 24U;
+		for (size_t bit = 0U; bit < 8U; ++bit)
+			crc = (crc & 0x80000000U) ? (crc << 1U) ^ 0x04c11db7U : crc << 1U;
+		table[entry] = crc;
+	}
+	target_mem32_write(target, stub_addr, cortexm_crc32_stub, sizeof(cortexm_crc32_stub));
+	target_mem32_write(target, table_addr, table, sizeof(table));
+	bool result = !target_check_error(target);
+
+	for (size_t block = 0U; result && block < block_count; block += batch_blocks) {
+		const size_t count = MIN(batch_blocks, block_count - block);
+		const target_addr32_t start = base + (block * block_size);
+		const target_addr32_t end = MIN(start + (count * block_size), base + len);
+		if (!cortexm_stub_setup(target, stub_addr, start, end, block_size, table_addr)) {
+			result = false;
+			break;
+		}
+		cortexm_reg_write(target, CORTEX_REG_SP, &stack_top, sizeof(stack_top));
+		cortexm_reg_write(target, CORTEX_REG_MSP, &stack_top, sizeof(stack_top));
+		cortexm_reg_write(target, CORTEX_REG_SPECIAL, &special, sizeof(special));
+		cortexm_stub_execute(target);
+		result = cortexm_pc_read(target) == stub_addr + CORTEXM_CRC32_STUB_EXIT &&
+			!target_mem32_read(target, crcs + block, results_addr, count * sizeof(uint32_t));
+	}
+
+	target_mem32_write(target, stub_addr, saved_ram, ram_length);
+	target_regs_write(target, saved_regs);
+	free(saved_ram);
+	return result && !target_check_error(target);
+}
+#endif
+
 /*
  * The following routines implement hardware breakpoints and watchpoints.
  * The Flash Patch and Breakpoint (FPB) and Data Watch and Trace (DWT)
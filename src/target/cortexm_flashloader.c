@@ -0,0 +1,213 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * This file implements a generic double-buffered flash loader for Cortex-M targets.
+ *
+ * Rather than loading and running a stub for every block written, a resident stub is started once per
+ * write operation along with a control block and a ring of data buffers in target RAM. We fill the next
+ * free buffer over the debug link and publish a chunk descriptor for it while the stub programs the
+ * previous one using a driver-supplied routine, so the link and the Flash controller are busy at the
+ * same time. The target side of this lives in flashstub/flashloader.h.
+ *
+ * Control block layout, all 32-bit words:
+ * 0x00: write_idx   - count of chunks published by us
+ * 0x04: read_idx    - count of chunks completed by the stub
+ * 0x08: status      - 0, or the driver's error code if programming failed
+ * 0x0c: slot_mask   - number of buffer slots - 1
+ * 0x10: buffer_size - size of each buffer slot in bytes
+ * 0x14: buffers     - address of the first buffer slot
+ * 0x18: chunks      - {dest, length, param} descriptor for each slot, a length of 0 stops the stub
+ */
+
+#include "general.h"
+#include "target.h"
+#include "target_internal.h"
+#include "cortexm.h"
+#include "cortexm_flashloader.h"
+
+#define FLASHLOADER_WRITE_IDX    0x00U
+#define FLASHLOADER_READ_IDX     0x04U
+#define FLASHLOADER_STATUS       0x08U
+#define FLASHLOADER_CHUNKS       0x18U
+#define FLASHLOADER_CHUNK_SIZE   12U
+#define FLASHLOADER_CONTROL_SIZE (FLASHLOADER_CHUNKS + (CORTEXM_FLASHLOADER_SLOTS * FLASHLOADER_CHUNK_SIZE))
+
+/* How long the stub may go without completing a chunk before we consider it hung */
+#define FLASHLOADER_TIMEOUT_MS 5000U
+
+bool cortexm_flashloader_start(target_s *const target, cortexm_flashloader_s *const loader, const uint16_t *const stub,
+	const size_t stub_size, const size_t buffer_size)
+{
+	loader->running = false;
+	const size_t stub_length = ALIGN(stub_size, 4U);
+	const size_t length = stub_length + FLASHLOADER_CONTROL_SIZE + (buffer_size * CORTEXM_FLASHLOADER_SLOTS);
+	const target_ram_s *const ram = target_find_stub_ram(target, length);
+	if (!ram) {
+		DEBUG_TARGET("%s: no RAM region large enough for a %zu byte loader\n", __func__, length);
+		return false;
+	}
+
+	loader->stub_addr = ram->start;
+	loader->control_addr = ram->start + stub_length;
+	loader->buffers_addr = loader->control_addr + FLASHLOADER_CONTROL_SIZE;
+	loader->buffer_size = buffer_size;
+	loader->write_idx = 0U;
+	loader->read_idx = 0U;
+
+	const uint32_t control[6] = {
+		0U,
+		0U,
+		0U,
+		CORTEXM_FLASHLOADER_SLOTS - 1U,
+		buffer_size,
+		loader->buffers_addr,
+	};
+	target_mem32_write(target, loader->stub_addr, stub, stub_size);
+	target_mem32_write(target, loader->control_addr, control, sizeof(control));
+	if (!cortexm_stub_setup(target, loader->stub_addr, loader->control_addr, 0U, 0U, 0U))
+		return false;
+
+	DEBUG_TARGET("%s: loader at 0x%08" PRIx32 ", %u x %" PRIu32 " byte buffers at 0x%08" PRIx32 "\n", __func__,
+		loader->stub_addr, CORTEXM_FLASHLOADER_SLOTS, loader->buffer_size, loader->buffers_addr);
+	target_halt_resume(target, false);
+	loader->running = true;
+	return true;
+}
+
+/* Handle the stub having stopped, returning whether it did so cleanly */
+static bool cortexm_flashloader_stopped(
+	target_s *const target, cortexm_flashloader_s *const loader, const target_halt_reason_e reason)
+{
+	loader->running = false;
+	if (reason == TARGET_HALT_ERROR)
+		raise_exception(EXCEPTION_ERROR, "Target lost in flash loader");
+
+	const uint32_t status = target_mem32_read32(target, loader->control_addr + FLASHLOADER_STATUS);
+	if (reason != TARGET_HALT_BREAKPOINT || status) {
+		DEBUG_ERROR("Flash loader stopped (reason %d) with status 0x%08" PRIx32 "\n", reason, status);
+		return false;
+	}
+	return !target_check_error(target);
+}
+
+static bool cortexm_flashloader_timed_out(target_s *const target, cortexm_flashloader_s *const loader)
+{
+	DEBUG_ERROR("Flash loader hung after %" PRIu32 " chunks\n", loader->read_idx);
+	target_halt_request(target);
+	loader->running = false;
+	return false;
+}
+
+/* Wait for the stub to free up a buffer slot for us */
+static bool cortexm_flashloader_wait_slot(target_s *const target, cortexm_flashloader_s *const loader)
+{
+	platform_timeout_s timeout;
+	platform_timeout_set(&timeout, FLASHLOADER_TIMEOUT_MS);
+	while (loader->write_idx - loader->read_idx >= CORTEXM_FLASHLOADER_SLOTS) {
+		const uint32_t read_idx = target_mem32_read32(target, loader->control_addr + FLASHLOADER_READ_IDX);
+		if (target_check_error(target)) {
+			loader->running = false;
+			return false;
+		}
+		if (read_idx != loader->read_idx) {
+			loader->read_idx = read_idx;
+			platform_timeout_set(&timeout, FLASHLOADER_TIMEOUT_MS);
+			continue;
+		}
+		/*
+		 * No progress, so check the stub is still running. The stub only exits cleanly on the
+		 * terminating chunk which we've not queued yet, so any halt here is a failure.
+		 */
+		const target_halt_reason_e reason = target_halt_poll(target, NULL);
+		if (reason != TARGET_HALT_RUNNING) {
+			cortexm_flashloader_stopped(target, loader, reason);
+			return false;
+		}
+		if (platform_timeout_is_expired(&timeout))
+			return cortexm_flashloader_timed_out(target, loader);
+	}
+	return true;
+}
+
+/* Publish a chunk descriptor for the next slot, the data for which must already be in place */
+static void cortexm_flashloader_post(target_s *const target, cortexm_flashloader_s *const loader,
+	const target_addr32_t dest, const uint32_t length, const uint32_t param)
+{
+	const uint32_t slot = loader->write_idx & (CORTEXM_FLASHLOADER_SLOTS - 1U);
+	const uint32_t chunk[3] = {dest, length, param};
+	target_mem32_write(
+		target, loader->control_addr + FLASHLOADER_CHUNKS + (slot * FLASHLOADER_CHUNK_SIZE), chunk, sizeof(chunk));
+	/* Only once the descriptor is written may the stub see the new write index */
+	++loader->write_idx;
+	target_mem32_write32(target, loader->control_addr + FLASHLOADER_WRITE_IDX, loader->write_idx);
+}
+
+bool cortexm_flashloader_queue(target_s *const target, cortexm_flashloader_s *const loader, target_addr32_t dest,
+	const void *const src, size_t len, const uint32_t param)
+{
+	const uint8_t *data = (const uint8_t *)src;
+	while (len) {
+		if (!cortexm_flashloader_wait_slot(target, loader))
+			return false;
+
+		const uint32_t amount = MIN(len, loader->buffer_size);
+		const uint32_t slot = loader->write_idx & (CORTEXM_FLASHLOADER_SLOTS - 1U);
+		target_mem32_write(target, loader->buffers_addr + (slot * loader->buffer_size), data, amount);
+		cortexm_flashloader_post(target, loader, dest, amount, param);
+
+		dest += amount;
+		data += amount;
+		len -= amount;
+	}
+	return !target_check_error(target);
+}
+
+bool cortexm_flashloader_finish(target_s *const target, cortexm_flashloader_s *const loader)
+{
+	if (!loader->running)
+		return true;
+
+	/* Queue the terminating chunk and wait for the stub to drain the ring and exit */
+	if (!cortexm_flashloader_wait_slot(target, loader))
+		return false;
+	cortexm_flashloader_post(target, loader, 0U, 0U, 0U);
+
+	platform_timeout_s timeout;
+	platform_timeout_set(&timeout, FLASHLOADER_TIMEOUT_MS * CORTEXM_FLASHLOADER_SLOTS);
+	target_halt_reason_e reason = TARGET_HALT_RUNNING;
+	while (reason == TARGET_HALT_RUNNING) {
+		if (platform_timeout_is_expired(&timeout))
+			return cortexm_flashloader_timed_out(target, loader);
+		reason = target_halt_poll(target, NULL);
+	}
+	return cortexm_flashloader_stopped(target, loader, reason);
+}
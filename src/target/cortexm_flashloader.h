@@ -0,0 +1,58 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TARGET_CORTEXM_FLASHLOADER_H
+#define TARGET_CORTEXM_FLASHLOADER_H
+
+#include "target.h"
+#include "target_internal.h"
+
+/* Number of buffer slots in the loader's ring, must be a power of 2 */
+#define CORTEXM_FLASHLOADER_SLOTS 2U
+
+typedef struct cortexm_flashloader {
+	target_addr32_t stub_addr;
+	target_addr32_t control_addr;
+	target_addr32_t buffers_addr;
+	uint32_t buffer_size;
+	/* Local copies of the ring indices, write_idx is owned by us and read_idx by the stub */
+	uint32_t write_idx;
+	uint32_t read_idx;
+	bool running;
+} cortexm_flashloader_s;
+
+bool cortexm_flashloader_start(target_s *target, cortexm_flashloader_s *loader, const uint16_t *stub, size_t stub_size,
+	size_t buffer_size);
+bool cortexm_flashloader_queue(target_s *target, cortexm_flashloader_s *loader, target_addr32_t dest, const void *src,
+	size_t len, uint32_t param);
+bool cortexm_flashloader_finish(target_s *target, cortexm_flashloader_s *loader);
+
+#endif /* TARGET_CORTEXM_FLASHLOADER_H */
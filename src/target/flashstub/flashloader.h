@@ -0,0 +1,95 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TARGET_FLASHSTUB_FLASHLOADER_H
+#define TARGET_FLASHSTUB_FLASHLOADER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stub.h"
+
+/*
+ * Target side of the double-buffered flash loader, see cortexm_flashloader.c for the debugger side.
+ * The control block lives in target RAM just after the stub and must match the layout used there.
+ */
+
+typedef struct flashloader_chunk {
+	uint32_t dest;
+	uint32_t length;
+	uint32_t param;
+} flashloader_chunk_s;
+
+typedef struct flashloader_control {
+	volatile uint32_t write_idx;
+	volatile uint32_t read_idx;
+	volatile uint32_t status;
+	uint32_t slot_mask;
+	uint32_t buffer_size;
+	const uint8_t *buffers;
+	volatile flashloader_chunk_s chunks[];
+} flashloader_control_s;
+
+/* Program one chunk, returning 0 on success or a driver-specific non-zero error code */
+typedef uint32_t (*flashloader_program_func)(uint32_t dest, const void *src, uint32_t length, uint32_t param);
+
+/*
+ * Consume chunks from the ring as the debugger queues them, until either a zero length
+ * chunk asks us to stop or programming a chunk fails, then hand control back with a breakpoint.
+ * The program routine should be always_inline so the stub makes no function calls.
+ */
+static inline void __attribute__((always_inline))
+flashloader_run(flashloader_control_s *const control, const flashloader_program_func program)
+{
+	uint32_t read_idx = control->read_idx;
+	while (true) {
+		/* Wait for the debugger to fill the next slot */
+		while (control->write_idx == read_idx)
+			continue;
+
+		const uint32_t slot = read_idx & control->slot_mask;
+		const volatile flashloader_chunk_s *const chunk = &control->chunks[slot];
+		if (!chunk->length)
+			break;
+
+		const uint32_t status =
+			program(chunk->dest, control->buffers + (slot * control->buffer_size), chunk->length, chunk->param);
+		if (status) {
+			control->status = status;
+			break;
+		}
+		/* Hand the slot back to the debugger */
+		control->read_idx = ++read_idx;
+	}
+
+	stub_exit(0);
+}
+
+#endif /* TARGET_FLASHSTUB_FLASHLOADER_H */
@@ -0,0 +1,63 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include "flashloader.h"
+
+#define STM32F1_FLASH_SR(fpec) *((volatile uint32_t *)((fpec) + 0x0cU))
+#define STM32F1_FLASH_CR(fpec) *((volatile uint32_t *)((fpec) + 0x10U))
+
+#define STM32F1_FLASH_SR_BSY        (1U << 0U)
+#define STM32F1_FLASH_SR_ERROR_MASK 0x14U
+#define STM32F1_FLASH_CR_PG         (1U << 0U)
+
+/* Program one chunk a half-word at a time, the param being the base of the FPEC for the bank */
+static inline uint32_t __attribute__((always_inline))
+stm32f1_flash_program(const uint32_t dest, const void *const src, const uint32_t length, const uint32_t fpec)
+{
+	volatile uint16_t *flash = (volatile uint16_t *)dest;
+	const uint16_t *data = (const uint16_t *)src;
+
+	STM32F1_FLASH_CR(fpec) = STM32F1_FLASH_CR_PG;
+	for (uint32_t offset = 0; offset < length; offset += 2U) {
+		*flash++ = *data++;
+		while (STM32F1_FLASH_SR(fpec) & STM32F1_FLASH_SR_BSY)
+			continue;
+	}
+	STM32F1_FLASH_CR(fpec) = 0U;
+
+	return STM32F1_FLASH_SR(fpec) & STM32F1_FLASH_SR_ERROR_MASK;
+}
+
+void __attribute__((naked, section(".entry"))) stm32f1_flash_loader(flashloader_control_s *const control)
+{
+	flashloader_run(control, stm32f1_flash_program);
+}
@@ -187,7 +187,7 @@ static bool lpc546xx_cmd_erase_sector(target_s *t, int argc, const char **argv)
 	if (argc > 1) {
 		uint32_t sector_addr = strtoul(argv[1], NULL, 0);
 		sector_addr *= t->flash->blocksize;
-		return target_flash_erase(t, sector_addr, 1U);
+		return target_flash_erase(t, sector_addr, 1U) && target_flash_complete(t);
 	}
 	return true;
 }
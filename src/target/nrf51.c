@@ -121,6 +121,7 @@ static void nrf51_add_flash(target_s *t, uint32_t addr, size_t length, size_t er
 	f->prepare = nrf51_flash_prepare;
 	f->done = nrf51_flash_done;
 	f->erased = 0xff;
+	f->flags = TARGET_FLASH_ERASE_BLANKS;
 	target_add_flash(t, f);
 }
 
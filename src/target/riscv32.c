@@ -67,6 +67,7 @@ static size_t riscv32_reg_read(target_s *target, uint32_t reg, void *data, size_
 static size_t riscv32_reg_write(target_s *target, uint32_t reg, const void *data, size_t max);
 static void riscv32_regs_read(target_s *target, void *data);
 static void riscv32_regs_write(target_s *target, const void *data);
+static void riscv32_regs_invalidate(target_s *target);
 
 static int riscv32_breakwatch_set(target_s *target, breakwatch_s *breakwatch);
 static int riscv32_breakwatch_clear(target_s *target, breakwatch_s *breakwatch);
@@ -82,6 +83,7 @@ bool riscv32_probe(target_s *const target)
 	target->regs_write = riscv32_regs_write;
 	target->reg_write = riscv32_reg_write;
 	target->reg_read = riscv32_reg_read;
+	target->regs_invalidate = riscv32_regs_invalidate;
 	target->mem_read = riscv32_mem_read;
 	target->mem_write = riscv32_mem_write;
 
@@ -108,6 +110,32 @@ bool riscv32_probe(target_s *const target)
 	return false;
 }
 
+/* Read a GPR or the PC (by GDB register number), serving it from the hart register cache if possible */
+static bool riscv32_cached_reg_read(riscv_hart_s *const hart, const uint32_t reg, uint32_t *const value)
+{
+	const uint64_t reg_bit = UINT64_C(1) << reg;
+	if (!(hart->regs_valid & reg_bit)) {
+		const uint16_t csr = reg == RV_REG_CACHE_PC ? RV_DPC : RV_GPR_BASE + reg;
+		if (!riscv_csr_read(hart, csr, &hart->regs[reg]))
+			return false;
+		hart->regs_valid |= reg_bit;
+	}
+	*value = hart->regs[reg];
+	return true;
+}
+
+/* Update a GPR or the PC in the hart register cache, it gets written back when the hart is resumed */
+static void riscv32_cached_reg_write(riscv_hart_s *const hart, const uint32_t reg, const uint32_t value)
+{
+	/* x0 is hardwired to 0, so writes to it are discarded */
+	if (reg == 0U)
+		return;
+	const uint64_t reg_bit = UINT64_C(1) << reg;
+	hart->regs[reg] = value;
+	hart->regs_valid |= reg_bit;
+	hart->regs_dirty |= reg_bit;
+}
+
 static void riscv32_regs_read(target_s *const target, void *const data)
 {
 	/* Grab the hart structure and figure out how many registers need reading out */
@@ -117,10 +145,10 @@ static void riscv32_regs_read(target_s *const target, void *const data)
 	/* Loop through reading out the GPRs */
 	for (size_t gpr = 0; gpr < gprs_count; ++gpr) {
 		// TODO: handle when this fails..
-		riscv_csr_read(hart, RV_GPR_BASE + gpr, &regs[gpr]);
+		riscv32_cached_reg_read(hart, gpr, &regs[gpr]);
 	}
 	/* Special access to grab the program counter that would be executed on resuming the hart */
-	riscv_csr_read(hart, RV_DPC, &regs[gprs_count]);
+	riscv32_cached_reg_read(hart, RV_REG_CACHE_PC, &regs[gprs_count]);
 }
 
 static void riscv32_regs_write(target_s *const target, const void *const data)
@@ -130,12 +158,15 @@ static void riscv32_regs_write(target_s *const target, const void *const data)
 	const uint32_t *const regs = (const uint32_t *)data;
 	const size_t gprs_count = hart->extensions & RV_ISA_EXT_EMBEDDED ? 16U : 32U;
 	/* Loop through writing out the GPRs, except for the first which is always 0 */
-	for (size_t gpr = 1; gpr < gprs_count; ++gpr) {
-		// TODO: handle when this fails..
-		riscv_csr_write(hart, RV_GPR_BASE + gpr, &regs[gpr]);
-	}
-	/* Special access to poke in the program counter that will be executed on resuming the hart */
-	riscv_csr_write(hart, RV_DPC, &regs[gprs_count]);
+	for (size_t gpr = 1; gpr < gprs_count; ++gpr)
+		riscv32_cached_reg_write(hart, gpr, regs[gpr]);
+	/* Poke in the program counter that will be executed on resuming the hart */
+	riscv32_cached_reg_write(hart, RV_REG_CACHE_PC, regs[gprs_count]);
+}
+
+static void riscv32_regs_invalidate(target_s *const target)
+{
+	riscv_reg_cache_invalidate(riscv_hart_struct(target));
 }
 
 static inline size_t riscv32_bool_to_4(const bool ret)
@@ -150,10 +181,11 @@ static size_t riscv32_reg_read(target_s *target, const uint32_t reg, void *data,
 		return 0;
 	/* Grab the hart structure  */
 	riscv_hart_s *const hart = riscv_hart_struct(target);
-	if (reg < 32)
-		return riscv32_bool_to_4(riscv_csr_read(hart, RV_GPR_BASE + reg, data));
-	if (reg == 32)
-		return riscv32_bool_to_4(riscv_csr_read(hart, RV_DPC, data));
+	if (reg <= RV_REG_CACHE_PC)
+		return riscv32_bool_to_4(riscv32_cached_reg_read(hart, reg, data));
+	/* Make sure a direct dpc access sees any pending PC write */
+	if (!riscv_reg_cache_flush(hart))
+		return 0;
 	if (reg >= RV_CSR_GDB_OFFSET)
 		return riscv32_bool_to_4(riscv_csr_read(hart, reg - RV_CSR_GDB_OFFSET, data));
 	if (reg >= RV_FPU_GDB_OFFSET)
@@ -167,10 +199,16 @@ static size_t riscv32_reg_write(target_s *const target, const uint32_t reg, cons
 		return 0;
 	/* Grab the hart structure  */
 	riscv_hart_s *const hart = riscv_hart_struct(target);
-	if (reg < 32)
-		return riscv32_bool_to_4(riscv_csr_write(hart, RV_GPR_BASE + reg, data));
-	if (reg == 32)
-		return riscv32_bool_to_4(riscv_csr_write(hart, RV_DPC, data));
+	if (reg <= RV_REG_CACHE_PC) {
+		uint32_t value = 0U;
+		memcpy(&value, data, sizeof(value));
+		riscv32_cached_reg_write(hart, reg, value);
+		return 4U;
+	}
+	/* A direct dpc write would otherwise be overwritten by the cached PC, so flush and drop the cache */
+	if (!riscv_reg_cache_flush(hart))
+		return 0;
+	riscv_reg_cache_invalidate(hart);
 	if (reg >= RV_CSR_GDB_OFFSET)
 		return riscv32_bool_to_4(riscv_csr_write(hart, reg - RV_CSR_GDB_OFFSET, data));
 	if (reg >= RV_FPU_GDB_OFFSET)
@@ -961,6 +961,27 @@ static void riscv_hart_memory_access_type(target_s *const target)
 	(void)riscv_dm_write(hart->dbg_module, RV_DM_SYSBUS_CTRLSTATUS, 0x00407000U);
 }
 
+/* Write back any cached registers that have been modified since the hart halted */
+bool riscv_reg_cache_flush(riscv_hart_s *const hart)
+{
+	for (uint32_t reg = 0U; reg < RV_REG_CACHE_COUNT; ++reg) {
+		const uint64_t reg_bit = UINT64_C(1) << reg;
+		if (!(hart->regs_dirty & reg_bit))
+			continue;
+		const uint16_t csr = reg == RV_REG_CACHE_PC ? RV_DPC : RV_GPR_BASE + reg;
+		if (!riscv_csr_write(hart, csr, &hart->regs[reg]))
+			return false;
+		hart->regs_dirty &= ~reg_bit;
+	}
+	return true;
+}
+
+void riscv_reg_cache_invalidate(riscv_hart_s *const hart)
+{
+	hart->regs_valid = 0U;
+	hart->regs_dirty = 0U;
+}
+
 riscv_match_size_e riscv_breakwatch_match_size(const size_t size)
 {
 	switch (size) {
@@ -1015,6 +1036,7 @@ bool riscv_attach(target_s *const target)
 	/* We then also need to select the Hart again so we're poking with the right one on the target */
 	if (!riscv_dm_write(hart->dbg_module, RV_DM_CONTROL, hart->hartsel))
 		return false;
+	riscv_reg_cache_invalidate(hart);
 	/* We then need to halt the hart so the attach process can function */
 	riscv_halt_request(target);
 	return true;
@@ -1064,6 +1086,10 @@ static void riscv_halt_request(target_s *const target)
 static void riscv_halt_resume(target_s *target, const bool step)
 {
 	riscv_hart_s *const hart = riscv_hart_struct(target);
+	/* Write back any modified registers, the cache is no longer valid once the hart runs */
+	if (!riscv_reg_cache_flush(hart))
+		DEBUG_ERROR("Failed to write back cached registers before resuming\n");
+	riscv_reg_cache_invalidate(hart);
 	/* Configure the debug controller for single-stepping as appropriate */
 	uint32_t stepping_config = 0U;
 	if (!riscv_csr_read(hart, RV_DCSR | RV_CSR_FORCE_32_BIT, &stepping_config))
@@ -1094,9 +1120,11 @@ static target_halt_reason_e riscv_halt_poll(target_s *const target, target_addr6
 	/* Check if the hart is currently halted */
 	if (!riscv_dm_read(hart->dbg_module, RV_DM_STATUS, &status))
 		return TARGET_HALT_ERROR;
-	/* If the hart is currently running, exit out early */
-	if (!(status & RV_DM_STAT_ALL_HALTED))
+	/* If the hart is currently running, exit out early (and drop any cached register state) */
+	if (!(status & RV_DM_STAT_ALL_HALTED)) {
+		riscv_reg_cache_invalidate(hart);
 		return TARGET_HALT_RUNNING;
+	}
 	/* Read out DCSR to find out why we're halted */
 	if (!riscv_csr_read(hart, RV_DCSR, &status))
 		return TARGET_HALT_ERROR;
@@ -1119,6 +1147,8 @@ static target_halt_reason_e riscv_halt_poll(target_s *const target, target_addr6
 static void riscv_reset(target_s *const target)
 {
 	riscv_hart_s *const hart = riscv_hart_struct(target);
+	/* Any cached register state is about to become meaningless */
+	riscv_reg_cache_invalidate(hart);
 	bool has_reset = false;
 	/* If the target does not have the nRST pin inhibited, use that to initiate reset */
 	if (!(target->target_options & TOPT_INHIBIT_NRST)) {
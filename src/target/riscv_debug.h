@@ -133,6 +133,10 @@ typedef struct riscv_dm {
 
 #define RV_TRIGGERS_MAX 8U
 
+/* Number of registers held in the hart register cache: the 32 GPRs followed by the PC (dpc) */
+#define RV_REG_CACHE_COUNT 33U
+#define RV_REG_CACHE_PC    32U
+
 /* This represents a specific Hart on a DM */
 typedef struct riscv_hart {
 	riscv_dm_s *dbg_module;
@@ -154,6 +158,14 @@ typedef struct riscv_hart {
 
 	uint32_t triggers;
 	uint32_t trigger_uses[RV_TRIGGERS_MAX];
+
+	/*
+	 * Cache of the GPRs and PC, indexed by GDB register number. Entries are fetched on demand while
+	 * the hart is halted, writes are held back until just before the hart is resumed
+	 */
+	uint64_t regs_valid;
+	uint64_t regs_dirty;
+	uint32_t regs[RV_REG_CACHE_COUNT];
 } riscv_hart_s;
 
 #define RV_STATUS_VERSION_MASK 0x0000000fU
@@ -298,6 +310,8 @@ bool riscv_dm_write(riscv_dm_s *dbg_module, uint8_t address, uint32_t value);
 bool riscv_command_wait_complete(riscv_hart_s *hart);
 bool riscv_csr_read(riscv_hart_s *hart, uint16_t reg, void *data);
 bool riscv_csr_write(riscv_hart_s *hart, uint16_t reg, const void *data);
+bool riscv_reg_cache_flush(riscv_hart_s *hart);
+void riscv_reg_cache_invalidate(riscv_hart_s *hart);
 riscv_match_size_e riscv_breakwatch_match_size(size_t size);
 bool riscv_config_trigger(
 	riscv_hart_s *hart, uint32_t trigger, riscv_trigger_state_e mode, const void *config, const void *address);
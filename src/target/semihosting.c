@@ -178,7 +178,7 @@ static int32_t semihosting_get_gdb_response(target_controller_s *const tc)
 	/* Still have to service normal 'X'/'m'-packets */
 	while (true) {
 		/* Get back the next packet to process and have the main loop handle it */
-		const gdb_packet_s *const packet = gdb_packet_receive();
+		gdb_packet_s *const packet = gdb_packet_receive();
 		/* If this was an escape packet (or gdb_if reports link closed), fail the call */
 		if (packet->size == 1U && packet->data[0] == '\x04')
 			return -1;
@@ -52,6 +52,7 @@
 #include "target_internal.h"
 #include "adi.h"
 #include "cortexm.h"
+#include "cortexm_flashloader.h"
 #ifdef CONFIG_RISCV
 #include "riscv_debug.h"
 #endif
@@ -158,6 +159,7 @@
 
 typedef struct stm32f1_priv {
 	target_addr32_t dbgmcu_config_taddr;
+	cortexm_flashloader_s loader;
 } stm32f1_priv_s;
 
 static bool stm32f1_cmd_option(target_s *target, int argc, const char **argv);
@@ -173,8 +175,14 @@ static bool stm32f1_attach(target_s *target);
 static void stm32f1_detach(target_s *target);
 static bool stm32f1_flash_erase(target_flash_s *flash, target_addr_t addr, size_t len);
 static bool stm32f1_flash_write(target_flash_s *flash, target_addr_t dest, const void *src, size_t len);
+static bool stm32f1_flash_done(target_flash_s *flash);
+static flash_poll_e stm32f1_flash_poll(target_flash_s *flash);
 static bool stm32f1_mass_erase(target_s *target, platform_timeout_s *print_progess);
 
+static const uint16_t stm32f1_flash_loader_stub[] = {
+#include "flashstub/stm32f1.stub"
+};
+
 static void stm32f1_add_flash(target_s *target, uint32_t addr, size_t length, size_t erasesize)
 {
 	target_flash_s *flash = calloc(1, sizeof(*flash));
@@ -189,7 +197,16 @@ static void stm32f1_add_flash(target_s *target, uint32_t addr, size_t length, si
 	flash->writesize = 1024U;
 	flash->erase = stm32f1_flash_erase;
 	flash->write = stm32f1_flash_write;
+	flash->done = stm32f1_flash_done;
+	flash->poll = stm32f1_flash_poll;
 	flash->erased = 0xff;
+	/*
+	 * The second bank has its own controller, so its erases can be left running while the first bank
+	 * is programmed. Those of the first bank would only hold up the Flash loader, so are waited on
+	 */
+	flash->flags = TARGET_FLASH_ERASE_BLANKS;
+	if (addr == STM32F1_FLASH_BANK2_BASE)
+		flash->flags |= TARGET_FLASH_ASYNC_ERASE | TARGET_FLASH_CONCURRENT;
 	target_add_flash(target, flash);
 }
 
@@ -1109,10 +1126,40 @@ static bool stm32f1_flash_erase(target_flash_s *flash, target_addr_t addr, size_
 	/* Flash page erase start instruction */
 	target_mem32_write32(target, FLASH_CR + bank_offset, FLASH_CR_STRT | FLASH_CR_PER);
 
-	/* Wait for completion or an error */
+	/* Leave an asynchronous erase running for stm32f1_flash_poll() to report on, otherwise wait for it */
+	if (flash->flags & TARGET_FLASH_ASYNC_ERASE)
+		return !target_check_error(target);
 	return stm32f1_flash_busy_wait(target, bank_offset, NULL);
 }
 
+static flash_poll_e stm32f1_flash_bank_poll(target_s *const target, const uint32_t bank_offset)
+{
+	/* As in stm32f1_flash_busy_wait(), EOP is only meaningful as every erase clears it first */
+	const uint32_t status = target_mem32_read32(target, FLASH_SR + bank_offset);
+	if (target_check_error(target)) {
+		DEBUG_ERROR("Lost communications with target");
+		return FLASH_POLL_ERROR;
+	}
+	if (!(status & SR_EOP) && (status & FLASH_SR_BSY))
+		return FLASH_POLL_BUSY;
+	if (status & SR_ERROR_MASK) {
+		DEBUG_ERROR("stm32f1 flash error 0x%" PRIx32 "\n", status);
+		return FLASH_POLL_ERROR;
+	}
+	return FLASH_POLL_IDLE;
+}
+
+static flash_poll_e stm32f1_flash_poll(target_flash_s *const flash)
+{
+	target_s *const target = flash->t;
+	const flash_poll_e state = stm32f1_flash_bank_poll(target, stm32f1_bank_offset_for(flash->start));
+	/* If this Flash crosses into the second bank, the erase may have been there instead */
+	const uint32_t end_bank_offset = stm32f1_bank_offset_for(flash->start + flash->length - 1U);
+	if (state != FLASH_POLL_IDLE || end_bank_offset == stm32f1_bank_offset_for(flash->start))
+		return state;
+	return stm32f1_flash_bank_poll(target, end_bank_offset);
+}
+
 static size_t stm32f1_bank1_length(target_addr_t addr, size_t len)
 {
 	if (addr >= FLASH_BANK_SPLIT)
@@ -1122,12 +1169,51 @@ static size_t stm32f1_bank1_length(target_addr_t addr, size_t len)
 	return len;
 }
 
+/*
+ * Check if the resident flash loader can take this write, starting it if this is the first write of the operation.
+ * The loader programs in half-words, so is only used on Cortex-M parts without wider write support.
+ */
+static bool stm32f1_flash_loader_ready(target_flash_s *const flash)
+{
+	target_s *const target = flash->t;
+	stm32f1_priv_s *const priv = (stm32f1_priv_s *)target->target_storage;
+	if (priv->loader.running)
+		return true;
+	if ((target->target_options & STM32F1_TOPT_32BIT_WRITES) || !target_is_cortexm(target))
+		return false;
+	/* The loader reports any error flag set in a bank's status register, so clear out stale ones first */
+	stm32f1_flash_clear_eop(target, FLASH_BANK1_OFFSET);
+	if (stm32f1_is_dual_bank(target->part_id))
+		stm32f1_flash_clear_eop(target, FLASH_BANK2_OFFSET);
+	return cortexm_flashloader_start(
+		target, &priv->loader, stm32f1_flash_loader_stub, sizeof(stm32f1_flash_loader_stub), flash->writesize);
+}
+
+static bool stm32f1_flash_loader_write(
+	target_s *const target, const target_addr_t dest, const uint8_t *const src, const size_t len, const size_t offset)
+{
+	stm32f1_priv_s *const priv = (stm32f1_priv_s *)target->target_storage;
+	/* The loader takes the base of the bank's FPEC registers as its per-chunk parameter */
+	if (offset && !cortexm_flashloader_queue(target, &priv->loader, dest, src, offset, FPEC_BASE + FLASH_BANK1_OFFSET))
+		return false;
+
+	const size_t remainder = len - offset;
+	if (stm32f1_is_dual_bank(target->part_id) && remainder)
+		return cortexm_flashloader_queue(
+			target, &priv->loader, dest + offset, src + offset, remainder, FPEC_BASE + FLASH_BANK2_OFFSET);
+	return true;
+}
+
 static bool stm32f1_flash_write(target_flash_s *flash, target_addr_t dest, const void *src, size_t len)
 {
 	target_s *target = flash->t;
 	const size_t offset = stm32f1_bank1_length(dest, len);
 	DEBUG_TARGET("%s: at %08" PRIx32 " for %zu bytes\n", __func__, dest, len);
 
+	/* Where possible, hand the data to the flash loader so programming overlaps the transfer of the next block */
+	if (stm32f1_flash_loader_ready(flash))
+		return stm32f1_flash_loader_write(target, dest, src, len, offset);
+
 	/* Allow wider writes on Gigadevices and Arterytek */
 	const align_e psize = (target->target_options & STM32F1_TOPT_32BIT_WRITES) ? ALIGN_32BIT : ALIGN_16BIT;
 
@@ -1168,6 +1254,16 @@ static bool stm32f1_flash_write(target_flash_s *flash, target_addr_t dest, const
 	return true;
 }
 
+static bool stm32f1_flash_done(target_flash_s *const flash)
+{
+	/* The loader is shared by both banks, so leave it be when it's the other bank's erase that's finishing */
+	if (flash->operation != FLASH_OPERATION_WRITE)
+		return true;
+	stm32f1_priv_s *const priv = (stm32f1_priv_s *)flash->t->target_storage;
+	/* If the write operation used the flash loader, wait for it to program the last of the data */
+	return cortexm_flashloader_finish(flash->t, &priv->loader);
+}
+
 static bool stm32f1_mass_erase_bank(
 	target_s *const target, const uint32_t bank_offset, platform_timeout_s *const timeout)
 {
@@ -189,6 +189,7 @@ static void stm32f4_add_flash(target_s *const target, const uint32_t addr, const
 	target_flash->write = stm32f4_flash_write;
 	target_flash->writesize = 1024;
 	target_flash->erased = 0xffU;
+	target_flash->flags = TARGET_FLASH_ERASE_BLANKS;
 	flash->base_sector = base_sector;
 	flash->bank_split = split;
 	target_add_flash(target, target_flash);
@@ -331,8 +332,8 @@ bool gd32f4_probe(target_s *const target)
 	target->driver = stm32f4_get_chip_name(target->part_id);
 	target_add_commands(target, stm32f4_cmd_list, target->driver);
 
-	target_add_ram32(target, STM32F4_CCM_RAM_BASE, 0x10000);  /* 64 KiB CCM RAM */
-	target_add_ram32(target, STM32F4_AHB_SRAM_BASE, 0x50000); /* 320 KiB RAM */
+	target_add_data_ram32(target, STM32F4_CCM_RAM_BASE, 0x10000); /* 64 KiB CCM RAM */
+	target_add_ram32(target, STM32F4_AHB_SRAM_BASE, 0x50000);     /* 320 KiB RAM */
 
 	/* TODO implement DBS mode */
 	const uint8_t split = 12;
@@ -451,7 +452,7 @@ static bool stm32f4_attach(target_s *const target)
 		}
 		target_add_ram32(target, STM32F7_ITCM_RAM_BASE, 0x4000U); /* 16kiB ITCM RAM */
 		/* On STM32F7, DTCM and AHB SRAM are contiguous */
-		target_add_ram32(target, STM32F7_DTCM_RAM_BASE, dtcm_size);
+		target_add_data_ram32(target, STM32F7_DTCM_RAM_BASE, dtcm_size);
 		target_add_ram32(target, STM32F7_DTCM_RAM_BASE + dtcm_size, ahbsram_size);
 
 		if (dual_bank) {
@@ -460,7 +461,7 @@ static bool stm32f4_attach(target_s *const target)
 		}
 	} else {
 		if (has_ccm_ram)
-			target_add_ram32(target, STM32F4_CCM_RAM_BASE, 0x10000); /* 64 KiB CCM RAM */
+			target_add_data_ram32(target, STM32F4_CCM_RAM_BASE, 0x10000); /* 64 KiB CCM RAM, D-bus only */
 		/* F405/415, F407/417 have 112+16=128 KiB AHB SRAM */
 		uint32_t ram_size = 128U * 1024U;
 		/* F411, F446 also have a single chunk of 128 KiB AHB SRAM, so treat others specially */
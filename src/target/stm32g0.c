@@ -200,6 +200,9 @@ static void stm32g0_add_flash(target_s *target, uint32_t addr, size_t length, si
 	flash->write = stm32g0_flash_write;
 	flash->writesize = blocksize;
 	flash->erased = 0xffU;
+	/* The OTP area's erase is a no-op, so only the main Flash really gets blanked */
+	if (addr != FLASH_OTP_START)
+		flash->flags = TARGET_FLASH_ERASE_BLANKS;
 	target_add_flash(target, flash);
 }
 
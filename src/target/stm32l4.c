@@ -610,6 +610,7 @@ static void stm32l4_add_flash(target_s *const target, const uint32_t addr, const
 	target_flash->write = stm32l4_flash_write;
 	target_flash->writesize = 2048;
 	target_flash->erased = 0xffU;
+	target_flash->flags = TARGET_FLASH_ERASE_BLANKS;
 	flash->bank1_start = bank1_start;
 	target_add_flash(target, target_flash);
 }
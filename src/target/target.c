@@ -46,14 +46,194 @@ target_s *target_list = NULL;
 static bool target_cmd_mass_erase(target_s *target, int argc, const char **argv);
 static bool target_cmd_range_erase(target_s *target, int argc, const char **argv);
 static bool target_cmd_redirect_output(target_s *target, int argc, const char **argv);
+#ifdef TARGET_MEM_CACHE_LINES
+static bool target_cmd_cache(target_s *target, int argc, const char **argv);
+#endif
 
 const command_s target_cmd_list[] = {
 	{"erase_mass", target_cmd_mass_erase, "Erase whole device Flash"},
 	{"erase_range", target_cmd_range_erase, "Erase a range of memory on a device"},
 	{"redirect_stdout", target_cmd_redirect_output, "Redirect semihosting output to aux USB serial"},
+#ifdef TARGET_MEM_CACHE_LINES
+	{"cache", target_cmd_cache, "Memory read cache control: [stats|flush|enable|disable]"},
+#endif
 	{NULL, NULL, NULL},
 };
 
+#ifdef TARGET_MEM_CACHE_LINES
+typedef struct target_mem_cache_line {
+	target_addr64_t addr;
+	/* The line is only valid if this matches the cache's current epoch */
+	uint32_t epoch;
+	uint8_t data[TARGET_MEM_CACHE_LINE_SIZE];
+} target_mem_cache_line_s;
+
+struct target_mem_cache {
+	/* Whether the user has the cache turned on */
+	bool enabled;
+	/* Whether the target is halted such that the cache contents can be trusted */
+	bool active;
+	/* Bumping the epoch invalidates every line in one go */
+	uint32_t epoch;
+	/* Statistics */
+	uint32_t hits;
+	uint32_t misses;
+	uint32_t bypassed;
+	uint32_t invalidations;
+	target_mem_cache_line_s lines[TARGET_MEM_CACHE_LINES];
+};
+
+static target_mem_cache_s *target_mem_cache(target_s *const target)
+{
+	if (!target->mem_cache) {
+		target->mem_cache = calloc(1, sizeof(*target->mem_cache));
+		if (!target->mem_cache) { /* calloc failed: heap exhaustion */
+			DEBUG_ERROR("calloc: failed in %s\n", __func__);
+			return NULL;
+		}
+		target->mem_cache->enabled = true;
+		/* Start at epoch 1 so the zero-initialised lines are all invalid */
+		target->mem_cache->epoch = 1U;
+	}
+	return target->mem_cache;
+}
+
+void target_mem_cache_invalidate(target_s *const target)
+{
+	target_mem_cache_s *const cache = target->mem_cache;
+	if (!cache)
+		return;
+	++cache->epoch;
+	++cache->invalidations;
+}
+
+/* Mark the cache as usable (target halted) or not (target running, reset or detached) */
+static void target_mem_cache_set_active(target_s *const target, const bool active)
+{
+	/* Only bother allocating the cache when it's about to be used */
+	target_mem_cache_s *const cache = active ? target_mem_cache(target) : target->mem_cache;
+	if (!cache || cache->active == active)
+		return;
+	/* Every change in halt state starts a new epoch, discarding what was cached before */
+	target_mem_cache_invalidate(target);
+	cache->active = active;
+}
+
+static inline target_mem_cache_line_s *target_mem_cache_line(target_mem_cache_s *const cache, const target_addr64_t addr)
+{
+	return &cache->lines[(addr / TARGET_MEM_CACHE_LINE_SIZE) % TARGET_MEM_CACHE_LINES];
+}
+
+static inline bool target_mem_cache_hit(
+	const target_mem_cache_s *const cache, const target_mem_cache_line_s *const line, const target_addr64_t addr)
+{
+	return line->epoch == cache->epoch && line->addr == addr;
+}
+
+/* Check if the given range lies entirely within one of the target's RAM or Flash regions */
+static bool target_mem_cache_cacheable(target_s *const target, const target_addr64_t start, const target_addr64_t end)
+{
+	for (const target_ram_s *ram = target->ram; ram; ram = ram->next) {
+		if (start >= ram->start && end <= (target_addr64_t)ram->start + ram->length)
+			return true;
+	}
+	for (const target_flash_s *flash = target->flash; flash; flash = flash->next) {
+		if (start >= flash->start && end <= (target_addr64_t)flash->start + flash->length)
+			return true;
+	}
+	return false;
+}
+
+static bool target_mem_cache_usable(target_s *const target, const target_addr64_t src, const size_t len)
+{
+	target_mem_cache_s *const cache = target->mem_cache;
+	if (!cache || !cache->enabled || !cache->active || target->flash_mode || !target->mem_read || len == 0U)
+		return false;
+	/* Large reads are better served by a single transfer, and would only thrash the cache */
+	if (len > TARGET_MEM_CACHE_BYPASS_SIZE) {
+		++cache->bypassed;
+		return false;
+	}
+	/* Only cache whole lines in RAM and Flash, never peripheral regions where reads can have side effects */
+	const target_addr64_t start = src & ~(target_addr64_t)(TARGET_MEM_CACHE_LINE_SIZE - 1U);
+	const target_addr64_t end = (src + len + TARGET_MEM_CACHE_LINE_SIZE - 1U) &
+		~(target_addr64_t)(TARGET_MEM_CACHE_LINE_SIZE - 1U);
+	if (!target_mem_cache_cacheable(target, start, end)) {
+		++cache->bypassed;
+		return false;
+	}
+	return true;
+}
+
+/* Copy the part of a cache line that overlaps the requested range into the destination buffer */
+static void target_mem_cache_copy_out(uint8_t *const dest, const target_addr64_t src, const target_addr64_t end,
+	const target_addr64_t line_addr, const uint8_t *const line_data)
+{
+	const target_addr64_t begin = MAX(src, line_addr);
+	const target_addr64_t finish = MIN(end, line_addr + TARGET_MEM_CACHE_LINE_SIZE);
+	memcpy(dest + (begin - src), line_data + (begin - line_addr), finish - begin);
+}
+
+/* Drop any cached lines overlapping a range of memory that's just been written */
+static void target_mem_cache_invalidate_range(target_s *const target, const target_addr64_t dest, const size_t len)
+{
+	target_mem_cache_s *const cache = target->mem_cache;
+	if (!cache || !cache->active || len == 0U)
+		return;
+	if (len > TARGET_MEM_CACHE_LINES * TARGET_MEM_CACHE_LINE_SIZE) {
+		target_mem_cache_invalidate(target);
+		return;
+	}
+	const target_addr64_t end = dest + len;
+	for (target_addr64_t addr = dest & ~(target_addr64_t)(TARGET_MEM_CACHE_LINE_SIZE - 1U); addr < end;
+		 addr += TARGET_MEM_CACHE_LINE_SIZE) {
+		target_mem_cache_line_s *const line = target_mem_cache_line(cache, addr);
+		if (target_mem_cache_hit(cache, line, addr))
+			line->epoch = 0U;
+	}
+}
+
+static bool target_mem_cache_read(target_s *const target, void *const dest, const target_addr64_t src, const size_t len)
+{
+	target_mem_cache_s *const cache = target->mem_cache;
+	const target_addr64_t end = src + len;
+	target_addr64_t addr = src & ~(target_addr64_t)(TARGET_MEM_CACHE_LINE_SIZE - 1U);
+	while (addr < end) {
+		const target_mem_cache_line_s *const line = target_mem_cache_line(cache, addr);
+		if (target_mem_cache_hit(cache, line, addr)) {
+			target_mem_cache_copy_out(dest, src, end, addr, line->data);
+			++cache->hits;
+			addr += TARGET_MEM_CACHE_LINE_SIZE;
+			continue;
+		}
+
+		/* Gather up the run of consecutive missing lines so they can be fetched in a single read */
+		target_addr64_t fill_end = addr + TARGET_MEM_CACHE_LINE_SIZE;
+		while (fill_end < end && fill_end - addr < TARGET_MEM_CACHE_BYPASS_SIZE &&
+			!target_mem_cache_hit(cache, target_mem_cache_line(cache, fill_end), fill_end))
+			fill_end += TARGET_MEM_CACHE_LINE_SIZE;
+
+		uint8_t fill[TARGET_MEM_CACHE_BYPASS_SIZE];
+		const target_addr64_t fill_start = addr;
+		++target->mem_reads;
+		target->mem_read(target, fill, fill_start, fill_end - fill_start);
+		if (target_check_error(target))
+			return true;
+
+		/* Populate the lines from what was read and hand the requested part of it back */
+		for (; addr < fill_end; addr += TARGET_MEM_CACHE_LINE_SIZE) {
+			target_mem_cache_line_s *const fill_line = target_mem_cache_line(cache, addr);
+			fill_line->addr = addr;
+			fill_line->epoch = cache->epoch;
+			memcpy(fill_line->data, fill + (addr - fill_start), TARGET_MEM_CACHE_LINE_SIZE);
+			target_mem_cache_copy_out(dest, src, end, addr, fill_line->data);
+			++cache->misses;
+		}
+	}
+	return false;
+}
+#endif
+
 target_s *target_new(void)
 {
 	target_s *target = calloc(1, sizeof(*target));
@@ -99,13 +279,28 @@ void target_flash_map_free(target_s *target)
 		target_flash_s *next = target->flash->next;
 		if (target->flash->buf)
 			free(target->flash->buf);
+		free(target->flash->erase_pending);
+		free(target->flash->erased_blocks);
 		free(target->flash);
 		target->flash = next;
 	}
 }
 
+static void target_xml_free(target_s *const target)
+{
+	free(target->mem_map_xml);
+	target->mem_map_xml = NULL;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-qual"
+	free((void *)target->regs_description_xml);
+#pragma GCC diagnostic pop
+	target->regs_description_xml = NULL;
+}
+
 void target_mem_map_free(target_s *target)
 {
+	free(target->mem_map_xml);
+	target->mem_map_xml = NULL;
 	target_ram_map_free(target);
 	target_flash_map_free(target);
 }
@@ -135,7 +330,11 @@ void target_list_free(void)
 			target->commands = tc;
 		}
 		free(target->target_storage);
+		target_xml_free(target);
 		target_mem_map_free(target);
+#ifdef TARGET_MEM_CACHE_LINES
+		free(target->mem_cache);
+#endif
 		while (target->bw_list) {
 			void *next = target->bw_list->next;
 			free(target->bw_list);
@@ -186,6 +385,9 @@ target_s *target_attach(target_s *target, target_controller_s *controller)
 	target->tc = controller;
 	platform_target_clk_output_enable(true);
 	DEBUG_TARGET("Attaching to target..\n");
+	/* Make sure the XML descriptions get regenerated for this attach */
+	target_xml_free(target);
+	target->mem_reads = 0U;
 
 	if (target->attach && !target->attach(target)) {
 		DEBUG_TARGET("Attach failed\n");
@@ -193,8 +395,12 @@ target_s *target_attach(target_s *target, target_controller_s *controller)
 		return NULL;
 	}
 
-	DEBUG_TARGET("Attach success\n");
+	DEBUG_TARGET("Attach success (%" PRIu32 " memory reads)\n", target->mem_reads);
 	target->attached = true;
+#ifdef TARGET_MEM_CACHE_LINES
+	/* Attaching leaves the target halted */
+	target_mem_cache_set_active(target, true);
+#endif
 	return target;
 }
 
@@ -203,18 +409,45 @@ void target_add_ram32(target_s *const target, const target_addr32_t start, const
 	target_add_ram64(target, start, len);
 }
 
-void target_add_ram64(target_s *const target, const target_addr64_t start, const uint64_t len)
+static target_ram_s *target_ram_add(target_s *const target, const target_addr64_t start, const uint64_t len)
 {
 	target_ram_s *ram = malloc(sizeof(*ram));
 	if (!ram) { /* malloc failed: heap exhaustion */
 		DEBUG_ERROR("malloc: failed in %s\n", __func__);
-		return;
+		return NULL;
 	}
 
 	ram->start = start;
 	ram->length = len;
+	ram->data_only = false;
 	ram->next = target->ram;
 	target->ram = ram;
+	/* The memory map changed, so any previously generated XML map is now stale */
+	free(target->mem_map_xml);
+	target->mem_map_xml = NULL;
+	return ram;
+}
+
+void target_add_ram64(target_s *const target, const target_addr64_t start, const uint64_t len)
+{
+	target_ram_add(target, start, len);
+}
+
+void target_add_data_ram32(target_s *const target, const target_addr32_t start, const uint32_t len)
+{
+	target_ram_s *const ram = target_ram_add(target, start, len);
+	if (ram)
+		ram->data_only = true;
+}
+
+/* Find the first RAM region at least length bytes long that code can be run from */
+const target_ram_s *target_find_stub_ram(const target_s *const target, const size_t length)
+{
+	for (const target_ram_s *ram = target->ram; ram; ram = ram->next) {
+		if (!ram->data_only && ram->length >= length)
+			return ram;
+	}
+	return NULL;
 }
 
 void target_add_flash(target_s *target, target_flash_s *flash)
@@ -234,6 +467,9 @@ void target_add_flash(target_s *target, target_flash_s *flash)
 	flash->t = target;
 	flash->next = target->flash;
 	target->flash = flash;
+	/* The memory map changed, so any previously generated XML map is now stale */
+	free(target->mem_map_xml);
+	target->mem_map_xml = NULL;
 }
 
 bool target_enter_flash_mode_stub(target_s *target)
@@ -242,35 +478,54 @@ bool target_enter_flash_mode_stub(target_s *target)
 	return true;
 }
 
-static ssize_t map_ram(char *buf, size_t len, target_ram_s *ram)
+static size_t map_ram(char *buf, size_t len, target_ram_s *ram)
 {
-	return snprintf(buf, len, "<memory type=\"ram\" start=\"0x%08" PRIx32 "\" length=\"0x%" PRIx32 "\"/>", ram->start,
-		(uint32_t)ram->length);
+	return (size_t)snprintf(buf, len, "<memory type=\"ram\" start=\"0x%08" PRIx32 "\" length=\"0x%" PRIx32 "\"/>",
+		ram->start, (uint32_t)ram->length);
 }
 
-static ssize_t map_flash(char *buf, size_t len, target_flash_s *flash)
+static size_t map_flash(char *buf, size_t len, target_flash_s *flash)
 {
-	ssize_t offset = 0;
-	offset += snprintf(&buf[offset], len - offset,
-		"<memory type=\"flash\" start=\"0x%08" PRIx32 "\" length=\"0x%" PRIx32 "\">", flash->start,
-		(uint32_t)flash->length);
-	offset += snprintf(buf + offset, len - offset, "<property name=\"blocksize\">0x%" PRIx32 "</property></memory>",
-		(uint32_t)flash->blocksize);
-	return offset;
+	return (size_t)snprintf(buf, len,
+		"<memory type=\"flash\" start=\"0x%08" PRIx32 "\" length=\"0x%" PRIx32 "\">"
+		"<property name=\"blocksize\">0x%" PRIx32 "</property></memory>",
+		flash->start, (uint32_t)flash->length, (uint32_t)flash->blocksize);
 }
 
-bool target_mem_map(target_s *target, char *tmp, size_t len)
+/*
+ * Build the XML memory map into buf, returning the length of the complete map. When called with
+ * a NULL buffer and a length of 0, this only computes how much space the map needs
+ */
+static size_t target_mem_map_build(target_s *target, char *buf, size_t len)
 {
-	size_t offset = 0;
-	offset = snprintf(tmp + offset, len - offset, "<memory-map>");
+	size_t offset = (size_t)snprintf(buf, len, "<memory-map>");
 	/* Map each defined RAM */
 	for (target_ram_s *ram = target->ram; ram; ram = ram->next)
-		offset += map_ram(tmp + offset, len - offset, ram);
+		offset += map_ram(buf ? buf + offset : NULL, buf ? len - offset : 0U, ram);
 	/* Map each defined Flash */
 	for (target_flash_s *flash = target->flash; flash; flash = flash->next)
-		offset += map_flash(tmp + offset, len - offset, flash);
-	offset += snprintf(tmp + offset, len - offset, "</memory-map>");
-	return offset < len - 1U;
+		offset += map_flash(buf ? buf + offset : NULL, buf ? len - offset : 0U, flash);
+	offset += (size_t)snprintf(buf ? buf + offset : NULL, buf ? len - offset : 0U, "</memory-map>");
+	return offset;
+}
+
+/*
+ * Get the XML memory map of the target. The map is generated on first use and kept until
+ * detach or until the map changes, the returned pointer is owned by the target.
+ */
+const char *target_mem_map(target_s *target)
+{
+	if (!target->mem_map_xml) {
+		const size_t length = target_mem_map_build(target, NULL, 0U) + 1U;
+		char *const map = malloc(length);
+		if (!map) { /* malloc failed: heap exhaustion */
+			DEBUG_ERROR("malloc: failed in %s\n", __func__);
+			return NULL;
+		}
+		target_mem_map_build(target, map, length);
+		target->mem_map_xml = map;
+	}
+	return target->mem_map_xml;
 }
 
 void target_print_progress(platform_timeout_s *const timeout)
@@ -285,6 +540,10 @@ void target_print_progress(platform_timeout_s *const timeout)
 void target_detach(target_s *target)
 {
 	DEBUG_TARGET("Detaching from target\n");
+#ifdef TARGET_MEM_CACHE_LINES
+	target_mem_cache_set_active(target, false);
+#endif
+	target_xml_free(target);
 	if (target->detach)
 		target->detach(target);
 	platform_target_clk_output_enable(false);
@@ -317,9 +576,16 @@ bool target_mem64_read(target_s *const target, void *const dest, const target_ad
 		memcpy(dest, target->tc->semihosting_buffer_ptr, amount);
 		return false;
 	}
+#ifdef TARGET_MEM_CACHE_LINES
+	/* If the target is halted and the read is suitable, try to serve it from the cache */
+	if (target_mem_cache_usable(target, src, len))
+		return target_mem_cache_read(target, dest, src, len);
+#endif
 	/* Otherwise if the target defines a memory read function, call that instead and check for errors */
-	if (target->mem_read)
+	if (target->mem_read) {
+		++target->mem_reads;
 		target->mem_read(target, dest, src, len);
+	}
 	return target_check_error(target);
 }
 
@@ -338,6 +604,9 @@ bool target_mem64_write(target_s *const target, const target_addr64_t dest, cons
 		memcpy(target->tc->semihosting_buffer_ptr, src, amount);
 		return false;
 	}
+#ifdef TARGET_MEM_CACHE_LINES
+	target_mem_cache_invalidate_range(target, dest, len);
+#endif
 	/* Otherwise if the target defines a memory write function, call that instead and check for errors */
 	if (target->mem_write)
 		target->mem_write(target, dest, src, len);
@@ -389,8 +658,19 @@ void target_regs_write(target_s *target, const void *data)
 void target_reset(target_s *target)
 {
 	DEBUG_TARGET("Resetting target\n");
+#ifdef TARGET_MEM_CACHE_LINES
+	target_mem_cache_set_active(target, false);
+#endif
+	/*
+	 * Drop any cached registers, including writes not yet made, both before the reset and after it, as
+	 * not every driver's reset routine goes through one that does this itself (SAMD, SAMx5x)
+	 */
+	if (target->regs_invalidate)
+		target->regs_invalidate(target);
 	if (target->reset)
 		target->reset(target);
+	if (target->regs_invalidate)
+		target->regs_invalidate(target);
 }
 
 void target_halt_request(target_s *target)
@@ -431,6 +711,11 @@ target_halt_reason_e target_halt_poll(target_s *target, target_addr64_t *watch)
 #ifndef DEBUG_TARGET_IS_NOOP
 		if (reason != TARGET_HALT_RUNNING)
 			DEBUG_TARGET("Target halted: %s\n", target_halt_reason_str(reason));
+#endif
+#ifdef TARGET_MEM_CACHE_LINES
+		/* A newly halted target starts a new cache epoch */
+		if (reason != TARGET_HALT_RUNNING && reason != TARGET_HALT_ERROR)
+			target_mem_cache_set_active(target, true);
 #endif
 		return reason;
 	}
@@ -441,6 +726,9 @@ target_halt_reason_e target_halt_poll(target_s *target, target_addr64_t *watch)
 void target_halt_resume(target_s *target, bool step)
 {
 	DEBUG_TARGET("%s target\n", step ? "Single stepping" : "Resuming");
+#ifdef TARGET_MEM_CACHE_LINES
+	target_mem_cache_set_active(target, false);
+#endif
 	if (target->halt_resume)
 		target->halt_resume(target, step);
 }
@@ -550,7 +838,8 @@ static bool target_cmd_range_erase(target_s *const target, const int argc, const
 	const uint32_t addr = strtoul(argv[1], NULL, 0);
 	const uint32_t length = strtoul(argv[2], NULL, 0);
 
-	return target_flash_erase(target, addr, length);
+	/* Complete the operation too, as the erase may have been deferred in anticipation of a write */
+	return target_flash_erase(target, addr, length) && target_flash_complete(target);
 }
 
 static bool target_cmd_redirect_output(target_s *target, int argc, const char **argv)
@@ -562,6 +851,29 @@ static bool target_cmd_redirect_output(target_s *target, int argc, const char **
 	return parse_enable_or_disable(argv[1], &target->stdout_redirected);
 }
 
+#ifdef TARGET_MEM_CACHE_LINES
+static bool target_cmd_cache(target_s *const target, const int argc, const char **const argv)
+{
+	target_mem_cache_s *const cache = target_mem_cache(target);
+	if (!cache)
+		return false;
+	if (argc > 1) {
+		const size_t arg_len = strlen(argv[1]);
+		if (arg_len && !strncmp(argv[1], "flush", arg_len)) {
+			target_mem_cache_invalidate(target);
+			return true;
+		}
+		if (strncmp(argv[1], "stats", arg_len) != 0 && !parse_enable_or_disable(argv[1], &cache->enabled))
+			return false;
+	}
+	tc_printf(target, "Memory read cache: %s, %u lines of %u bytes\n", cache->enabled ? "enabled" : "disabled",
+		TARGET_MEM_CACHE_LINES, TARGET_MEM_CACHE_LINE_SIZE);
+	tc_printf(target, "Hits: %" PRIu32 ", misses: %" PRIu32 ", bypassed: %" PRIu32 ", invalidations: %" PRIu32 "\n",
+		cache->hits, cache->misses, cache->bypassed, cache->invalidations);
+	return true;
+}
+#endif
+
 /* Accessor functions */
 size_t target_regs_size(target_s *target)
 {
@@ -570,14 +882,14 @@ size_t target_regs_size(target_s *target)
 
 /*
  * Get an XML description of the target's registers. Called during the attach phase when
- * GDB supplies request `qXfer:features:read:target.xml:`. The pointer returned by this call
- * must be passed to `free()` on conclusion of its use.
+ * GDB supplies request `qXfer:features:read:target.xml:`. The description is generated on
+ * first use and kept until detach, the returned pointer is owned by the target.
  */
 const char *target_regs_description(target_s *target)
 {
-	if (target->regs_description)
-		return target->regs_description(target);
-	return NULL;
+	if (!target->regs_description_xml && target->regs_description)
+		target->regs_description_xml = target->regs_description(target);
+	return target->regs_description_xml;
 }
 
 uint32_t target_mem32_read32(target_s *target, target_addr32_t addr)
@@ -631,8 +943,17 @@ int target_command(target_s *target, int argc, const char *argv[])
 	for (const target_command_s *target_commands = target->commands; target_commands;
 		 target_commands = target_commands->next) {
 		for (const command_s *command = target_commands->cmds; command->cmd; command++) {
-			if (!strncmp(argv[0], command->cmd, strlen(argv[0])))
+			if (!strncmp(argv[0], command->cmd, strlen(argv[0]))) {
+				/*
+				 * Target commands may run code on or otherwise alter the target, so don't trust the cache.
+				 * The cache's own command manages it directly, and would otherwise skew the stats it shows
+				 */
+#ifdef TARGET_MEM_CACHE_LINES
+				if (command->handler != target_cmd_cache)
+#endif
+					target_mem_cache_invalidate(target);
 				return command->handler(target, argc, argv) ? 0 : 1;
+			}
 		}
 	}
 	return -1;
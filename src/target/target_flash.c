@@ -37,8 +37,22 @@
 
 #include "general.h"
 #include "target_internal.h"
+#include "crc32.h"
 
-static bool flash_done(target_flash_s *flash);
+/*
+ * Incremental programming needs a whole erase block buffered to compare it, so is
+ * limited to Flash with blocks small enough for that to be reasonable on the probe
+ */
+#if CONFIG_BMDA == 1
+#define FLASH_INCREMENTAL_MAX_BLOCKSIZE (256U * 1024U)
+#else
+#define FLASH_INCREMENTAL_MAX_BLOCKSIZE 4096U
+#endif
+
+/* How long an asynchronous erase may run before we give up waiting on it */
+#define FLASH_ASYNC_ERASE_TIMEOUT 30000U
+
+bool target_flash_incremental = false;
 
 target_flash_s *target_flash_for_addr(target_s *target, uint32_t addr)
 {
@@ -51,6 +65,8 @@ target_flash_s *target_flash_for_addr(target_s *target, uint32_t addr)
 
 static bool target_enter_flash_mode(target_s *target)
 {
+	/* Flash operations change memory contents behind the read cache's back */
+	target_mem_cache_invalidate(target);
 	if (target->flash_mode)
 		return true;
 
@@ -62,8 +78,17 @@ static bool target_enter_flash_mode(target_s *target)
 		/* This saves us if we're interrupted in IRQ context */
 		target_reset(target);
 
-	if (result == true)
+	if (result == true) {
 		target->flash_mode = true;
+		target->flash_offloaded = false;
+		target->flash_blocks_compared = 0U;
+		target->flash_blocks_skipped = 0U;
+		target->flash_erase_time_ms = 0U;
+		target->flash_write_time_ms = 0U;
+		target->flash_complete_time_ms = 0U;
+		for (target_flash_s *flash = target->flash; flash; flash = flash->next)
+			memset(&flash->stats, 0, sizeof(flash->stats));
+	}
 	return result;
 }
 
@@ -71,6 +96,7 @@ static bool target_exit_flash_mode(target_s *target)
 {
 	if (!target->flash_mode)
 		return true;
+	target_mem_cache_invalidate(target);
 
 	bool result = true;
 	if (target->exit_flash_mode)
@@ -79,20 +105,90 @@ static bool target_exit_flash_mode(target_s *target)
 		/* Reset target to known state when done flashing */
 		target_reset(target);
 
+	/* Once out of Flash mode, the target may change Flash behind our back so forget which blocks are erased */
+	for (target_flash_s *flash = target->flash; flash; flash = flash->next) {
+		free(flash->erased_blocks);
+		flash->erased_blocks = NULL;
+	}
 	target->flash_mode = false;
 	return result;
 }
 
+/* Wait out any asynchronous erase still running on this Flash, returning whether it succeeded */
+static bool flash_wait_idle(target_flash_s *const flash)
+{
+	if (!flash->erasing)
+		return true;
+	flash->erasing = false;
+
+	const uint32_t start_time = platform_time_ms();
+	platform_timeout_s timeout;
+	platform_timeout_set(&timeout, FLASH_ASYNC_ERASE_TIMEOUT);
+	flash_poll_e state = FLASH_POLL_BUSY;
+	while (state == FLASH_POLL_BUSY && !platform_timeout_is_expired(&timeout)) {
+		state = flash->poll(flash);
+		++flash->stats.poll_count;
+	}
+	flash->stats.poll_time_ms += platform_time_ms() - start_time;
+
+	if (state == FLASH_POLL_IDLE)
+		return true;
+	if (state == FLASH_POLL_ERROR)
+		DEBUG_ERROR("Erase failed in Flash at 0x%08" PRIx32 "\n", flash->start);
+	else
+		DEBUG_ERROR("Timed out waiting for erase in Flash at 0x%08" PRIx32 "\n", flash->start);
+	return false;
+}
+
+/* Run the driver's erase routine, accounting for it in the Flash's statistics */
+static bool flash_driver_erase(target_flash_s *const flash, const target_addr_t addr, const size_t len)
+{
+	const uint32_t start_time = platform_time_ms();
+	const bool result = flash->erase(flash, addr, len);
+	flash->stats.erase_time_ms += platform_time_ms() - start_time;
+	++flash->stats.erase_count;
+	flash->stats.erase_bytes += len;
+	return result;
+}
+
+static bool flash_driver_mass_erase(target_flash_s *const flash, platform_timeout_s *const print_progess)
+{
+	const uint32_t start_time = platform_time_ms();
+	const bool result = flash->mass_erase(flash, print_progess);
+	flash->stats.mass_erase_time_ms += platform_time_ms() - start_time;
+	++flash->stats.mass_erase_count;
+	return result;
+}
+
+static bool flash_driver_write(
+	target_flash_s *const flash, const target_addr_t dest, const void *const src, const size_t len)
+{
+	const uint32_t start_time = platform_time_ms();
+	const bool result = flash->write(flash, dest, src, len);
+	flash->stats.write_time_ms += platform_time_ms() - start_time;
+	++flash->stats.write_count;
+	flash->stats.write_bytes += len;
+	return result;
+}
+
 static bool flash_prepare(target_flash_s *flash, flash_operation_e operation)
 {
+	/* Nothing else may be done with the Flash until any erase running on it has finished */
+	if (!flash_wait_idle(flash))
+		return false;
+
 	/* Check if we're already prepared for this operation */
 	if (flash->operation == operation)
 		return true;
 
 	bool result = true;
-	/* Terminate any ongoing Flash operation */
-	if (flash->operation != FLASH_OPERATION_NONE)
-		result = flash_done(flash);
+	/*
+	 * Terminate any ongoing Flash operation. This deliberately keeps the write buffer
+	 * as incremental programming switches between erasing and writing while flushing it
+	 */
+	if (flash->operation != FLASH_OPERATION_NONE && flash->done)
+		result = flash->done(flash);
+	flash->operation = FLASH_OPERATION_NONE;
 
 	/* If that succeeded, set up the new operating state */
 	if (result) {
@@ -115,10 +211,10 @@ static bool flash_done(target_flash_s *flash)
 	if (flash->operation == FLASH_OPERATION_NONE)
 		return true;
 
-	bool result = true;
+	bool result = flash_wait_idle(flash);
 	/* Terminate flash operation */
 	if (flash->done)
-		result = flash->done(flash);
+		result &= flash->done(flash);
 
 	/* Free the operation buffer */
 	if (flash->buf) {
@@ -131,7 +227,186 @@ static bool flash_done(target_flash_s *flash)
 	return result;
 }
 
-bool target_flash_erase(target_s *target, target_addr_t addr, size_t len)
+static inline bool flash_incremental_usable(const target_flash_s *const flash)
+{
+	return target_flash_incremental && flash->blocksize <= FLASH_INCREMENTAL_MAX_BLOCKSIZE;
+}
+
+/*
+ * Erases for Flash that can erase asynchronously are put off until its data starts arriving, so a Flash that
+ * can erase concurrently gets them done in the background while another Flash on the target is programmed
+ */
+static inline bool flash_pipelined(const target_flash_s *const flash)
+{
+	return (flash->flags & TARGET_FLASH_ASYNC_ERASE) && flash->poll && !flash_incremental_usable(flash);
+}
+
+static inline size_t flash_block_index(const target_flash_s *const flash, const target_addr_t block_addr)
+{
+	return (block_addr - flash->start) / flash->blocksize;
+}
+
+/* Set the given erase block's bit in one of the Flash's per-block bitmaps, allocating the bitmap on first use */
+static bool flash_block_bitmap_set(
+	const target_flash_s *const flash, uint8_t **const bitmap, const target_addr_t block_addr)
+{
+	if (!*bitmap) {
+		const size_t blocks = flash->length / flash->blocksize;
+		*bitmap = calloc((blocks + 7U) / 8U, 1U);
+		if (!*bitmap) { /* calloc failed: heap exhaustion */
+			DEBUG_ERROR("calloc: failed in %s\n", __func__);
+			return false;
+		}
+	}
+	const size_t index = flash_block_index(flash, block_addr);
+	(*bitmap)[index / 8U] |= 1U << (index % 8U);
+	return true;
+}
+
+static bool flash_block_bitmap_test(
+	const target_flash_s *const flash, const uint8_t *const bitmap, const target_addr_t block_addr)
+{
+	if (!bitmap)
+		return false;
+	const size_t index = flash_block_index(flash, block_addr);
+	return bitmap[index / 8U] & (1U << (index % 8U));
+}
+
+static void flash_block_bitmap_clear(
+	const target_flash_s *const flash, uint8_t *const bitmap, const target_addr_t block_addr)
+{
+	if (!bitmap)
+		return;
+	const size_t index = flash_block_index(flash, block_addr);
+	bitmap[index / 8U] &= ~(1U << (index % 8U));
+}
+
+/* Remember that a range of blocks was just erased, so all-erased chunks written into them can be skipped */
+static void flash_mark_erased(target_flash_s *const flash, const target_addr_t start_addr, const target_addr_t end_addr)
+{
+	/* If the driver's erase doesn't actually blank the Flash, the old contents must still be overwritten */
+	if (!(flash->flags & TARGET_FLASH_ERASE_BLANKS))
+		return;
+	for (target_addr_t block_addr = start_addr; block_addr < end_addr; block_addr += flash->blocksize) {
+		if (!flash_block_bitmap_set(flash, &flash->erased_blocks, block_addr))
+			return;
+	}
+}
+
+static inline bool flash_erase_defer(target_flash_s *const flash, const target_addr_t block_addr)
+{
+	return flash_block_bitmap_set(flash, &flash->erase_pending, block_addr);
+}
+
+/* Check if the block's erase was deferred, clearing the deferral as the caller is now dealing with it */
+static bool flash_erase_take_pending(target_flash_s *const flash, const target_addr_t block_addr)
+{
+	const bool pending = flash_block_bitmap_test(flash, flash->erase_pending, block_addr);
+	flash_block_bitmap_clear(flash, flash->erase_pending, block_addr);
+	return pending;
+}
+
+/* Erase a single block, leaving an asynchronous erase running for whatever needs the Flash next to wait on */
+static bool flash_erase_block(target_flash_s *const flash, const target_addr_t block_addr)
+{
+	if (!flash_prepare(flash, FLASH_OPERATION_ERASE) || !flash_driver_erase(flash, block_addr, flash->blocksize))
+		return false;
+	flash->erasing = flash->flags & TARGET_FLASH_ASYNC_ERASE;
+	flash_mark_erased(flash, block_addr, block_addr + flash->blocksize);
+	return true;
+}
+
+/*
+ * Keep every other Flash that can erase concurrently with the active one working through its deferred
+ * erases in the background, a block at a time, starting the next erase as each one finishes
+ */
+static bool flash_erase_in_background(target_s *const target, const target_flash_s *const active_flash)
+{
+	for (target_flash_s *flash = target->flash; flash; flash = flash->next) {
+		if (flash == active_flash || !(flash->flags & TARGET_FLASH_CONCURRENT) || !flash_pipelined(flash) ||
+			!flash->erase_pending)
+			continue;
+		if (flash->erasing) {
+			const flash_poll_e state = flash->poll(flash);
+			++flash->stats.poll_count;
+			if (state == FLASH_POLL_BUSY)
+				continue;
+			flash->erasing = false;
+			if (state == FLASH_POLL_ERROR) {
+				DEBUG_ERROR("Erase failed in Flash at 0x%08" PRIx32 "\n", flash->start);
+				return false;
+			}
+		}
+		for (target_addr_t block_addr = flash->start; block_addr < flash->start + flash->length;
+			 block_addr += flash->blocksize) {
+			if (flash_erase_take_pending(flash, block_addr)) {
+				if (!flash_erase_block(flash, block_addr))
+					return false;
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+typedef struct flash_block_image {
+	const uint8_t *data;
+	target_addr_t base;
+	uint8_t erased;
+} flash_block_image_s;
+
+/* Feed the new contents of a block to bmd_crc32_read(), which is all erased bytes when there's no data for it */
+static bool flash_block_image_read(void *const context, void *const dest, const uint32_t src, const size_t len)
+{
+	const flash_block_image_s *const image = (const flash_block_image_s *)context;
+	if (image->data)
+		memcpy(dest, image->data + (src - image->base), len);
+	else
+		memset(dest, image->erased, len);
+	return true;
+}
+
+/* Compare the CRC of a block's current contents with that of what it's about to become */
+static bool flash_block_unchanged(
+	target_flash_s *const flash, const target_addr_t block_addr, const uint8_t *const data)
+{
+	target_s *const target = flash->t;
+	++target->flash_blocks_compared;
+	uint32_t current_crc = 0U;
+	if (!bmd_crc32(target, &current_crc, block_addr, flash->blocksize))
+		return false;
+	flash_block_image_s image = {.data = data, .base = block_addr, .erased = flash->erased};
+	uint32_t new_crc = 0U;
+	bmd_crc32_read(flash_block_image_read, &image, &new_crc, block_addr, flash->blocksize);
+	if (current_crc != new_crc)
+		return false;
+
+	DEBUG_TARGET(
+		"%s: %08" PRIx32 "+%" PRIu32 " unchanged, skipping\n", __func__, block_addr, (uint32_t)flash->blocksize);
+	++target->flash_blocks_skipped;
+	return true;
+}
+
+/* Carry out any erases still deferred on the Flash, skipping those incremental programming finds unneeded */
+static bool flash_erase_remaining(target_flash_s *const flash)
+{
+	if (!flash->erase_pending)
+		return true;
+
+	bool result = true; /* Catch false returns with &= */
+	for (target_addr_t block_addr = flash->start; result && block_addr < flash->start + flash->length;
+		 block_addr += flash->blocksize) {
+		if (!flash_erase_take_pending(flash, block_addr) ||
+			(flash_incremental_usable(flash) && flash_block_unchanged(flash, block_addr, NULL)))
+			continue;
+		result &= flash_erase_block(flash, block_addr);
+	}
+	free(flash->erase_pending);
+	flash->erase_pending = NULL;
+	return result;
+}
+
+static bool flash_erase_range(target_s *const target, target_addr_t addr, size_t len)
 {
 	if (!target_enter_flash_mode(target))
 		return false;
@@ -161,6 +436,19 @@ bool target_flash_erase(target_s *target, target_addr_t addr, size_t len)
 		const bool can_use_mass_erase =
 			flash->mass_erase != NULL && local_start_addr == flash->start && addr + len >= flash->start + flash->length;
 
+		/*
+		 * When programming incrementally, put the erase off until we know if the block's contents will change.
+		 * For Flash that can erase asynchronously, put it off until the Flash's data starts to arrive so it
+		 * can overlap programming another Flash, unless the whole Flash is being erased anyway.
+		 */
+		if (flash_incremental_usable(flash) || (flash_pipelined(flash) && !can_use_mass_erase)) {
+			if (!flash_erase_defer(flash, local_start_addr))
+				return false;
+			len -= MIN(local_start_addr + flash->blocksize - addr, len);
+			addr = local_start_addr + flash->blocksize;
+			continue;
+		}
+
 		/* Calculate the address at the end of the erase block */
 		const target_addr_t local_end_addr =
 			can_use_mass_erase ? flash->start + flash->length : local_start_addr + flash->blocksize;
@@ -170,12 +458,14 @@ bool target_flash_erase(target_s *target, target_addr_t addr, size_t len)
 
 		DEBUG_TARGET("%s: %08" PRIx32 "+%" PRIu32 "\n", __func__, local_start_addr, local_end_addr - local_start_addr);
 		/* Erase flash, either a single aligned block size or a full mass erase */
-		result &= can_use_mass_erase ? flash->mass_erase(flash, NULL) :
-									   flash->erase(flash, local_start_addr, flash->blocksize);
+		result &= can_use_mass_erase ? flash_driver_mass_erase(flash, NULL) :
+									   flash_driver_erase(flash, local_start_addr, flash->blocksize);
+		flash->erasing = !can_use_mass_erase && (flash->flags & TARGET_FLASH_ASYNC_ERASE);
 		if (!result) {
 			DEBUG_ERROR("Erase failed at %" PRIx32 "\n", local_start_addr);
 			break;
 		}
+		flash_mark_erased(flash, local_start_addr, local_end_addr);
 
 		/* Update the remaining length and address, taking into account the alignment */
 		len -= MIN(local_end_addr - addr, len);
@@ -183,17 +473,31 @@ bool target_flash_erase(target_s *target, target_addr_t addr, size_t len)
 	}
 	/* Issue flash done on last operation */
 	result &= flash_done(active_flash);
+	/* Get any Flash that can erase in the background started on its deferred erases */
+	return result && flash_erase_in_background(target, NULL);
+}
+
+bool target_flash_erase(target_s *target, target_addr_t addr, size_t len)
+{
+#if CONFIG_BMDA == 1
+	/* Incremental programming compares blocks before handing them to the driver, so keeps the driver host-side */
+	if (!target_flash_incremental && (bmda_flash_offload_active(target) || bmda_flash_offload_begin(target)))
+		return bmda_flash_offload_erase(target, addr, len);
+#endif
+	const uint32_t start_time = platform_time_ms();
+	const bool result = flash_erase_range(target, addr, len);
+	target->flash_erase_time_ms += platform_time_ms() - start_time;
 	return result;
 }
 
 static inline bool flash_manual_mass_erase(target_flash_s *const flash, platform_timeout_s *const print_progess)
 {
 	for (target_addr_t addr = flash->start; addr < flash->start + flash->length; addr += flash->blocksize) {
-		if (!flash->erase(flash, addr, flash->blocksize))
+		if (!flash_erase_block(flash, addr))
 			return false;
 		target_print_progress(print_progess);
 	}
-	return true;
+	return flash_wait_idle(flash);
 }
 
 /* Run specialized target mass erase if available, otherwise erase all flash' */
@@ -231,7 +535,7 @@ bool target_flash_mass_erase(target_s *const target)
 				break;
 			}
 
-			result = can_use_mass_erase ? flash->mass_erase(flash, &print_progess) :
+			result = can_use_mass_erase ? flash_driver_mass_erase(flash, &print_progess) :
 										  flash_manual_mass_erase(flash, &print_progess);
 			result &= flash_done(flash); /* Don't overwrite previous result, AND with it instead */
 			if (!result) {
@@ -245,10 +549,19 @@ bool target_flash_mass_erase(target_s *const target)
 	return result;
 }
 
+/* Incremental programming needs whole erase blocks buffered so it can compare them */
+static inline size_t flash_buffer_size(const target_flash_s *const flash)
+{
+	if (flash->erase_pending && flash_incremental_usable(flash))
+		return MAX(flash->writebufsize, flash->blocksize);
+	return flash->writebufsize;
+}
+
 bool flash_buffer_alloc(target_flash_s *flash)
 {
 	/* Allocate buffer */
-	flash->buf = malloc(flash->writebufsize);
+	flash->buf_size = flash_buffer_size(flash);
+	flash->buf = malloc(flash->buf_size);
 	if (!flash->buf) { /* malloc failed: heap exhaustion */
 		DEBUG_ERROR("malloc: failed in %s\n", __func__);
 		return false;
@@ -259,22 +572,84 @@ bool flash_buffer_alloc(target_flash_s *flash)
 	return true;
 }
 
-static bool flash_buffered_flush(target_flash_s *flash)
+static bool flash_chunk_is_erased(const target_flash_s *const flash, const uint8_t *const src)
+{
+	for (size_t offset = 0; offset < flash->writesize; ++offset) {
+		if (src[offset] != flash->erased)
+			return false;
+	}
+	return true;
+}
+
+/*
+ * Write a single writesize chunk, unless it's entirely the erased value and going into a block we erased
+ * during this Flash operation, in which case programming it would not change anything (padding, gaps
+ * between sections and the like)
+ */
+static bool flash_write_chunk(target_flash_s *const flash, const target_addr_t addr, const uint8_t *const src)
+{
+	if ((flash->flags & TARGET_FLASH_ERASE_BLANKS) &&
+		flash_block_bitmap_test(flash, flash->erased_blocks, addr & ~(flash->blocksize - 1U)) &&
+		flash_chunk_is_erased(flash, src)) {
+		++flash->stats.chunks_skipped;
+		return true;
+	}
+	return flash_driver_write(flash, addr, src, flash->writesize);
+}
+
+/*
+ * Write out the buffered range erase block by erase block, carrying out any deferred erase first.
+ * When programming incrementally, that's unless the block's current contents already match what the
+ * buffer holds for it. This relies on each block's data arriving in one go, as both GDB and the CLI provide it.
+ */
+static bool flash_deferred_flush(target_flash_s *const flash, const target_addr_t addr, const uint32_t length)
 {
 	bool result = true; /* Catch false returns with &= */
-	if (flash->buf && flash->buf_addr_base != UINT32_MAX && flash->buf_addr_low != UINT32_MAX &&
-		flash->buf_addr_low < flash->buf_addr_high) {
-		/* Write buffer to flash */
+	const target_addr_t end_addr = addr + length;
+	for (target_addr_t block_addr = addr & ~(flash->blocksize - 1U); result && block_addr < end_addr;
+		 block_addr += flash->blocksize) {
+		/* The parts of a block with a deferred erase not written to would've been left erased, as the buffer holds */
+		if (flash_erase_take_pending(flash, block_addr)) {
+			if (flash_incremental_usable(flash) && flash->buf_size >= flash->blocksize &&
+				flash_block_unchanged(flash, block_addr, flash->buf + (block_addr - flash->buf_addr_base)))
+				continue;
+			if (!flash_erase_block(flash, block_addr))
+				return false;
+		}
 
 		if (!flash_prepare(flash, FLASH_OPERATION_WRITE))
 			return false;
+		const target_addr_t block_end = MIN(block_addr + flash->blocksize, end_addr);
+		for (target_addr_t write_addr = MAX(block_addr, addr); write_addr < block_end; write_addr += flash->writesize) {
+			const uint8_t *const src = flash->buf + (write_addr - flash->buf_addr_base);
+			result &= flash_write_chunk(flash, write_addr, src);
+		}
+	}
+	return result;
+}
 
+static bool flash_buffered_flush(target_flash_s *flash)
+{
+	bool result = true; /* Catch false returns with &= */
+	if (flash->buf && flash->buf_addr_base != UINT32_MAX && flash->buf_addr_low != UINT32_MAX &&
+		flash->buf_addr_low < flash->buf_addr_high) {
+		const uint32_t start_time = platform_time_ms();
+		/* Write buffer to flash */
 		const target_addr_t aligned_addr = flash->buf_addr_low & ~(flash->writesize - 1U);
 		const uint8_t *src = flash->buf + (aligned_addr - flash->buf_addr_base);
 		const uint32_t length = flash->buf_addr_high - aligned_addr;
 
-		for (size_t offset = 0; offset < length; offset += flash->writesize)
-			result &= flash->write(flash, aligned_addr + offset, src + offset, flash->writesize);
+		if (flash->erase_pending)
+			result = flash_deferred_flush(flash, aligned_addr, length);
+		else {
+			if (!flash_prepare(flash, FLASH_OPERATION_WRITE))
+				return false;
+
+			for (size_t offset = 0; offset < length; offset += flash->writesize)
+				result &= flash_write_chunk(flash, aligned_addr + offset, src + offset);
+		}
+		flash->stats.flush_time_ms += platform_time_ms() - start_time;
+		++flash->stats.flush_count;
 
 		flash->buf_addr_base = UINT32_MAX;
 		flash->buf_addr_low = UINT32_MAX;
@@ -287,8 +662,9 @@ static bool flash_buffered_flush(target_flash_s *flash)
 static bool flash_buffered_write(target_flash_s *flash, target_addr_t dest, const uint8_t *src, size_t len)
 {
 	bool result = true; /* Catch false returns with &= */
+	const size_t buffer_size = flash->buf_size;
 	while (len) {
-		const target_addr_t base_addr = dest & ~(flash->writebufsize - 1U);
+		const target_addr_t base_addr = dest & ~(buffer_size - 1U);
 
 		/* Check for base address change */
 		if (base_addr != flash->buf_addr_base) {
@@ -296,11 +672,20 @@ static bool flash_buffered_write(target_flash_s *flash, target_addr_t dest, cons
 
 			/* Setup buffer */
 			flash->buf_addr_base = base_addr;
-			memset(flash->buf, flash->erased, flash->writebufsize);
+			memset(flash->buf, flash->erased, buffer_size);
+
+			/*
+			 * Finish any erases still deferred on this Flash before it's first written, rather than a block
+			 * at a time, so the driver isn't made to stop programming (and any Flash loader) for every block
+			 */
+			if (flash_pipelined(flash))
+				result &= flash_erase_remaining(flash);
+			/* Whatever Flash this is, keep any others that can erase concurrently working through theirs */
+			result &= flash_erase_in_background(flash->t, flash);
 		}
 
-		const size_t offset = dest % flash->writebufsize;
-		const size_t local_len = MIN(flash->writebufsize - offset, len);
+		const size_t offset = dest % buffer_size;
+		const size_t local_len = MIN(buffer_size - offset, len);
 
 		/* Copy chunk into sector buffer */
 		memcpy(flash->buf + offset, src, local_len);
@@ -316,7 +701,7 @@ static bool flash_buffered_write(target_flash_s *flash, target_addr_t dest, cons
 	return result;
 }
 
-bool target_flash_write(target_s *target, target_addr_t dest, const void *src, size_t len)
+static bool flash_write_range(target_s *const target, target_addr_t dest, const void *src, size_t len)
 {
 	if (!target_enter_flash_mode(target))
 		return false;
@@ -369,16 +754,39 @@ bool target_flash_write(target_s *target, target_addr_t dest, const void *src, s
 	return result;
 }
 
+bool target_flash_write(target_s *target, target_addr_t dest, const void *src, size_t len)
+{
+#if CONFIG_BMDA == 1
+	if (!target_flash_incremental && (bmda_flash_offload_active(target) || bmda_flash_offload_begin(target)))
+		return bmda_flash_offload_write(target, dest, src, len);
+#endif
+	const uint32_t start_time = platform_time_ms();
+	const bool result = flash_write_range(target, dest, src, len);
+	target->flash_write_time_ms += platform_time_ms() - start_time;
+	return result;
+}
+
 bool target_flash_complete(target_s *target)
 {
+#if CONFIG_BMDA == 1
+	/* If the probe ran this Flash operation, it needs to be the one to finish it */
+	if (bmda_flash_offload_active(target))
+		return bmda_flash_offload_complete(target);
+#endif
 	if (!target || !target->flash_mode)
 		return false;
 
+	const uint32_t start_time = platform_time_ms();
 	bool result = true; /* Catch false returns with &= */
 	for (target_flash_s *flash = target->flash; flash; flash = flash->next) {
 		result &= flash_buffered_flush(flash);
+		result &= flash_erase_remaining(flash);
 		result &= flash_done(flash);
 	}
+	target->flash_complete_time_ms += platform_time_ms() - start_time;
+	if (target->flash_blocks_compared)
+		DEBUG_INFO("Incremental programming skipped %" PRIu32 " of %" PRIu32 " erase blocks as unchanged\n",
+			target->flash_blocks_skipped, target->flash_blocks_compared);
 
 	target_exit_flash_mode(target);
 	return result;
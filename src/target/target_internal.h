@@ -46,6 +46,8 @@ struct target_ram {
 	/* XXX: This needs adjusting for 64-bit operations */
 	target_addr32_t start;
 	size_t length;
+	/* Set for RAM the core can't fetch instructions from, so stubs must not be loaded into it */
+	bool data_only;
 	target_ram_s *next;
 };
 
@@ -57,6 +59,41 @@ typedef bool (*flash_mass_erase_func)(target_flash_s *flash, platform_timeout_s
 typedef bool (*flash_write_func)(target_flash_s *flash, target_addr_t dest, const void *src, size_t len);
 typedef bool (*flash_done_func)(target_flash_s *flash);
 
+typedef enum flash_poll {
+	FLASH_POLL_IDLE,
+	FLASH_POLL_BUSY,
+	FLASH_POLL_ERROR,
+} flash_poll_e;
+
+typedef flash_poll_e (*flash_poll_func)(target_flash_s *flash);
+
+/* The erase routine may return as soon as the erase is started, with poll reporting on its progress */
+#define TARGET_FLASH_ASYNC_ERASE (1U << 0U)
+/* This Flash can be erased while another Flash on the same target is being programmed */
+#define TARGET_FLASH_CONCURRENT (1U << 1U)
+/*
+ * The erase routine really leaves the block at the erased value, so chunks of only that value need not be
+ * programmed into a block just erased. Not for Flash whose erase is a no-op (such as RRAM) or emulated
+ */
+#define TARGET_FLASH_ERASE_BLANKS (1U << 2U)
+
+/* Accounting of the work done on a Flash since its target last entered Flash mode, for monitor flash_stats */
+typedef struct target_flash_stats {
+	uint32_t erase_count;      /* Calls to the driver's erase routine */
+	uint32_t erase_bytes;      /* Bytes those calls covered */
+	uint32_t erase_time_ms;    /* Time spent in them (not including waiting on asynchronous erases) */
+	uint32_t mass_erase_count; /* Calls to the driver's mass erase routine */
+	uint32_t mass_erase_time_ms;
+	uint32_t write_count; /* Calls to the driver's write routine */
+	uint32_t write_bytes;
+	uint32_t write_time_ms;
+	uint32_t chunks_skipped; /* Erased-value write chunks not handed to the driver as the block was known erased */
+	uint32_t flush_count;    /* Write buffer flushes, including any erases and compares they caused */
+	uint32_t flush_time_ms;
+	uint32_t poll_count; /* Busy-poll iterations spent on asynchronous erases */
+	uint32_t poll_time_ms;
+} target_flash_stats_s;
+
 struct target_flash {
 	/* XXX: This needs adjusting for 64-bit operations */
 	target_s *t;                      /* Target this flash is attached to */
@@ -67,15 +104,22 @@ struct target_flash {
 	size_t writebufsize;              /* Size of write buffer, this is calculated and not set in target code */
 	uint8_t erased;                   /* Byte erased state */
 	uint8_t operation;                /* Current Flash operation (none means it's idle/unprepared) */
+	uint8_t flags;                    /* Capabilities of the Flash driver (TARGET_FLASH_*) */
+	bool erasing;                     /* An asynchronous erase has been started and not yet waited on */
 	flash_prepare_func prepare;       /* Prepare for flash operations */
 	flash_erase_func erase;           /* Erase a range of flash */
 	flash_mass_erase_func mass_erase; /* Mass erase flash (this flash only¹) */
 	flash_write_func write;           /* Write to flash */
 	flash_done_func done;             /* Finish flash operations */
+	flash_poll_func poll;             /* Check on an asynchronous erase (required with TARGET_FLASH_ASYNC_ERASE) */
 	uint8_t *buf;                     /* Buffer for flash operations */
+	size_t buf_size;                  /* Size of the buffer allocated */
 	target_addr32_t buf_addr_base;    /* Address of block this buffer is for */
 	target_addr32_t buf_addr_low;     /* Address of lowest byte written */
 	target_addr32_t buf_addr_high;    /* Address of highest byte written */
+	uint8_t *erase_pending;           /* Bitmap of erase blocks with a deferred erase (incremental programming) */
+	uint8_t *erased_blocks;           /* Bitmap of erase blocks known erased since entering Flash mode */
+	target_flash_stats_s stats;       /* Work done on this Flash during the last Flash operation */
 	target_flash_s *next;             /* Next flash in list */
 };
 
@@ -119,6 +163,23 @@ struct breakwatch {
 
 #define MAX_CMDLINE 81
 
+/*
+ * Memory read cache, used to serve repeated reads of RAM and Flash while the target is halted.
+ * BMDA has memory to spare so enables it by default, firmware platforms may opt in by defining
+ * TARGET_MEM_CACHE_LINES in their platform.h
+ */
+#if CONFIG_BMDA == 1 && !defined(TARGET_MEM_CACHE_LINES)
+#define TARGET_MEM_CACHE_LINES 256U
+#endif
+
+#ifdef TARGET_MEM_CACHE_LINES
+#define TARGET_MEM_CACHE_LINE_SIZE 64U
+/* Reads larger than this go straight to the target and are not cached */
+#define TARGET_MEM_CACHE_BYPASS_SIZE 1024U
+
+typedef struct target_mem_cache target_mem_cache_s;
+#endif
+
 typedef void (*priv_free_func)(void *flash);
 
 struct target {
@@ -132,6 +193,10 @@ struct target {
 	/* Memory access functions */
 	void (*mem_read)(target_s *target, void *dest, target_addr64_t src, size_t len);
 	void (*mem_write)(target_s *target, target_addr64_t dest, const void *src, size_t len);
+	/* Optional, calculates the CRC32 of a memory region without reading it all back through mem_read */
+	bool (*mem_crc32)(target_s *target, uint32_t *result, target_addr_t base, size_t len);
+	/* Count of reads that went out to the target since it was probed or last attached, for debugging connect time */
+	uint32_t mem_reads;
 
 	/* Register access functions */
 	size_t regs_size;
@@ -140,6 +205,10 @@ struct target {
 	void (*regs_write)(target_s *target, const void *data);
 	size_t (*reg_read)(target_s *target, uint32_t reg, void *data, size_t max);
 	size_t (*reg_write)(target_s *target, uint32_t reg, const void *data, size_t size);
+	/* Optional, drops any cached register values after something else has run code on the target */
+	void (*regs_invalidate)(target_s *target);
+	/* Optional, writes back any cached register values not yet written to the target */
+	void (*regs_flush)(target_s *target);
 
 	/* Halt/resume functions */
 	void (*reset)(target_s *target);
@@ -172,9 +241,24 @@ struct target {
 
 	bool attached;
 	bool flash_mode;
+	/* Set when the last Flash operation was handed off to the probe, so no statistics were collected for it */
+	bool flash_offloaded;
+	/* Erase blocks compared, and found unchanged and skipped, by incremental programming since entering Flash mode */
+	uint32_t flash_blocks_compared;
+	uint32_t flash_blocks_skipped;
+	/* Wall time spent in each stage of the Flash operation since entering Flash mode */
+	uint32_t flash_erase_time_ms;
+	uint32_t flash_write_time_ms;
+	uint32_t flash_complete_time_ms;
 
 	target_ram_s *ram;
 	target_flash_s *flash;
+#ifdef TARGET_MEM_CACHE_LINES
+	target_mem_cache_s *mem_cache;
+#endif
+	/* XML memory map and register description for GDB, built on first request and released on detach */
+	char *mem_map_xml;
+	const char *regs_description_xml;
 
 	/* Other stuff */
 	const char *driver;
@@ -206,12 +290,16 @@ void target_mem_map_free(target_s *target);
 void target_add_commands(target_s *target, const command_s *cmds, const char *name);
 void target_add_ram32(target_s *target, target_addr32_t start, uint32_t len);
 void target_add_ram64(target_s *target, target_addr64_t start, uint64_t len);
+void target_add_data_ram32(target_s *target, target_addr32_t start, uint32_t len);
+const target_ram_s *target_find_stub_ram(const target_s *target, size_t length);
 void target_add_flash(target_s *target, target_flash_s *flash);
 
 /* No-op stub for enter flash mode */
 bool target_enter_flash_mode_stub(target_s *target);
 
 target_flash_s *target_flash_for_addr(target_s *target, uint32_t addr);
+/* When set, erases are deferred until a block's new contents are known so that unchanged blocks can be skipped */
+extern bool target_flash_incremental;
 
 /* Convenience function for MMIO access */
 uint32_t target_mem32_read32(target_s *target, target_addr32_t addr);
@@ -228,6 +316,25 @@ bool target_mem64_write16(target_s *target, target_addr64_t addr, uint16_t value
 bool target_mem64_write8(target_s *target, target_addr64_t addr, uint8_t value);
 bool target_check_error(target_s *target);
 
+#ifdef TARGET_MEM_CACHE_LINES
+/* Discard everything held in the memory read cache, for use when target memory changes behind its back */
+void target_mem_cache_invalidate(target_s *target);
+#else
+static inline void target_mem_cache_invalidate(target_s *const target)
+{
+	(void)target;
+}
+#endif
+
+#if CONFIG_BMDA == 1
+/* Hand Flash erase/write/complete off to the probe when its firmware can run the target's Flash driver itself */
+bool bmda_flash_offload_begin(target_s *target);
+bool bmda_flash_offload_active(const target_s *target);
+bool bmda_flash_offload_erase(target_s *target, target_addr_t addr, size_t len);
+bool bmda_flash_offload_write(target_s *target, target_addr_t dest, const void *src, size_t len);
+bool bmda_flash_offload_complete(target_s *target);
+#endif
+
 #if defined(__MINGW32__) || defined(__MINGW64__) || defined(__CYGWIN__)
 #define TC_FORMAT_ATTR __attribute__((format(__MINGW_PRINTF_FORMAT, 2, 3)))
 #elif defined(__GNUC__) || defined(__clang__)